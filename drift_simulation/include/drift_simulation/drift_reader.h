@@ -11,6 +11,8 @@
 #include <tf2_ros/transform_broadcaster.h>
 #include <tf2_ros/transform_listener.h>
 
+#include "drift_simulation/drift_rollout.h"
+
 class DriftReader {
  public:
   DriftReader(ros::NodeHandle nh, ros::NodeHandle nh_private);
@@ -29,9 +31,18 @@ class DriftReader {
   std::string global_frame_name_;
   std::string drifted_sensor_frame_name_;
 
+  // Period between the poses of rollouts without timestamps [s]. If > 0, the
+  // poses are looked up by the time since the first cloud, otherwise by the
+  // number of received clouds.
+  double frame_period_ = 0.0;
+
+  // Clouds up to this time outside of the rollout use its first or last pose
+  // [s].
+  double max_time_offset_ = 0.05;
+
   // Data.
   size_t frame_counter_ = 0u;
-  std::vector<std::string> vector_of_transformations_;
+  DriftRollout rollout_;
 
   // TF transforms.
   tf2_ros::TransformBroadcaster tf_broadcaster_;
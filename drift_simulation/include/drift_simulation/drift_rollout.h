@@ -0,0 +1,52 @@
+#ifndef DRIFT_SIMULATION_DRIFT_ROLLOUT_H_
+#define DRIFT_SIMULATION_DRIFT_ROLLOUT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Drifted pose of the rollout, stored as 'x, y, z, qx, qy, qz, qw'.
+struct DriftPose {
+  uint64_t stamp = 0u;  // ns, 0 if the rollout has no timestamps.
+  double values[7] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0};
+};
+
+/**
+ * Drift rollout loaded once into a packed array of poses. Rollouts are read
+ * from CSV, with 'x, y, z, qx, qy, qz, qw' or 'stamp_ns, x, y, z, qx, qy, qz,
+ * qw' per line, or from the binary format written by writeBinary() if the
+ * file name ends in '.bin'. Poses are looked up by timestamp and interpolated
+ * between the neighboring poses.
+ */
+class DriftRollout {
+ public:
+  DriftRollout() = default;
+
+  // Load a CSV or binary rollout. Returns false if the file could not be read.
+  bool load(const std::string& file_name);
+
+  // Write the rollout in the binary format.
+  bool writeBinary(const std::string& file_name) const;
+
+  // Assign evenly spaced timestamps to a rollout without timestamps.
+  void setStamps(uint64_t first_stamp, uint64_t period);
+
+  // Interpolate the pose at a timestamp. Stamps up to 'max_offset' outside of
+  // the rollout are clamped to its ends, returns false for all others.
+  bool lookup(uint64_t stamp, uint64_t max_offset, DriftPose* pose) const;
+
+  // Accessors.
+  bool hasStamps() const { return has_stamps_; }
+  size_t size() const { return poses_.size(); }
+  bool empty() const { return poses_.empty(); }
+  const DriftPose& operator[](size_t index) const { return poses_[index]; }
+
+ private:
+  std::vector<DriftPose> poses_;
+  bool has_stamps_ = false;
+
+  bool readCsv(const std::string& file_name);
+  bool readBinary(const std::string& file_name);
+};
+
+#endif  // DRIFT_SIMULATION_DRIFT_ROLLOUT_H_
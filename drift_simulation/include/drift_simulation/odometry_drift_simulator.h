@@ -87,6 +87,10 @@ class OdometryDriftSimulator {
   std::string global_frame_name_ = "map";
   std::string sensor_frame_name_ = "os1_lidar";
 
+  // Prefix each written pose with the cloud timestamp [ns], so the
+  // DriftReader can look poses up by time.
+  bool write_timestamps_ = true;
+
   // TF transforms
   tf::TransformListener tf_listener_;
 
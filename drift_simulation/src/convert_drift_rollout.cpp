@@ -0,0 +1,37 @@
+// Converts a drift rollout to the binary format. Usage:
+//   convert_drift_rollout <input.csv> <output.bin> [frame_period_s]
+// Rollouts without timestamps can be assigned evenly spaced timestamps
+// starting at 0 by specifying the frame period.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <glog/logging.h>
+
+#include "drift_simulation/drift_rollout.h"
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+  if (argc < 3 || argc > 4) {
+    std::cerr << "Usage: " << argv[0]
+              << " <input.csv> <output.bin> [frame_period_s]" << std::endl;
+    return 1;
+  }
+
+  DriftRollout rollout;
+  if (!rollout.load(argv[1])) {
+    return 1;
+  }
+  if (argc == 4 && !rollout.hasStamps()) {
+    rollout.setStamps(0u, static_cast<uint64_t>(std::atof(argv[3]) * 1e9));
+  }
+  if (!rollout.writeBinary(argv[2])) {
+    LOG(ERROR) << "Could not write '" << argv[2] << "'.";
+    return 1;
+  }
+  LOG(INFO) << "Converted " << rollout.size() << " poses to '" << argv[2]
+            << "'.";
+  return 0;
+}
@@ -1,10 +1,7 @@
 #include "drift_simulation/drift_reader.h"
 
 #include <filesystem>
-#include <fstream>
-#include <iostream>
 #include <memory>
-#include <sstream>
 #include <string>
 
 #include <glog/logging.h>
@@ -21,6 +18,9 @@ DriftReader::DriftReader(ros::NodeHandle nh, ros::NodeHandle nh_private)
   nh_private.param<std::string>("global_frame_name", global_frame_name_, "map");
   nh_private.param<std::string>("drifted_sensor_frame_name",
                                 drifted_sensor_frame_name_, "os1_drifted");
+  nh_private.param<double>("frame_period", frame_period_, frame_period_);
+  nh_private.param<double>("max_time_offset", max_time_offset_,
+                           max_time_offset_);
 
   // Read drift data.
   if (drift_data_file_name_.empty()) {
@@ -32,18 +32,18 @@ DriftReader::DriftReader(ros::NodeHandle nh, ros::NodeHandle nh_private)
     LOG(WARNING) << "The specified drift data '" << drift_data_file_name_
                  << "' does not exist! No drift will be added.";
     use_drift_ = false;
+  } else if (!rollout_.load(drift_data_file_name_)) {
+    LOG(WARNING) << "Could not read the drift data '" << drift_data_file_name_
+                 << "'! No drift will be added.";
+    use_drift_ = false;
   } else {
-    // Read the drift values.
-    std::string line;
-    std::fstream fin;
-    fin.open(drift_data_file_name_, std::ios::in);
-
-    while (!fin.eof()) {
-      getline(fin, line);
-      vector_of_transformations_.push_back(line);
+    LOG(INFO) << "Read " << rollout_.size() << " drifted poses "
+              << (rollout_.hasStamps() ? "with" : "without")
+              << " timestamps from '" << drift_data_file_name_ << "'.";
+    if (!rollout_.hasStamps() && frame_period_ <= 0.0) {
+      LOG(WARNING) << "The drift data has no timestamps and 'frame_period' is "
+                      "not set, dropped clouds will offset the drift.";
     }
-    LOG(INFO) << "Read " << vector_of_transformations_.size()
-              << " drifted poses from '" << drift_data_file_name_ << "'.";
   }
 
   // Subscribe to the undistorted pointcloud topic
@@ -61,22 +61,39 @@ void DriftReader::cloudCallback(
     return;
   }
 
-  // Check data available.
-  if (frame_counter_ >= vector_of_transformations_.size()) {
+  // Rollouts without timestamps start at the first cloud.
+  const uint64_t stamp = pointcloud_msg->header.stamp.toNSec();
+  if (!rollout_.hasStamps() && frame_period_ > 0.0) {
+    rollout_.setStamps(stamp, static_cast<uint64_t>(frame_period_ * 1e9));
+  }
+
+  // Look up the drifted pose.
+  DriftPose pose;
+  if (rollout_.hasStamps()) {
+    const uint64_t max_offset = static_cast<uint64_t>(max_time_offset_ * 1e9);
+    if (stamp + max_offset < rollout_[0].stamp) {
+      LOG_EVERY_N(WARNING, 10)
+          << "Cloud at " << pointcloud_msg->header.stamp
+          << " precedes the drift data, the cloud is skipped.";
+      return;
+    }
+    if (!rollout_.lookup(stamp, max_offset, &pose)) {
+      LOG(WARNING) << "No more drift values available at "
+                   << pointcloud_msg->header.stamp
+                   << ", no more drift will be applied.";
+      ros::shutdown();
+      return;
+    }
+  } else if (frame_counter_ < rollout_.size()) {
+    pose = rollout_[frame_counter_];
+  } else {
     // Out of data.
     LOG(WARNING) << "No more drift values available at index " << frame_counter_
                  << ", no more drift will be applied.";
     ros::shutdown();
     return;
   }
-
-  // Read drift data.
-  std::vector<double> pose_data;
-  std::string word;
-  std::stringstream s(vector_of_transformations_[frame_counter_]);
-  while (getline(s, word, ',')) {
-    pose_data.push_back(std::stod(word));
-  }
+  const double* pose_data = pose.values;
 
   // Broadcast transform.
   geometry_msgs::TransformStamped transform;
@@ -0,0 +1,200 @@
+#include "drift_simulation/drift_rollout.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <Eigen/Geometry>
+#include <glog/logging.h>
+
+namespace {
+
+// Header of the binary format, followed by the packed poses.
+struct BinaryHeader {
+  char magic[4] = {'D', 'R', 'F', 'T'};
+  uint32_t version = 1u;
+  uint32_t has_stamps = 0u;
+  uint32_t reserved = 0u;
+  uint64_t num_poses = 0u;
+};
+
+bool endsWith(const std::string& value, const std::string& suffix) {
+  return value.size() >= suffix.size() &&
+         value.compare(value.size() - suffix.size(), suffix.size(), suffix) ==
+             0;
+}
+
+}  // namespace
+
+bool DriftRollout::load(const std::string& file_name) {
+  poses_.clear();
+  has_stamps_ = false;
+  const bool success =
+      endsWith(file_name, ".bin") ? readBinary(file_name) : readCsv(file_name);
+  if (!success) {
+    poses_.clear();
+    return false;
+  }
+  if (has_stamps_ &&
+      !std::is_sorted(poses_.begin(), poses_.end(),
+                      [](const DriftPose& a, const DriftPose& b) {
+                        return a.stamp < b.stamp;
+                      })) {
+    LOG(ERROR) << "The timestamps of rollout '" << file_name
+               << "' are not sorted.";
+    poses_.clear();
+    return false;
+  }
+  return true;
+}
+
+bool DriftRollout::readCsv(const std::string& file_name) {
+  std::ifstream file(file_name);
+  if (!file.is_open()) {
+    LOG(ERROR) << "Could not open rollout '" << file_name << "'.";
+    return false;
+  }
+  std::string line;
+  size_t line_number = 0u;
+  int num_columns = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+
+    // Parse all columns of the line in place.
+    double columns[8];
+    int num_values = 0;
+    uint64_t stamp = 0u;
+    const char* begin = line.c_str();
+    char* end = nullptr;
+    errno = 0;
+    while (num_values < 8) {
+      const double value = std::strtod(begin, &end);
+      if (end == begin) {
+        break;
+      }
+      if (num_values == 0) {
+        // Timestamps in ns exceed the precision of doubles.
+        stamp = std::strtoull(begin, nullptr, 10);
+      }
+      columns[num_values++] = value;
+      begin = end;
+      while (*begin == ',' || *begin == ' ' || *begin == '\t') {
+        begin++;
+      }
+    }
+    if (errno != 0 || (num_values != 7 && num_values != 8) ||
+        (num_columns != 0 && num_values != num_columns)) {
+      LOG(ERROR) << "Invalid pose in line " << line_number << " of rollout '"
+                 << file_name << "'.";
+      return false;
+    }
+    num_columns = num_values;
+
+    DriftPose& pose = poses_.emplace_back();
+    const int offset = num_values - 7;
+    if (offset) {
+      pose.stamp = stamp;
+    }
+    std::copy(columns + offset, columns + num_values, pose.values);
+  }
+  has_stamps_ = num_columns == 8;
+  return true;
+}
+
+bool DriftRollout::readBinary(const std::string& file_name) {
+  std::ifstream file(file_name, std::ios::binary);
+  BinaryHeader header;
+  const BinaryHeader expected;
+  file.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader));
+  if (!file || std::memcmp(header.magic, expected.magic, 4) != 0 ||
+      header.version != expected.version) {
+    LOG(ERROR) << "'" << file_name << "' is not a binary drift rollout.";
+    return false;
+  }
+
+  // Check the size before allocating, the header may be corrupted.
+  const std::streamoff data_start = file.tellg();
+  file.seekg(0, std::ios::end);
+  const uint64_t remaining_size = file.tellg() - data_start;
+  file.seekg(data_start);
+  if (header.num_poses > remaining_size / sizeof(DriftPose)) {
+    LOG(ERROR) << "Binary rollout '" << file_name << "' is truncated.";
+    return false;
+  }
+  poses_.resize(header.num_poses);
+  file.read(reinterpret_cast<char*>(poses_.data()),
+            header.num_poses * sizeof(DriftPose));
+  if (!file) {
+    LOG(ERROR) << "Binary rollout '" << file_name << "' is truncated.";
+    return false;
+  }
+  has_stamps_ = header.has_stamps != 0u;
+  return true;
+}
+
+bool DriftRollout::writeBinary(const std::string& file_name) const {
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  BinaryHeader header;
+  header.has_stamps = has_stamps_;
+  header.num_poses = poses_.size();
+  file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
+  file.write(reinterpret_cast<const char*>(poses_.data()),
+             poses_.size() * sizeof(DriftPose));
+  return file.good();
+}
+
+void DriftRollout::setStamps(const uint64_t first_stamp,
+                             const uint64_t period) {
+  for (size_t i = 0; i < poses_.size(); ++i) {
+    poses_[i].stamp = first_stamp + i * period;
+  }
+  has_stamps_ = true;
+}
+
+bool DriftRollout::lookup(const uint64_t stamp, const uint64_t max_offset,
+                          DriftPose* pose) const {
+  CHECK_NOTNULL(pose);
+  if (poses_.empty() || stamp + max_offset < poses_.front().stamp ||
+      stamp > poses_.back().stamp + max_offset) {
+    return false;
+  }
+
+  // Find the neighboring poses.
+  const auto next = std::lower_bound(
+      poses_.begin(), poses_.end(), stamp,
+      [](const DriftPose& a, const uint64_t b) { return a.stamp < b; });
+  if (next == poses_.begin() || next == poses_.end()) {
+    *pose = next == poses_.end() ? poses_.back() : poses_.front();
+    pose->stamp = stamp;
+    return true;
+  }
+  const DriftPose& previous = *(next - 1);
+  if (next->stamp == stamp) {
+    *pose = *next;
+    return true;
+  }
+
+  // Interpolate translation linearly and rotation spherically.
+  const double t = static_cast<double>(stamp - previous.stamp) /
+                   static_cast<double>(next->stamp - previous.stamp);
+  pose->stamp = stamp;
+  for (int i = 0; i < 3; ++i) {
+    pose->values[i] =
+        (1.0 - t) * previous.values[i] + t * next->values[i];
+  }
+  const Eigen::Quaterniond q_previous(previous.values[6], previous.values[3],
+                                      previous.values[4], previous.values[5]);
+  const Eigen::Quaterniond q_next(next->values[6], next->values[3],
+                                  next->values[4], next->values[5]);
+  const Eigen::Quaterniond q = q_previous.slerp(t, q_next).normalized();
+  pose->values[3] = q.x();
+  pose->values[4] = q.y();
+  pose->values[5] = q.z();
+  pose->values[6] = q.w();
+  return true;
+}
@@ -25,6 +25,8 @@ OdometryDriftSimulator::OdometryDriftSimulator(
                                  global_frame_name_);
   nh_private_.param<std::string>("sensor_frame_name", sensor_frame_name_,
                                  sensor_frame_name_);
+  nh_private_.param<bool>("write_timestamps", write_timestamps_,
+                          write_timestamps_);
 
   // Ensure params are set.
   if (output_drifted_file_name_.empty()) {
@@ -76,7 +78,11 @@ void OdometryDriftSimulator::poseCallback(
   std::fstream fout, fout_truth;
 
   // Write the data.
+  const uint64_t stamp = pointcloud_msg.header.stamp.toNSec();
   fout.open(output_drifted_file_name_, std::ios::out | std::ios::app);
+  if (write_timestamps_) {
+    fout << stamp << ", ";
+  }
   fout << simulated_pose_msg.transform.translation.x << ", "
        << simulated_pose_msg.transform.translation.y << ", "
        << simulated_pose_msg.transform.translation.z << ", "
@@ -90,6 +96,9 @@ void OdometryDriftSimulator::poseCallback(
 
   if (!output_gt_file_name_.empty()) {
     fout_truth.open(output_gt_file_name_, std::ios::out | std::ios::app);
+    if (write_timestamps_) {
+      fout_truth << stamp << ", ";
+    }
     fout_truth << ground_truth_pose_msg.transform.translation.x << ", "
                << ground_truth_pose_msg.transform.translation.y << ", "
                << ground_truth_pose_msg.transform.translation.z << ", "
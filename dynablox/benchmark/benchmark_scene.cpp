@@ -0,0 +1,131 @@
+#include "benchmark_scene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace dynablox {
+
+namespace {
+
+// Map layout.
+constexpr float kVoxelSize = 0.2f;
+constexpr size_t kVoxelsPerSide = 16u;
+constexpr int kMinBlockIndexXY = -4;
+constexpr int kMaxBlockIndexXY = 3;
+constexpr float kTruncationDistance = 3.f * kVoxelSize;
+constexpr float kObservedDepth = -2.f * kVoxelSize;
+
+// Scan layout.
+constexpr float kSensorHeight = 1.5f;
+constexpr float kGroundHeight = 0.05f;
+constexpr float kMaxGroundRange = 12.f;
+constexpr float kMinObjectRange = 3.f;
+constexpr float kMaxObjectRange = 10.f;
+constexpr float kObjectWidth = 0.8f;
+constexpr float kObjectMinHeight = 0.2f;
+constexpr float kObjectMaxHeight = 1.8f;
+constexpr float kObjectPointFraction = 0.2f;
+
+}  // namespace
+
+BenchmarkScene BenchmarkScene::create(const int num_points,
+                                      const int num_objects,
+                                      const unsigned int seed) {
+  BenchmarkScene scene;
+  scene.tsdf_layer = std::make_shared<TsdfLayer>(kVoxelSize, kVoxelsPerSide);
+  scene.ever_free_layer = std::make_shared<EverFreeLayer>(kVoxelsPerSide);
+
+  // Observed ground below free space, only the space well above the ground
+  // has been observed free long enough to be ever-free.
+  for (int x = kMinBlockIndexXY; x <= kMaxBlockIndexXY; ++x) {
+    for (int y = kMinBlockIndexXY; y <= kMaxBlockIndexXY; ++y) {
+      for (int z = -1; z <= 0; ++z) {
+        const BlockIndex block_index(x, y, z);
+        TsdfBlock::Ptr tsdf_block =
+            scene.tsdf_layer->allocateBlockPtrByIndex(block_index);
+        EverFreeBlock::Ptr ever_free_block =
+            scene.ever_free_layer->allocateBlockPtrByIndex(block_index);
+        tsdf_block->set_has_data(true);
+        for (size_t i = 0; i < tsdf_block->num_voxels(); ++i) {
+          const float height =
+              tsdf_block->computeCoordinatesFromLinearIndex(i).z();
+          if (height < kObservedDepth) {
+            continue;
+          }
+          TsdfVoxel& voxel = tsdf_block->getVoxelByLinearIndex(i);
+          voxel.weight = 1.f;
+          voxel.distance = std::min(height, kTruncationDistance);
+          ever_free_block->setObserved(i);
+          if (height > kTruncationDistance) {
+            ever_free_block->setFlag(i, EverFreeBlock::kEverFree);
+          }
+        }
+      }
+    }
+  }
+
+  // Sample the scan in map frame.
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  const int num_object_points =
+      num_objects > 0 ? static_cast<int>(num_points * kObjectPointFraction) : 0;
+  scene.cloud.reserve(num_points);
+  for (int i = 0; i < num_points - num_object_points; ++i) {
+    const float range = kMaxGroundRange * std::sqrt(unit(generator));
+    const float angle = 2.f * M_PI * unit(generator);
+    scene.cloud.push_back(Point(range * std::cos(angle),
+                                range * std::sin(angle), kGroundHeight));
+  }
+  std::vector<Point> object_centers(num_objects);
+  for (Point& center : object_centers) {
+    const float range =
+        kMinObjectRange + (kMaxObjectRange - kMinObjectRange) * unit(generator);
+    const float angle = 2.f * M_PI * unit(generator);
+    center = Point(range * std::cos(angle), range * std::sin(angle), 0.f);
+  }
+  for (int i = 0; i < num_object_points; ++i) {
+    // Points on the vertical faces of the box.
+    const Point& center = object_centers[i % num_objects];
+    const int face = static_cast<int>(4.f * unit(generator)) % 4;
+    const float along = kObjectWidth * (unit(generator) - 0.5f);
+    const float across = (face % 2 == 0 ? 0.5f : -0.5f) * kObjectWidth;
+    const float height =
+        kObjectMinHeight + (kObjectMaxHeight - kObjectMinHeight) *
+                               unit(generator);
+    if (face < 2) {
+      scene.cloud.push_back(
+          Point(center.x + across, center.y + along, height));
+    } else {
+      scene.cloud.push_back(
+          Point(center.x + along, center.y + across, height));
+    }
+  }
+
+  // Sensor frame input and the cloud info as produced by the preprocessing.
+  scene.T_M_S.setIdentity();
+  scene.T_M_S.setOrigin(tf::Vector3(0.0, 0.0, kSensorHeight));
+  scene.sensor_cloud = scene.cloud;
+  scene.cloud_info.sensor_position = Point(0.f, 0.f, kSensorHeight);
+  scene.cloud_info.timestamp = 0u;
+  scene.cloud_info.points.resize(scene.cloud.size());
+  for (size_t i = 0; i < scene.cloud.size(); ++i) {
+    Point& point = scene.sensor_cloud[i];
+    point.z -= kSensorHeight;
+    scene.cloud_info.points[i].distance_to_sensor =
+        std::sqrt(point.x * point.x + point.y * point.y + point.z * point.z);
+  }
+  return scene;
+}
+
+void BenchmarkScene::setAllBlocksUpdated() {
+  voxblox::BlockIndexList blocks;
+  tsdf_layer->getAllAllocatedBlocks(&blocks);
+  for (const BlockIndex& block_index : blocks) {
+    tsdf_layer->getBlockPtrByIndex(block_index)->updated().set(
+        voxblox::Update::kEsdf);
+  }
+}
+
+}  // namespace dynablox
@@ -0,0 +1,51 @@
+#ifndef DYNABLOX_BENCHMARK_BENCHMARK_SCENE_H_
+#define DYNABLOX_BENCHMARK_BENCHMARK_SCENE_H_
+
+#include <memory>
+
+#include <tf/transform_datatypes.h>
+
+#include "dynablox/common/types.h"
+#include "dynablox/map/ever_free_layer.h"
+
+namespace dynablox {
+
+/**
+ * @brief Deterministic synthetic scene to benchmark the processing components
+ * in isolation: a ground plane observed as free space above it, and boxes
+ * standing in the ever-free space that form the dynamic clusters.
+ */
+struct BenchmarkScene {
+  // Map layers. Voxels above the ground are observed free and ever-free.
+  std::shared_ptr<TsdfLayer> tsdf_layer;
+  std::shared_ptr<EverFreeLayer> ever_free_layer;
+
+  // The scan in sensor frame as input to the preprocessing.
+  Cloud sensor_cloud;
+  tf::Transform T_M_S;
+
+  // The preprocessed scan in map frame.
+  Cloud cloud;
+  CloudInfo cloud_info;
+
+  /**
+   * @brief Create the scene.
+   *
+   * @param num_points Number of points in the scan.
+   * @param num_objects Number of boxes, together observed by a fifth of the
+   * points.
+   * @param seed Seed of the random point sampling.
+   */
+  static BenchmarkScene create(int num_points, int num_objects = 10,
+                               unsigned int seed = 0u);
+
+  /**
+   * @brief Flag all TSDF blocks as updated so the ever-free integrator
+   * processes the whole map.
+   */
+  void setAllBlocksUpdated();
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_BENCHMARK_BENCHMARK_SCENE_H_
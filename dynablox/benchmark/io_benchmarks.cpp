@@ -0,0 +1,102 @@
+// Micro-benchmarks of the evaluation output on a synthetic scene.
+
+#include <filesystem>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_scene.h"
+#include "dynablox/evaluation/cloud_file.h"
+#include "dynablox/evaluation/io_tools.h"
+#include "dynablox/evaluation/label_planes.h"
+#include "dynablox/processing/clustering.h"
+#include "dynablox/processing/point_map_indexer.h"
+
+namespace dynablox {
+
+namespace {
+
+// Label the scene so the cluster ids are looked up for the dynamic points.
+Clusters clusterScene(BenchmarkScene& scene) {
+  const PointMapIndexer indexer(PointMapIndexer::Config(), scene.tsdf_layer,
+                                scene.ever_free_layer);
+  const Clustering clustering(Clustering::Config(), scene.tsdf_layer,
+                              scene.ever_free_layer);
+  BlockToPointMap point_map;
+  Clustering::ClusterIndices occupied_ever_free_voxel_indices;
+  indexer.setUpPointMap(scene.cloud, 1, point_map,
+                        occupied_ever_free_voxel_indices, scene.cloud_info);
+  return clustering.performClustering(point_map,
+                                      occupied_ever_free_voxel_indices, 1,
+                                      scene.cloud, scene.cloud_info);
+}
+
+}  // namespace
+
+void BM_SaveCloudToCsv(benchmark::State& state) {
+  BenchmarkScene scene = BenchmarkScene::create(state.range(0));
+  const Clusters clusters = clusterScene(scene);
+  const std::string file_name =
+      (std::filesystem::temp_directory_path() / "dynablox_benchmark_cloud.csv")
+          .string();
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::filesystem::remove(file_name);
+    state.ResumeTiming();
+    saveCloudToCsv(file_name, scene.cloud, scene.cloud_info, clusters);
+  }
+  std::filesystem::remove(file_name);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["clusters"] = clusters.size();
+}
+BENCHMARK(BM_SaveCloudToCsv)
+    ->ArgName("points")
+    ->Arg(1 << 14)
+    ->Arg(1 << 16)
+    ->Arg(1 << 17)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_WriteCloudFile(benchmark::State& state) {
+  BenchmarkScene scene = BenchmarkScene::create(state.range(0));
+  const Clusters clusters = clusterScene(scene);
+  const std::string file_name =
+      (std::filesystem::temp_directory_path() / "dynablox_benchmark_cloud.bin")
+          .string();
+  {
+    CloudFileWriter writer(file_name, state.range(1));
+    for (auto _ : state) {
+      writer.writeFrame(scene.cloud, scene.cloud_info, clusters);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["bytes_per_frame"] =
+      std::filesystem::file_size(file_name) / state.iterations();
+  std::filesystem::remove(file_name);
+}
+BENCHMARK(BM_WriteCloudFile)
+    ->ArgNames({"points", "compress"})
+    ->ArgsProduct({{1 << 14, 1 << 16, 1 << 17}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_CountLabels(benchmark::State& state) {
+  BenchmarkScene scene = BenchmarkScene::create(state.range(0));
+  clusterScene(scene);
+  std::vector<float> range_bins;
+  for (int i = 0; i <= state.range(1); ++i) {
+    range_bins.push_back(i * 2.f);
+  }
+  for (auto& point : scene.cloud_info.points) {
+    point.ready_for_evaluation = true;
+  }
+  for (auto _ : state) {
+    const LabelPlanes planes(scene.cloud_info, range_bins);
+    benchmark::DoNotOptimize(planes.count());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CountLabels)
+    ->ArgNames({"points", "range_bins"})
+    ->ArgsProduct({{1 << 14, 1 << 16, 1 << 17}, {0, 16}})
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace dynablox
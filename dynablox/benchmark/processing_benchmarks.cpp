@@ -0,0 +1,208 @@
+// Micro-benchmarks of the processing components on a synthetic scene.
+// Arguments are the number of points per scan and, for the parallel
+// components, the number of threads.
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_scene.h"
+#include "dynablox/common/frame_arena.h"
+#include "dynablox/processing/clustering.h"
+#include "dynablox/processing/ever_free_integrator.h"
+#include "dynablox/processing/point_map_indexer.h"
+#include "dynablox/processing/preprocessing.h"
+#include "dynablox/processing/tracking.h"
+
+namespace dynablox {
+
+namespace {
+
+const std::vector<int64_t> kNumPoints = {1 << 14, 1 << 16, 1 << 17};
+const std::vector<int64_t> kNumThreads = {1, 2, 4, 8};
+
+void densityArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgName("points");
+  for (const int64_t num_points : kNumPoints) {
+    benchmark->Arg(num_points);
+  }
+}
+
+void densityAndThreadArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"points", "threads"});
+  for (const int64_t num_points : kNumPoints) {
+    for (const int64_t num_threads : kNumThreads) {
+      benchmark->Args({num_points, num_threads});
+    }
+  }
+}
+
+// Per-frame data produced by the point map indexing.
+struct FrameData {
+  explicit FrameData(std::pmr::memory_resource* resource)
+      : point_map(resource), occupied_ever_free_voxel_indices(resource) {}
+
+  BlockToPointMap point_map;
+  Clustering::ClusterIndices occupied_ever_free_voxel_indices;
+};
+
+std::unique_ptr<PointMapIndexer> createIndexer(const BenchmarkScene& scene,
+                                               const int num_threads) {
+  PointMapIndexer::Config config;
+  config.num_threads = num_threads;
+  return std::make_unique<PointMapIndexer>(config, scene.tsdf_layer,
+                                           scene.ever_free_layer);
+}
+
+std::unique_ptr<Clustering> createClustering(const BenchmarkScene& scene) {
+  return std::make_unique<Clustering>(Clustering::Config(), scene.tsdf_layer,
+                                      scene.ever_free_layer);
+}
+
+// Run the detection up to the clustering on the scene.
+Clusters detectClusters(BenchmarkScene& scene, const PointMapIndexer& indexer,
+                        const Clustering& clustering, const int frame_counter) {
+  FrameData frame(std::pmr::get_default_resource());
+  indexer.setUpPointMap(scene.cloud, frame_counter, frame.point_map,
+                        frame.occupied_ever_free_voxel_indices,
+                        scene.cloud_info);
+  return clustering.performClustering(
+      frame.point_map, frame.occupied_ever_free_voxel_indices, frame_counter,
+      scene.cloud, scene.cloud_info);
+}
+
+}  // namespace
+
+void BM_Preprocessing(benchmark::State& state) {
+  const BenchmarkScene scene = BenchmarkScene::create(state.range(0));
+  const Preprocessing preprocessing((Preprocessing::Config()));
+  Cloud cloud;
+  CloudInfo cloud_info;
+  for (auto _ : state) {
+    state.PauseTiming();
+    cloud = scene.sensor_cloud;
+    state.ResumeTiming();
+    preprocessing.processPointcloud(0u, scene.T_M_S, cloud, cloud_info);
+    benchmark::DoNotOptimize(cloud_info.points.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Preprocessing)
+    ->Apply(densityArguments)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_PointMapIndexing(benchmark::State& state) {
+  BenchmarkScene scene = BenchmarkScene::create(state.range(0));
+  const auto indexer = createIndexer(scene, state.range(1));
+  FrameArena arena;
+  int frame_counter = 0;
+  for (auto _ : state) {
+    const FrameArena::ResetGuard arena_guard(arena);
+    FrameData frame(&arena);
+    indexer->setUpPointMap(scene.cloud, ++frame_counter, frame.point_map,
+                           frame.occupied_ever_free_voxel_indices,
+                           scene.cloud_info);
+    benchmark::DoNotOptimize(frame.point_map.size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PointMapIndexing)
+    ->Apply(densityAndThreadArguments)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_UpdateEverFreeVoxels(benchmark::State& state) {
+  BenchmarkScene scene = BenchmarkScene::create(state.range(0));
+  const auto indexer = createIndexer(scene, state.range(1));
+  EverFreeIntegrator::Config config;
+  config.num_threads = state.range(1);
+  const EverFreeIntegrator integrator(config, scene.tsdf_layer,
+                                      scene.ever_free_layer);
+  int frame_counter = 0;
+  for (auto _ : state) {
+    // Integrating a scan flags the observed blocks and marks the occupied
+    // voxels dirty.
+    state.PauseTiming();
+    ++frame_counter;
+    scene.setAllBlocksUpdated();
+    {
+      FrameData frame(std::pmr::get_default_resource());
+      indexer->setUpPointMap(scene.cloud, frame_counter, frame.point_map,
+                             frame.occupied_ever_free_voxel_indices,
+                             scene.cloud_info);
+    }
+    state.ResumeTiming();
+    integrator.updateEverFreeVoxels(frame_counter);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          scene.tsdf_layer->getNumberOfAllocatedBlocks());
+}
+BENCHMARK(BM_UpdateEverFreeVoxels)
+    ->Apply(densityAndThreadArguments)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_Clustering(benchmark::State& state) {
+  BenchmarkScene scene = BenchmarkScene::create(state.range(0));
+  const auto indexer = createIndexer(scene, 1);
+  const auto clustering = createClustering(scene);
+  int frame_counter = 0;
+  size_t num_clusters = 0u;
+  for (auto _ : state) {
+    // The indexing resets the clustering state of the occupied voxels.
+    state.PauseTiming();
+    FrameData frame(std::pmr::get_default_resource());
+    indexer->setUpPointMap(scene.cloud, ++frame_counter, frame.point_map,
+                           frame.occupied_ever_free_voxel_indices,
+                           scene.cloud_info);
+    state.ResumeTiming();
+    const Clusters clusters = clustering->performClustering(
+        frame.point_map, frame.occupied_ever_free_voxel_indices,
+        frame_counter, scene.cloud, scene.cloud_info);
+    num_clusters = clusters.size();
+  }
+  state.counters["clusters"] = num_clusters;
+}
+BENCHMARK(BM_Clustering)
+    ->Apply(densityArguments)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_MergeClusters(benchmark::State& state) {
+  BenchmarkScene scene = BenchmarkScene::create(state.range(0));
+  const auto indexer = createIndexer(scene, 1);
+  const auto clustering = createClustering(scene);
+  const Clusters candidates = detectClusters(scene, *indexer, *clustering, 1);
+  Clusters clusters;
+  for (auto _ : state) {
+    state.PauseTiming();
+    clusters = candidates;
+    state.ResumeTiming();
+    clustering->mergeClusters(scene.cloud, clusters);
+  }
+  state.counters["clusters"] = candidates.size();
+}
+BENCHMARK(BM_MergeClusters)
+    ->Apply(densityArguments)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_Tracking(benchmark::State& state) {
+  BenchmarkScene scene = BenchmarkScene::create(state.range(0));
+  const auto indexer = createIndexer(scene, 1);
+  const auto clustering = createClustering(scene);
+  const Clusters detections = detectClusters(scene, *indexer, *clustering, 1);
+  Tracking tracking((Tracking::Config()));
+  Clusters clusters;
+  for (auto _ : state) {
+    state.PauseTiming();
+    clusters = detections;
+    state.ResumeTiming();
+    tracking.track(scene.cloud, clusters, scene.cloud_info);
+  }
+  state.counters["clusters"] = detections.size();
+}
+BENCHMARK(BM_Tracking)
+    ->Apply(densityArguments)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace dynablox
@@ -0,0 +1,140 @@
+#ifndef DYNABLOX_COMMON_ALLOCATION_COUNTER_H_
+#define DYNABLOX_COMMON_ALLOCATION_COUNTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace dynablox {
+
+/**
+ * @brief Process-wide heap allocation statistics. Allocations are only counted
+ * if the allocation hooks replacing the global operator new and delete are
+ * linked into the executable and counting is enabled.
+ */
+class AllocationCounter {
+ public:
+  // Cumulative allocation counts.
+  struct Counts {
+    uint64_t num_allocations = 0u;
+    uint64_t allocated_bytes = 0u;
+  };
+
+  // Per stage allocation counts, updated by StageTimer. Also used to collect
+  // the allocations of worker threads.
+  struct StageCounts {
+    std::atomic<uint64_t> num_allocations{0u};
+    std::atomic<uint64_t> allocated_bytes{0u};
+  };
+
+  /**
+   * @brief Attributes the allocations of a worker thread to the thread that
+   * spawned it when the worker finishes, so they are counted by the stages
+   * timed on the spawning thread. Construct at the start of the worker with
+   * the counts returned by getWorkerCounts() on the spawning thread.
+   */
+  class WorkerScope {
+   public:
+    explicit WorkerScope(StageCounts* parent)
+        : parent_(isEnabled() ? parent : nullptr),
+          start_counts_(getThreadCounts()) {}
+    ~WorkerScope() {
+      if (parent_) {
+        const Counts counts = getThreadCounts();
+        parent_->num_allocations +=
+            counts.num_allocations - start_counts_.num_allocations;
+        parent_->allocated_bytes +=
+            counts.allocated_bytes - start_counts_.allocated_bytes;
+      }
+    }
+    WorkerScope(const WorkerScope&) = delete;
+    WorkerScope& operator=(const WorkerScope&) = delete;
+
+   private:
+    StageCounts* const parent_;
+    const Counts start_counts_;
+  };
+
+  // Called by the allocation hooks.
+  static void recordAllocation(size_t bytes) {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    num_allocations_.fetch_add(1u, std::memory_order_relaxed);
+    allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    thread_counts_.num_allocations++;
+    thread_counts_.allocated_bytes += bytes;
+    const int64_t current =
+        current_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    int64_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (current > peak && !peak_bytes_.compare_exchange_weak(
+                                 peak, current, std::memory_order_relaxed)) {
+    }
+  }
+  static void recordDeallocation(size_t bytes) {
+    if (enabled_.load(std::memory_order_relaxed)) {
+      current_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+  }
+  static void setInstalled() { installed_ = true; }
+
+  /**
+   * @brief Start counting allocations. Returns false if no allocation hooks
+   * are installed.
+   */
+  static bool enable();
+  static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Counts of all threads of the process.
+  static Counts getCounts();
+
+  // Counts of allocations made by the calling thread and by its finished
+  // worker threads.
+  static Counts getThreadCounts() {
+    Counts counts = thread_counts_;
+    counts.num_allocations +=
+        worker_counts_.num_allocations.load(std::memory_order_relaxed);
+    counts.allocated_bytes +=
+        worker_counts_.allocated_bytes.load(std::memory_order_relaxed);
+    return counts;
+  }
+
+  // Where workers spawned by the calling thread add their counts.
+  static StageCounts* getWorkerCounts() { return &worker_counts_; }
+
+  // Bytes allocated while counting minus bytes freed while counting.
+  static int64_t getCurrentBytes() {
+    return current_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // Highest value of getCurrentBytes() since the last resetPeak().
+  static int64_t getPeakBytes() {
+    return peak_bytes_.load(std::memory_order_relaxed);
+  }
+  static void resetPeak() { peak_bytes_.store(getCurrentBytes()); }
+
+  /**
+   * @brief Get the per stage counter of a timer tag.
+   *
+   * @return The counter or nullptr if counting is disabled.
+   */
+  static StageCounts* getStageCounts(const std::string& tag);
+
+  // Cumulative counts of all stages.
+  static std::map<std::string, Counts> getAllStageCounts();
+
+ private:
+  static std::atomic<bool> installed_;
+  static std::atomic<bool> enabled_;
+  static std::atomic<uint64_t> num_allocations_;
+  static std::atomic<uint64_t> allocated_bytes_;
+  static std::atomic<int64_t> current_bytes_;
+  static std::atomic<int64_t> peak_bytes_;
+  static thread_local Counts thread_counts_;
+  static thread_local StageCounts worker_counts_;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_ALLOCATION_COUNTER_H_
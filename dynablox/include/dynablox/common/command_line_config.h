@@ -0,0 +1,76 @@
+#ifndef DYNABLOX_COMMON_COMMAND_LINE_CONFIG_H_
+#define DYNABLOX_COMMON_COMMAND_LINE_CONFIG_H_
+
+#include <string>
+
+#include <glog/logging.h>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+
+namespace dynablox {
+
+using ParamMap = config_utilities::internal::ParamMap;
+
+/**
+ * @brief Parse a command line value as bool, int, double, or string, in this
+ * order.
+ */
+inline XmlRpc::XmlRpcValue parseParamValue(const std::string& value) {
+  if (value == "true" || value == "false") {
+    return XmlRpc::XmlRpcValue(value == "true");
+  }
+  size_t parsed = 0;
+  try {
+    const int int_value = std::stoi(value, &parsed);
+    if (parsed == value.size()) {
+      return XmlRpc::XmlRpcValue(int_value);
+    }
+    const double double_value = std::stod(value, &parsed);
+    if (parsed == value.size()) {
+      return XmlRpc::XmlRpcValue(double_value);
+    }
+  } catch (const std::exception&) {
+  }
+  return XmlRpc::XmlRpcValue(value);
+}
+
+/**
+ * @brief Parse command line arguments of the form '--name=value' into a
+ * parameter map for headless tools. Namespaces are separated by '/', e.g.
+ * '--clustering/min_cluster_size=10'. Values are parsed by parseParamValue().
+ */
+inline ParamMap getParamMapFromArgs(int argc, char** argv) {
+  ParamMap params;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const size_t separator = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || separator == std::string::npos) {
+      LOG(WARNING) << "Ignoring argument '" << arg
+                   << "', expected '--name=value'.";
+      continue;
+    }
+    const std::string name = "/" + arg.substr(2, separator - 2);
+    params[name] = parseParamValue(arg.substr(separator + 1));
+  }
+  return params;
+}
+
+/**
+ * @brief Create a config from a parameter map.
+ *
+ * @tparam ConfigT The config to create.
+ * @param params Parameters as returned by getParamMapFromArgs().
+ * @param name_space Namespace of the config params, e.g. '/clustering'.
+ */
+template <typename ConfigT>
+ConfigT getConfigFromParamMap(ParamMap params,
+                              const std::string& name_space = "") {
+  ConfigT config;
+  params["_name_space"] = XmlRpc::XmlRpcValue(name_space);
+  config_utilities::internal::setupConfigFromParamMap(params, &config);
+  return config;
+}
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_COMMAND_LINE_CONFIG_H_
@@ -0,0 +1,102 @@
+#ifndef DYNABLOX_COMMON_FRAME_ARENA_H_
+#define DYNABLOX_COMMON_FRAME_ARENA_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace dynablox {
+
+/**
+ * @brief Monotonic memory resource for transient per-frame data. Memory is
+ * only released all at once by reset() at the end of a frame, the underlying
+ * chunks are kept and reused so steady-state frames do not touch the heap.
+ * Every thread allocates from its own sub-arena (a chunk it exclusively bump
+ * allocates from), so the resource is thread safe and only locks when a thread
+ * needs a new chunk. The chunks of a thread start small and double in size, so
+ * short lived workers that allocate little do not claim a full chunk each.
+ */
+class FrameArena : public std::pmr::memory_resource {
+ public:
+  /**
+   * @brief Construct the arena.
+   *
+   * @param chunk_size Maximum size of the chunks handed to each thread
+   * [bytes]. Allocations larger than a quarter of it get dedicated chunks.
+   */
+  explicit FrameArena(size_t chunk_size = 1u << 20);
+  ~FrameArena() override;
+
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  /**
+   * @brief Release all memory handed out since the last reset. No memory
+   * allocated from the arena may be used afterwards, and no other thread may
+   * allocate concurrently.
+   */
+  void reset();
+
+  // Statistics.
+  size_t getUsedBytes() const {
+    return used_bytes_.load(std::memory_order_relaxed);
+  }
+  size_t getCapacity() const;
+
+  // Resets the arena when going out of scope. Declare it before all frame data
+  // so it is destroyed last.
+  class ResetGuard {
+   public:
+    explicit ResetGuard(FrameArena& arena) : arena_(arena) {}
+    ~ResetGuard() { arena_.reset(); }
+
+   private:
+    FrameArena& arena_;
+  };
+
+ protected:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* /* ptr */, size_t /* bytes */,
+                     size_t /* alignment */) override {}
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+ private:
+  struct Chunk {
+    char* data;
+    size_t size;
+  };
+
+  // Alignment of all chunks.
+  static constexpr size_t kChunkAlignment = 64u;
+
+  // Size of the first chunk of each thread in each frame.
+  static constexpr size_t kInitialChunkSize = 4096u;
+
+  /**
+   * @brief Get the smallest unused chunk of at least the requested size,
+   * allocating one of exactly that size if none is available.
+   */
+  Chunk acquireChunk(size_t min_size);
+
+  const size_t chunk_size_;
+  const uint64_t id_;
+
+  // Incremented on every reset to invalidate the sub-arenas of all threads.
+  std::atomic<uint64_t> generation_{1u};
+  std::atomic<size_t> used_bytes_{0u};
+
+  // All owned chunks and those not handed out since the last reset.
+  mutable std::mutex chunks_mutex_;
+  std::vector<Chunk> chunks_;
+  std::vector<Chunk> free_chunks_;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_FRAME_ARENA_H_
@@ -5,6 +5,8 @@
 #include <utility>
 #include <vector>
 
+#include "dynablox/common/trace_recorder.h"
+
 namespace dynablox {
 
 // Thread safe index getter for parallel processing of a vector.
@@ -15,7 +17,12 @@ class IndexGetter {
       : indices_(std::move(indices)), current_index_(0) {}
   bool getNextIndex(IndexT* index) {
     CHECK_NOTNULL(index);
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      // Trace how long workers idle on the contended lock.
+      TraceSpan wait_span("index_getter/wait");
+      lock.lock();
+    }
     if (current_index_ >= indices_.size()) {
       return false;
     }
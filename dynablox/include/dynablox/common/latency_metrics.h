@@ -0,0 +1,195 @@
+#ifndef DYNABLOX_COMMON_LATENCY_METRICS_H_
+#define DYNABLOX_COMMON_LATENCY_METRICS_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+
+namespace dynablox {
+
+/**
+ * @brief Lock-free latency histogram over a sliding window. Samples are counted
+ * in log-spaced buckets (8 per octave, i.e. <9% relative error) starting at
+ * 1us. The window is split into slices; recording only touches the current
+ * slice, rotating clears the oldest one.
+ */
+class LatencyHistogram {
+ public:
+  // Bucket layout.
+  static constexpr int kBucketsPerOctave = 8;
+  static constexpr int kNumOctaves = 28;  // 1us to ~268s.
+  static constexpr int kNumBuckets = kBucketsPerOctave * kNumOctaves + 1;
+  static constexpr double kMinSeconds = 1e-6;
+
+  // Statistics over the window or all samples.
+  struct Summary {
+    uint64_t count = 0u;
+    double sum = 0.0;  // [s]
+    double p50 = 0.0;  // [s]
+    double p95 = 0.0;  // [s]
+    double p99 = 0.0;  // [s]
+    double max = 0.0;  // [s]
+  };
+
+  // Constructor.
+  explicit LatencyHistogram(int num_slices);
+
+  /**
+   * @brief Record a sample. Thread safe and lock-free.
+   *
+   * @param seconds Duration to record [s].
+   */
+  void record(double seconds) {
+    const uint64_t ns = static_cast<uint64_t>(std::max(seconds, 0.0) * 1e9);
+    Slice& slice = slices_[current_slice_.load(std::memory_order_relaxed)];
+    slice.buckets[computeBucket(seconds)].fetch_add(1u,
+                                                    std::memory_order_relaxed);
+    slice.sum_ns.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max_ns = slice.max_ns.load(std::memory_order_relaxed);
+    while (ns > max_ns && !slice.max_ns.compare_exchange_weak(
+                              max_ns, ns, std::memory_order_relaxed)) {
+    }
+    total_count_.fetch_add(1u, std::memory_order_relaxed);
+    total_sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Advance the window by one slice, dropping the oldest samples. Must
+   * only be called from a single thread. Samples recorded concurrently may be
+   * attributed to either slice.
+   */
+  void rotate();
+
+  /**
+   * @brief Compute the statistics of all samples in the sliding window.
+   */
+  Summary summarizeWindow() const;
+
+  // Number and sum of all samples ever recorded.
+  uint64_t getTotalCount() const {
+    return total_count_.load(std::memory_order_relaxed);
+  }
+  double getTotalSeconds() const {
+    return total_sum_ns_.load(std::memory_order_relaxed) * 1e-9;
+  }
+
+  // Bucket helpers.
+  static int computeBucket(double seconds);
+  static double getBucketUpperBound(int bucket);
+
+ private:
+  struct Slice {
+    std::array<std::atomic<uint64_t>, kNumBuckets> buckets{};
+    std::atomic<uint64_t> sum_ns{0u};
+    std::atomic<uint64_t> max_ns{0u};
+  };
+
+  const int num_slices_;
+  std::unique_ptr<Slice[]> slices_;
+  std::atomic<int> current_slice_{0};
+  std::atomic<uint64_t> total_count_{0u};
+  std::atomic<uint64_t> total_sum_ns_{0u};
+};
+
+/**
+ * @brief Global registry of latency histograms per timer tag. Periodically
+ * exports percentiles over a sliding window as Prometheus text and JSON.
+ * Recording is disabled until setup() is called with enable set.
+ */
+class LatencyMetrics {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Record latency histograms for all timed stages.
+    bool enable = false;
+
+    // Where to write 'metrics.prom' and 'metrics.json'. Empty to not export.
+    std::string output_directory = "";
+
+    // Period at which the metrics files are rewritten [s].
+    float dump_period = 5.f;
+
+    // Duration of the sliding window the percentiles are computed over [s].
+    float window_duration = 60.f;
+
+    // Number of slices the window is advanced by. More slices smooth the
+    // window at the cost of memory.
+    int window_slices = 6;
+
+    Config() { setConfigName("LatencyMetrics"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  /**
+   * @brief Enable recording and start the export thread if configured.
+   */
+  static void setup(const Config& config);
+
+  /**
+   * @brief Stop the export thread and write the metrics a last time.
+   */
+  static void shutdown();
+
+  /**
+   * @brief Get the histogram for a tag, creating it if necessary.
+   *
+   * @param tag Name of the timed stage.
+   * @return The histogram or nullptr if recording is disabled.
+   */
+  static LatencyHistogram* getHistogram(const std::string& tag);
+
+  static bool isEnabled() {
+    return instance().enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Compute the statistics over the sliding window of all tags.
+   */
+  static std::map<std::string, LatencyHistogram::Summary> getSummaries();
+
+  // Export formats.
+  static std::string printPrometheus();
+  static std::string printJson();
+
+  /**
+   * @brief Write both export formats to the output directory.
+   */
+  static void writeToFiles();
+
+ private:
+  LatencyMetrics() = default;
+  static LatencyMetrics& instance();
+
+  // Rotates the windows and exports the metrics until shutdown.
+  void exportLoop();
+
+  Config config_;
+  std::atomic<bool> enabled_{false};
+
+  // Histograms are never removed, so returned pointers stay valid.
+  std::mutex histograms_mutex_;
+  std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms_;
+
+  // Export thread.
+  std::thread export_thread_;
+  std::mutex export_mutex_;
+  std::condition_variable export_condition_;
+  bool stop_export_ = false;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_LATENCY_METRICS_H_
@@ -0,0 +1,111 @@
+#ifndef DYNABLOX_COMMON_LATEST_FRAME_SCHEDULER_H_
+#define DYNABLOX_COMMON_LATEST_FRAME_SCHEDULER_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace dynablox {
+
+/**
+ * @brief Thread safe hand-over of frames from an input thread to a processing
+ * thread that always processes the newest frame. Frames that arrive while the
+ * previous one is processed are skipped; the most recent skipped frames can be
+ * retrieved, e.g. to integrate them without running detection.
+ */
+template <typename FrameT>
+class LatestFrameScheduler {
+ public:
+  // Statistics of the scheduler.
+  struct Statistics {
+    size_t num_received = 0;
+    size_t num_processed = 0;
+    size_t num_skipped = 0;
+    double mean_latency = 0.0;  // [s]
+    double max_latency = 0.0;   // [s]
+  };
+
+  /**
+   * @param max_skipped_frames Maximum number of skipped frames to keep for
+   * retrieval. Older skipped frames are dropped.
+   */
+  explicit LatestFrameScheduler(size_t max_skipped_frames = 0)
+      : max_skipped_frames_(max_skipped_frames) {}
+
+  // Add a new frame, called by the input thread.
+  void push(FrameT frame) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.push_back(std::move(frame));
+      statistics_.num_received++;
+      if (pending_.size() > max_skipped_frames_ + 1) {
+        pending_.pop_front();
+        statistics_.num_skipped++;
+      }
+    }
+    condition_.notify_one();
+  }
+
+  /**
+   * @brief Wait for the next frame, called by the processing thread.
+   *
+   * @param frame Where to store the newest frame.
+   * @param skipped_frames Where to store the retained skipped frames, oldest
+   * first.
+   * @return False if the scheduler was stopped.
+   */
+  bool waitForLatest(FrameT& frame, std::vector<FrameT>& skipped_frames) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]() { return stopped_ || !pending_.empty(); });
+    if (stopped_) {
+      return false;
+    }
+    frame = std::move(pending_.back());
+    pending_.pop_back();
+    skipped_frames.assign(std::make_move_iterator(pending_.begin()),
+                          std::make_move_iterator(pending_.end()));
+    statistics_.num_skipped += pending_.size();
+    statistics_.num_processed++;
+    pending_.clear();
+    return true;
+  }
+
+  // Record the end-to-end latency of a processed frame [s].
+  void recordLatency(const double latency) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    num_latencies_++;
+    statistics_.mean_latency +=
+        (latency - statistics_.mean_latency) / num_latencies_;
+    statistics_.max_latency = std::max(statistics_.max_latency, latency);
+  }
+
+  // Wake up and release the processing thread.
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    condition_.notify_all();
+  }
+
+  Statistics getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+  }
+
+ private:
+  const size_t max_skipped_frames_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<FrameT> pending_;
+  bool stopped_ = false;
+  Statistics statistics_;
+  size_t num_latencies_ = 0;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_LATEST_FRAME_SCHEDULER_H_
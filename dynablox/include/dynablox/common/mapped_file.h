@@ -0,0 +1,36 @@
+#ifndef DYNABLOX_COMMON_MAPPED_FILE_H_
+#define DYNABLOX_COMMON_MAPPED_FILE_H_
+
+#include <string>
+
+namespace dynablox {
+
+/**
+ * @brief Read-only memory mapping of a whole file. Pages are loaded by the OS
+ * on first access, so opening large files is cheap.
+ */
+class MappedFile {
+ public:
+  /**
+   * @brief Map the file. Check isOpen() for success, empty files can not be
+   * mapped.
+   */
+  explicit MappedFile(const std::string& file_name);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool isOpen() const { return data_ != nullptr; }
+  const char* data() const { return data_; }
+  const char* end() const { return data_ + size_; }
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0u;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_MAPPED_FILE_H_
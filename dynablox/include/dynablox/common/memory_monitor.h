@@ -0,0 +1,134 @@
+#ifndef DYNABLOX_COMMON_MEMORY_MONITOR_H_
+#define DYNABLOX_COMMON_MEMORY_MONITOR_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/allocation_counter.h"
+#include "dynablox/common/types.h"
+#include "dynablox/map/ever_free_layer.h"
+
+namespace dynablox {
+
+// Memory usage of the map and the per-frame data structures.
+struct MemoryReport {
+  // Frame the report was computed at.
+  int frame = 0;
+
+  // Map layers.
+  size_t tsdf_blocks = 0u;
+  size_t tsdf_bytes = 0u;
+  size_t ever_free_blocks = 0u;
+  size_t ever_free_bytes = 0u;
+  size_t mesh_blocks = 0u;
+  size_t mesh_bytes = 0u;
+
+  // Per-frame structures of the last frame.
+  size_t point_map_bytes = 0u;
+  size_t cluster_bytes = 0u;
+
+  // Heap statistics, only available if allocation counting is enabled. Frame
+  // statistics are the maxima over all frames since the last report.
+  bool has_heap_statistics = false;
+  int64_t heap_bytes = 0;
+  int64_t peak_frame_transient_bytes = 0;
+  uint64_t frame_allocations = 0u;
+
+  // Mean allocations per frame of each stage since the last report, counted
+  // on the thread running the stage.
+  std::map<std::string, double> stage_allocations_per_frame;
+
+  std::string print() const;
+};
+
+/**
+ * @brief Collects the memory usage of the map layers, per-frame structures,
+ * and heap allocations of each frame.
+ */
+class MemoryMonitor {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Monitor memory usage.
+    bool enable = false;
+
+    // Count heap allocations per frame and stage. Requires the allocation
+    // hooks to be linked into the executable.
+    bool count_allocations = true;
+
+    // Compute and log a report every n frames.
+    int report_every_n_frames = 100;
+
+    Config() { setConfigName("MemoryMonitor"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // Constructor.
+  MemoryMonitor(const Config& config, TsdfLayer::Ptr tsdf_layer,
+                EverFreeLayer::Ptr ever_free_layer);
+
+  bool isEnabled() const { return config_.enable; }
+
+  /**
+   * @brief Reset the per-frame heap statistics. Call before processing a frame.
+   */
+  void startFrame();
+
+  /**
+   * @brief Record the size of the per-frame data structures.
+   *
+   * @param point_map Block to point map of the frame.
+   * @param clusters Clusters of the frame.
+   */
+  void recordFrameStructures(const BlockToPointMap& point_map,
+                             const Clusters& clusters);
+
+  /**
+   * @brief Update the heap statistics of the frame and compute a report if
+   * due. Call after a frame is finished.
+   *
+   * @param frame Current frame number.
+   * @param mesh_blocks Number of allocated blocks of the visualization mesh.
+   * @param mesh_bytes Memory of the visualization mesh.
+   * @return True if a new report was computed.
+   */
+  bool finishFrame(int frame, size_t mesh_blocks, size_t mesh_bytes);
+
+  /**
+   * @brief Get the last computed report. Thread safe.
+   */
+  MemoryReport getReport() const;
+
+  // Memory estimates of per-frame structures.
+  static size_t estimateMemorySize(const BlockToPointMap& point_map);
+  static size_t estimateMemorySize(const Clusters& clusters);
+
+ private:
+  const Config config_;
+  const TsdfLayer::Ptr tsdf_layer_;
+  const EverFreeLayer::Ptr ever_free_layer_;
+
+  // Statistics of the current frame.
+  MemoryReport current_;
+  AllocationCounter::Counts frame_start_counts_;
+  int64_t frame_start_bytes_ = 0;
+
+  // Stage counts at the last report.
+  std::map<std::string, AllocationCounter::Counts> last_stage_counts_;
+  int last_report_frame_ = 0;
+
+  // Last completed report.
+  mutable std::mutex report_mutex_;
+  MemoryReport report_;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_MEMORY_MONITOR_H_
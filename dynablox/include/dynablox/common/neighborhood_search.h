@@ -36,6 +36,13 @@ class NeighborhoodSearch {
     return neighbors;
   }
 
+  // Overwrites the neighbors in place to reuse their memory in loops.
+  void search(const BlockIndex& block_index, const VoxelIndex& voxel_index,
+              const size_t voxels_per_side,
+              voxblox::AlignedVector<voxblox::VoxelKey>* neighbors) const {
+    search_(block_index, voxel_index, voxels_per_side, neighbors);
+  }
+
  private:
   std::function<void(const BlockIndex&, const VoxelIndex&, const size_t,
                      voxblox::AlignedVector<voxblox::VoxelKey>*)>
@@ -0,0 +1,122 @@
+#ifndef DYNABLOX_COMMON_SHARED_MEMORY_ADAPTER_H_
+#define DYNABLOX_COMMON_SHARED_MEMORY_ADAPTER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <tf/transform_datatypes.h>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/shared_memory_ring.h"
+#include "dynablox/common/types.h"
+
+namespace dynablox {
+
+// Layout of a scan slot, followed by num_points * (x, y, z) floats in sensor
+// frame.
+struct SharedMemoryScanHeader {
+  uint64_t timestamp;  // [ns]
+  double position[3];  // Sensor position in map frame.
+  double rotation[4];  // Sensor orientation in map frame as (x, y, z, w).
+  uint32_t num_points;
+  uint32_t reserved;
+};
+
+// Layout of a label slot, followed by num_points label bytes.
+struct SharedMemoryLabelHeader {
+  uint64_t timestamp;  // [ns]
+  uint32_t num_points;
+  uint32_t reserved;
+};
+
+// Bits of the per point labels.
+enum SharedMemoryLabel : uint8_t {
+  kEverFreeLevelDynamic = 1u << 0,
+  kClusterLevelDynamic = 1u << 1,
+  kObjectLevelDynamic = 1u << 2,
+};
+
+/**
+ * @brief Input adapter reading scans and poses from a shared memory ring that
+ * is written by a co-located driver process, and writing the detected labels
+ * back to a second ring.
+ */
+class SharedMemoryAdapter {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Name of the scan ring created by the producer. Leave empty to disable.
+    std::string scan_ring_name = "";
+
+    // Name of the label ring created by the detector. Leave empty to not write
+    // labels.
+    std::string label_ring_name = "";
+
+    // Number of slots in the label ring.
+    int label_ring_slots = 8;
+
+    // Maximum number of points per scan, determines the label slot size.
+    int max_points = 262144;
+
+    Config() { setConfigName("SharedMemoryAdapter"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // Constructor.
+  explicit SharedMemoryAdapter(const Config& config);
+
+  /**
+   * @brief Try to connect to the scan ring if it is not yet open, e.g. because
+   * the producer started after the detector. Attempts are spaced with an
+   * exponential backoff of up to one second and logged once. Once the open
+   * ring is drained, it is periodically checked for being replaced by a
+   * restarted producer, in which case the new ring is connected.
+   *
+   * @return True if the scan ring is open.
+   */
+  bool connect();
+
+  /**
+   * @brief Read the next scan from the ring if available.
+   *
+   * @param cloud Where to store the points in sensor frame.
+   * @param timestamp Where to store the scan timestamp [ns].
+   * @param T_M_S Where to store the sensor pose in map frame.
+   * @return True if a scan was read.
+   */
+  bool readScan(Cloud& cloud, uint64_t& timestamp, tf::Transform& T_M_S);
+
+  /**
+   * @brief Write the labels of a processed scan to the label ring. Drops the
+   * labels if the ring is full or not configured.
+   *
+   * @param cloud_info Cloud info of the processed scan.
+   * @return True if the labels were written.
+   */
+  bool writeLabels(const CloudInfo& cloud_info);
+
+  // Number of scans waiting in the scan ring.
+  size_t numPendingScans() const {
+    return scan_ring_ ? scan_ring_->numFilledSlots() : 0u;
+  }
+
+ private:
+  const Config config_;
+  std::unique_ptr<SharedMemoryRing> scan_ring_;
+  std::unique_ptr<SharedMemoryRing> label_ring_;
+
+  // Connection attempts.
+  std::chrono::steady_clock::time_point next_connect_time_;
+  std::chrono::milliseconds connect_backoff_{1};
+  bool logged_waiting_ = false;
+  std::chrono::steady_clock::time_point next_stale_check_time_;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_SHARED_MEMORY_ADAPTER_H_
@@ -0,0 +1,102 @@
+#ifndef DYNABLOX_COMMON_SHARED_MEMORY_RING_H_
+#define DYNABLOX_COMMON_SHARED_MEMORY_RING_H_
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace dynablox {
+
+/**
+ * @brief Single-producer single-consumer ring buffer of fixed size slots in
+ * POSIX shared memory. The producer fills a slot in place and commits it, the
+ * consumer reads it in place and releases it, so no data is copied or
+ * serialized between the processes.
+ */
+class SharedMemoryRing {
+ public:
+  /**
+   * @brief Create a new ring, replacing any existing ring of the same name.
+   * The shared memory is unlinked when the creating object is destroyed.
+   *
+   * @param name Name of the shared memory object, e.g. '/dynablox_scans'.
+   * @param num_slots Number of slots in the ring.
+   * @param slot_size Size of each slot in bytes.
+   */
+  SharedMemoryRing(const std::string& name, size_t num_slots,
+                   size_t slot_size);
+
+  /**
+   * @brief Open an existing ring created by another process.
+   *
+   * @param name Name of the shared memory object.
+   */
+  explicit SharedMemoryRing(const std::string& name);
+
+  // Check whether a shared memory object of this name exists, without logging.
+  static bool exists(const std::string& name);
+
+  /**
+   * @brief Check whether the shared memory object of this name was unlinked or
+   * replaced by a new ring since this ring was opened, e.g. because the
+   * producer restarted. A stale ring no longer receives data.
+   *
+   * @return True if the name no longer refers to this ring.
+   */
+  bool isStale() const;
+
+  ~SharedMemoryRing();
+  SharedMemoryRing(const SharedMemoryRing&) = delete;
+  SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+  // Information.
+  bool isOpen() const { return header_ != nullptr; }
+  size_t numSlots() const;
+  size_t slotSize() const;
+  size_t numFilledSlots() const;
+
+  // Producer. beginWrite() returns nullptr if the ring is full.
+  uint8_t* beginWrite();
+  void commitWrite();
+
+  // Consumer. beginRead() returns nullptr if the ring is empty.
+  const uint8_t* beginRead();
+  void commitRead();
+
+ private:
+  static constexpr uint32_t kMagic = 0x44524e47;  // 'DRNG'
+  static constexpr uint32_t kVersion = 1;
+
+  // Layout of the start of the shared memory. The indices are on separate
+  // cache lines to avoid false sharing between producer and consumer. The
+  // magic is published last, so readers only see initialized headers.
+  struct Header {
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint64_t num_slots;
+    uint64_t slot_size;
+    alignas(64) std::atomic<uint64_t> write_index;
+    alignas(64) std::atomic<uint64_t> read_index;
+  };
+
+  const std::string name_;
+  bool is_owner_ = false;
+  void* data_ = nullptr;
+  size_t mapped_size_ = 0;
+  Header* header_ = nullptr;
+  uint8_t* slots_ = nullptr;
+
+  // Identity of the mapped shared memory object.
+  dev_t device_ = 0;
+  ino_t inode_ = 0;
+
+  // Map the shared memory object and store its identity.
+  bool map(int fd, size_t size);
+  uint8_t* slot(uint64_t index) const;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_SHARED_MEMORY_RING_H_
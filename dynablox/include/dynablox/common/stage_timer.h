@@ -0,0 +1,89 @@
+#ifndef DYNABLOX_COMMON_STAGE_TIMER_H_
+#define DYNABLOX_COMMON_STAGE_TIMER_H_
+
+#include <chrono>
+#include <string>
+
+#include <voxblox/utils/timing.h>
+
+#include "dynablox/common/allocation_counter.h"
+#include "dynablox/common/latency_metrics.h"
+#include "dynablox/common/trace_recorder.h"
+
+namespace dynablox {
+
+/**
+ * @brief Drop-in replacement for voxblox::timing::Timer that additionally
+ * records every measurement in the latency histogram of its tag if latency
+ * metrics are enabled, and as a trace span if tracing is enabled. Heap
+ * allocations during the measurement are counted per tag if allocation
+ * counting is enabled. Allocations of the thread running the timer and of the
+ * worker threads it spawned with an AllocationCounter::WorkerScope are
+ * counted, so concurrent stages do not inflate each other's counts.
+ */
+class StageTimer {
+ public:
+  explicit StageTimer(const std::string& tag, bool construct_stopped = false)
+      : timer_(tag, true),
+        histogram_(LatencyMetrics::getHistogram(tag)),
+        trace_name_(TraceRecorder::isEnabled() ? TraceRecorder::internName(tag)
+                                               : nullptr),
+        allocations_(AllocationCounter::getStageCounts(tag)) {
+    if (!construct_stopped) {
+      Start();
+    }
+  }
+
+  ~StageTimer() {
+    if (IsTiming()) {
+      Stop();
+    }
+  }
+
+  void Start() {
+    timer_.Start();
+    if (histogram_ || trace_name_) {
+      start_time_ = std::chrono::steady_clock::now();
+    }
+    if (allocations_) {
+      start_counts_ = AllocationCounter::getThreadCounts();
+    }
+  }
+
+  void Stop() {
+    timer_.Stop();
+    if (allocations_) {
+      const AllocationCounter::Counts counts =
+          AllocationCounter::getThreadCounts();
+      allocations_->num_allocations +=
+          counts.num_allocations - start_counts_.num_allocations;
+      allocations_->allocated_bytes +=
+          counts.allocated_bytes - start_counts_.allocated_bytes;
+    }
+    if (!histogram_ && !trace_name_) {
+      return;
+    }
+    const auto end_time = std::chrono::steady_clock::now();
+    if (histogram_) {
+      histogram_->record(
+          std::chrono::duration<double>(end_time - start_time_).count());
+    }
+    if (trace_name_) {
+      TraceRecorder::record(trace_name_, start_time_, end_time);
+    }
+  }
+
+  bool IsTiming() const { return timer_.IsTiming(); }
+
+ private:
+  voxblox::timing::Timer timer_;
+  LatencyHistogram* const histogram_;
+  const char* const trace_name_;
+  AllocationCounter::StageCounts* const allocations_;
+  std::chrono::steady_clock::time_point start_time_;
+  AllocationCounter::Counts start_counts_;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_STAGE_TIMER_H_
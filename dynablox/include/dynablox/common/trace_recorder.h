@@ -0,0 +1,168 @@
+#ifndef DYNABLOX_COMMON_TRACE_RECORDER_H_
+#define DYNABLOX_COMMON_TRACE_RECORDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+
+namespace dynablox {
+
+/**
+ * @brief Records timed spans of all threads into per-thread buffers and
+ * writes them as Chrome trace JSON, which can be opened in Perfetto or
+ * chrome://tracing. Recording is lock-free, buffers are only locked when a
+ * thread records its first span. Threads that exit return their buffer to a
+ * pool, so short lived worker threads reuse the same trace lanes.
+ */
+class TraceRecorder {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Record spans of all timed stages and worker threads.
+    bool enable = false;
+
+    // Where to write the trace at shutdown.
+    std::string output_file = "/tmp/dynablox_trace.json";
+
+    // Number of spans each buffer holds. Further spans are dropped.
+    int max_events_per_thread = 65536;
+
+    Config() { setConfigName("TraceRecorder"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // A recorded span.
+  struct Event {
+    const char* name;
+    int64_t start_ns;
+    int64_t duration_ns;
+    int frame;
+    int64_t count;
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Enable recording of spans.
+   */
+  static void setup(const Config& config);
+
+  /**
+   * @brief Disable recording and write the trace file.
+   */
+  static void shutdown();
+
+  static bool isEnabled() {
+    return instance().enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Set the frame id attached to all following spans.
+   */
+  static void setFrame(int frame) {
+    instance().frame_.store(frame, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get a pointer to a copy of the name that stays valid for the
+   * lifetime of the program, to record spans with dynamic names.
+   */
+  static const char* internName(const std::string& name);
+
+  /**
+   * @brief Record a span in the buffer of the calling thread.
+   *
+   * @param name Name of the span, must stay valid until shutdown.
+   * @param start Start time of the span.
+   * @param end End time of the span.
+   * @param count Optional count attached to the span, e.g. processed blocks.
+   * Negative values are not written.
+   */
+  static void record(const char* name, Clock::time_point start,
+                     Clock::time_point end, int64_t count = -1);
+
+  /**
+   * @brief Write all recorded spans as Chrome trace JSON.
+   *
+   * @param file_name File to write.
+   * @return Success.
+   */
+  static bool writeTrace(const std::string& file_name);
+
+ private:
+  // Single-writer event buffer.
+  struct ThreadBuffer {
+    int id;
+    std::vector<Event> events;
+    std::atomic<size_t> size{0u};
+    std::atomic<uint64_t> dropped{0u};
+  };
+
+  // Returns the buffer of a thread to the pool when the thread exits.
+  struct ThreadBufferHandle {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadBufferHandle();
+  };
+
+  TraceRecorder() = default;
+  static TraceRecorder& instance();
+  ThreadBuffer* getThreadBuffer();
+
+  Config config_;
+  std::atomic<bool> enabled_{false};
+  std::atomic<int> frame_{0};
+  Clock::time_point start_time_;
+
+  // All buffers, and the ones currently not owned by a thread.
+  std::mutex buffers_mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+  std::vector<ThreadBuffer*> free_buffers_;
+
+  // Interned span names.
+  std::mutex names_mutex_;
+  std::set<std::string> names_;
+};
+
+/**
+ * @brief Records a span from construction to destruction if tracing is
+ * enabled.
+ */
+class TraceSpan {
+ public:
+  // The name must stay valid until shutdown, e.g. a string literal.
+  explicit TraceSpan(const char* name)
+      : name_(TraceRecorder::isEnabled() ? name : nullptr) {
+    if (name_) {
+      start_time_ = TraceRecorder::Clock::now();
+    }
+  }
+
+  ~TraceSpan() {
+    if (name_) {
+      TraceRecorder::record(name_, start_time_, TraceRecorder::Clock::now(),
+                            count_);
+    }
+  }
+
+  // Attach a count to the span, e.g. the number of processed blocks.
+  void setCount(int64_t count) { count_ = count; }
+
+ private:
+  const char* const name_;
+  TraceRecorder::Clock::time_point start_time_;
+  int64_t count_ = -1;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_COMMON_TRACE_RECORDER_H_
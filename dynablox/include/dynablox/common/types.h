@@ -1,11 +1,14 @@
 #ifndef DYNABLOX_COMMON_TYPES_H_
 #define DYNABLOX_COMMON_TYPES_H_
 
+#include <memory_resource>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <pcl_ros/point_cloud.h>
 #include <voxblox/core/block.h>
+#include <voxblox/core/block_hash.h>
 #include <voxblox/core/common.h>
 #include <voxblox/core/layer.h>
 #include <voxblox/core/voxel.h>
@@ -35,6 +38,9 @@ struct PointInfo {
   // Set to true if the point belongs to a tracked object.
   bool object_level_dynamic = false;
 
+  // Set to false if the point was dropped to meet the frame time budget.
+  bool processed = true;
+
   // Distance of the point to the sensor.
   double distance_to_sensor = -1.0;
 
@@ -42,19 +48,33 @@ struct PointInfo {
   bool ground_truth_dynamic = false;
 };
 
-// Additional information for a point cloud.
+// Additional information for a point cloud. Per-frame containers take a memory
+// resource so they can be allocated from a frame arena, copies use the heap.
 struct CloudInfo {
+  explicit CloudInfo(std::pmr::memory_resource* resource =
+                         std::pmr::get_default_resource())
+      : points(resource) {}
+
   bool has_labels = false;
   std::uint64_t timestamp;
   Point sensor_position;
-  std::vector<PointInfo> points;
+  std::pmr::vector<PointInfo> points;
 };
 
+// Indices of points in the cloud.
+using PointIndices = std::pmr::vector<size_t>;
+
+// Maps each block to all point cloud indices that fall into in it.
+using BlockToPointIndicesMap =
+    std::pmr::unordered_map<BlockIndex, PointIndices, voxblox::AnyIndexHash>;
+
 // Maps each voxel in a block to all point cloud indices that fall into in it.
-using VoxelToPointMap = voxblox::HierarchicalIndexIntMap;
+using VoxelToPointMap =
+    std::pmr::unordered_map<VoxelIndex, PointIndices, voxblox::AnyIndexHash>;
 
 // Map of block indices to voxel indices and point indices of the cloud.
-using BlockToPointMap = voxblox::AnyIndexHashMapType<VoxelToPointMap>::type;
+using BlockToPointMap = std::pmr::unordered_map<BlockIndex, VoxelToPointMap,
+                                                voxblox::AnyIndexHash>;
 
 // Simple axis-aligned bounding box.
 struct BoundingBox {
@@ -88,17 +108,40 @@ struct BoundingBox {
   }
 };
 
-// Indices of all points in the cloud belonging to this cluster.
+// Indices of all points in the cloud belonging to this cluster. Allocator
+// aware, so clusters stored in Clusters use the memory resource of the vector.
 struct Cluster {
-  int id = -1;                // ID of the cluster set during tracking.
-  int track_length = 0;       // Frames this cluster has been tracked.
-  bool valid = false;         // Whether the cluster has met all cluster checks.
-  BoundingBox aabb;           // Axis-aligned bounding box of the cluster.
-  std::vector<int> points;    // Indices of points in cloud.
-  std::vector<Point> voxels;  // Center points of voxels in this cluster.
+  using allocator_type = std::pmr::polymorphic_allocator<Cluster>;
+
+  explicit Cluster(const allocator_type& allocator = {})
+      : points(allocator), voxels(allocator) {}
+  Cluster(const Cluster& other, const allocator_type& allocator = {})
+      : id(other.id),
+        track_length(other.track_length),
+        valid(other.valid),
+        aabb(other.aabb),
+        points(other.points, allocator),
+        voxels(other.voxels, allocator) {}
+  Cluster(Cluster&& other) = default;
+  Cluster(Cluster&& other, const allocator_type& allocator)
+      : id(other.id),
+        track_length(other.track_length),
+        valid(other.valid),
+        aabb(other.aabb),
+        points(std::move(other.points), allocator),
+        voxels(std::move(other.voxels), allocator) {}
+  Cluster& operator=(const Cluster& other) = default;
+  Cluster& operator=(Cluster&& other) = default;
+
+  int id = -1;            // ID of the cluster set during tracking.
+  int track_length = 0;   // Frames this cluster has been tracked.
+  bool valid = false;     // Whether the cluster has met all cluster checks.
+  BoundingBox aabb;       // Axis-aligned bounding box of the cluster.
+  std::pmr::vector<int> points;    // Indices of points in cloud.
+  std::pmr::vector<Point> voxels;  // Center points of voxels in this cluster.
 };
 
-using Clusters = std::vector<Cluster>;
+using Clusters = std::pmr::vector<Cluster>;
 
 }  // namespace dynablox
 
@@ -0,0 +1,126 @@
+#ifndef DYNABLOX_EVALUATION_CLOUD_FILE_H_
+#define DYNABLOX_EVALUATION_CLOUD_FILE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "dynablox/common/types.h"
+
+namespace dynablox {
+
+/**
+ * @brief Binary columnar format for evaluated clouds, replacing the csv files
+ * for large sequences. The file starts with an 8 byte magic and a uint32
+ * version, followed by one chunk per frame. Each chunk has a header (magic,
+ * cloud id, timestamp, number of points, flags, payload size) and a payload,
+ * optionally zlib compressed, that stores the columns x, y, z and distance as
+ * float32, one bit plane per label, and the int32 cluster ids. All values are
+ * stored in little endian.
+ */
+namespace cloud_file {
+
+constexpr char kMagic[8] = {'D', 'B', 'X', 'C', 'L', 'O', 'U', 'D'};
+constexpr uint32_t kVersion = 1u;
+constexpr uint32_t kChunkMagic = 0x4d415246u;  // 'FRAM'.
+
+// Chunk flags.
+constexpr uint32_t kHasLabels = 1u << 0;
+constexpr uint32_t kCompressed = 1u << 1;
+
+// Order of the label bit planes in the payload.
+enum Label : int {
+  kEverFree = 0,
+  kClusterDynamic,
+  kObjectDynamic,
+  kGroundTruthDynamic,
+  kReadyForEvaluation,
+  kNumLabels
+};
+
+// Header of a frame chunk as stored in the file.
+#pragma pack(push, 1)
+struct ChunkHeader {
+  uint32_t magic = kChunkMagic;
+  int32_t cloud_id = 0;
+  uint64_t timestamp = 0u;
+  uint32_t num_points = 0u;
+  uint32_t flags = 0u;
+  uint64_t payload_size = 0u;  // Stored size in bytes.
+};
+#pragma pack(pop)
+
+// Size of the uncompressed payload for the given number of points.
+inline size_t rawPayloadSize(const size_t num_points) {
+  return num_points * (4u * sizeof(float) + sizeof(int32_t)) +
+         kNumLabels * ((num_points + 7u) / 8u);
+}
+
+/**
+ * @brief Decode the payload of a frame. Files are read through the
+ * MappedCloudReader, which uses this to parse binary frames.
+ *
+ * @param header Header of the frame.
+ * @param data Stored payload, compressed if flagged in the header.
+ * @param size Size of the stored payload.
+ * @param cloud Where to store the points.
+ * @param cloud_info Where to store the labels, distances, and timestamp.
+ * @param clusters Where to store the clusters of cluster-dynamic points.
+ * @return True if the frame was decoded.
+ */
+bool decodeFrame(const ChunkHeader& header, const uint8_t* data, size_t size,
+                 Cloud& cloud, CloudInfo& cloud_info, Clusters& clusters);
+
+}  // namespace cloud_file
+
+/**
+ * @brief Writes evaluated clouds to a binary cloud file. The file is kept open
+ * and each frame is appended as a single chunk.
+ */
+class CloudFileWriter {
+ public:
+  /**
+   * @brief Create the file, overwriting existing files.
+   *
+   * @param file_name Full path of output file.
+   * @param compress If true, compress the payload of each frame with zlib.
+   */
+  explicit CloudFileWriter(const std::string& file_name, bool compress = false);
+
+  bool isOpen() const { return file_.is_open(); }
+
+  /**
+   * @brief Append a frame to the file.
+   *
+   * @param cloud Point cloud to save.
+   * @param cloud_info Associated point infos to save.
+   * @param clusters Clusters to get the cluster ids of the points.
+   * @param cloud_id ID of the cloud to be stored.
+   * @return True if the frame was written.
+   */
+  bool writeFrame(const Cloud& cloud, const CloudInfo& cloud_info,
+                  const Clusters& clusters = Clusters(), int cloud_id = 0);
+
+ private:
+  const bool compress_;
+  std::ofstream file_;
+
+  // Buffers reused across frames.
+  std::vector<uint8_t> payload_;
+  std::vector<uint8_t> compressed_;
+};
+
+/**
+ * @brief Convert a binary cloud file to the csv format of saveCloudToCsv().
+ *
+ * @param file_name Full path of the binary input file.
+ * @param csv_file_name Full path of the csv output file, will be overwritten.
+ * @return True if all frames were converted.
+ */
+bool convertCloudFileToCsv(const std::string& file_name,
+                           const std::string& csv_file_name);
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_EVALUATION_CLOUD_FILE_H_
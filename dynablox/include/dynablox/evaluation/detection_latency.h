@@ -0,0 +1,135 @@
+#ifndef DYNABLOX_EVALUATION_DETECTION_LATENCY_H_
+#define DYNABLOX_EVALUATION_DETECTION_LATENCY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/types.h"
+
+namespace dynablox {
+
+/**
+ * @brief Tracks the ground truth dynamic objects over the evaluated frames and
+ * measures how long it takes until each object is detected at object level.
+ * Ground truth only labels points, so the evaluated ground truth dynamic
+ * points of a frame are grouped into objects by spatial connectivity and
+ * associated to the objects of the previous frames by their centroids.
+ * Frames are counted in ground truth frames, as annotations may not cover
+ * every scan.
+ */
+class DetectionLatency {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // If true, track the ground truth objects and write their latencies.
+    bool enable = false;
+
+    // Ground truth dynamic points in neighboring cells of this size are
+    // grouped into one object [m].
+    float object_separation = 0.5f;
+
+    // Groups with fewer points are ignored.
+    int min_object_points = 10;
+
+    // Maximum centroid motion of an object between two ground truth frames
+    // to associate it [m].
+    float max_association_distance = 1.f;
+
+    // Number of ground truth frames an object can be missed before its track
+    // ends.
+    int max_missed_frames = 2;
+
+    // Fraction of the points of an object that need to be object-level
+    // dynamic for the object to count as detected.
+    float min_detected_fraction = 0.5f;
+
+    Config() { setConfigName("DetectionLatency"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // Latency of a ground truth object.
+  struct Object {
+    int id = 0;
+    std::uint64_t first_timestamp = 0u;  // ns.
+    int first_frame = 0;                 // Index of the ground truth frame.
+    int num_frames = 0;                  // Number of frames observed in.
+    bool detected = false;
+    std::uint64_t detection_timestamp = 0u;  // ns.
+    int latency_frames = -1;
+    double latency_ms = -1.0;
+
+    // Processing time of the frame the object was detected in, from the start
+    // of its processing until the detection finished.
+    double processing_latency_ms = -1.0;
+  };
+
+  // Constructor.
+  explicit DetectionLatency(const Config& config);
+
+  bool isEnabled() const { return config_.enable; }
+
+  /**
+   * @brief Update the object tracks with an evaluated frame.
+   *
+   * @param cloud Point cloud in map frame.
+   * @param cloud_info Labeled cloud info, only points ready for evaluation are
+   * considered.
+   * @param processing_time Time it took to process the frame [s].
+   */
+  void addFrame(const Cloud& cloud, const CloudInfo& cloud_info,
+                double processing_time);
+
+  /**
+   * @brief End all tracks.
+   */
+  void finish();
+
+  // Objects whose tracks ended.
+  const std::vector<Object>& getObjects() const { return objects_; }
+
+  /**
+   * @brief Write the latency of each object to 'detection_latency.csv' and
+   * the distributions of the latencies of the detected objects to
+   * 'detection_latency_summary.csv'.
+   *
+   * @param directory Output directory.
+   * @return True if both files were written.
+   */
+  bool writeResults(const std::string& directory) const;
+
+ private:
+  // Ground truth object in the current frame.
+  struct Segment {
+    voxblox::Point centroid = voxblox::Point::Zero();
+    size_t num_points = 0u;
+    size_t num_detected = 0u;  // Object-level dynamic points.
+  };
+
+  // Object that is currently tracked.
+  struct Track {
+    Object object;
+    voxblox::Point centroid;
+    int last_frame;  // Last ground truth frame the object was observed in.
+  };
+
+  const Config config_;
+  std::vector<Track> tracks_;
+  std::vector<Object> objects_;
+  int frame_index_ = 0;
+  int next_id_ = 0;
+
+  // Helper functions.
+  std::vector<Segment> segmentObjects(const Cloud& cloud,
+                                      const CloudInfo& cloud_info) const;
+  void updateTrack(const Segment& segment, const CloudInfo& cloud_info,
+                   double processing_time, Track& track) const;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_EVALUATION_DETECTION_LATENCY_H_
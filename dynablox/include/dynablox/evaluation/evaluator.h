@@ -2,14 +2,22 @@
 #define DYNABLOX_EVALUATION_EVALUATOR_H_
 
 #include <chrono>
+#include <condition_variable>
 #include <ctime>
+#include <deque>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "dynablox/common/types.h"
+#include "dynablox/evaluation/cloud_file.h"
+#include "dynablox/evaluation/detection_latency.h"
 #include "dynablox/evaluation/ground_truth_handler.h"
+#include "dynablox/evaluation/label_planes.h"
 
 namespace dynablox {
 
@@ -30,15 +38,37 @@ class Evaluator {
     bool evaluate_cluster_level = true;
     bool evaluate_object_level = true;
 
+    // If set, additionally write the scores of each level per range bin to
+    // 'range_scores.csv'. Ascending bin edges [m], e.g. [0, 10, 20, 40].
+    std::vector<float> range_bins;
+
     // Save the data of all evaluated clouds. Off by default to save space.
     bool save_clouds = false;
 
+    // Format of the saved clouds: 'binary' writes the columnar cloud file
+    // 'clouds.bin', 'csv' the human readable 'clouds.csv'.
+    std::string cloud_format = "binary";
+
+    // If true compress the frames of the binary cloud file.
+    bool compress_clouds = false;
+
+    // If true compute the scores and write all files in a background thread,
+    // so evaluation does not add to the frame latency.
+    bool asynchronous = true;
+
+    // Maximum number of frames waiting to be written. The detection thread
+    // blocks if the writer falls this far behind.
+    int max_queue_size = 50;
+
     // If true store the parameters of all modules.
     bool save_config = true;
 
     // Config for the ground truth handler.
     GroundTruthHandler::Config ground_truth_config;
 
+    // Config of the detection latency of the ground truth objects.
+    DetectionLatency::Config detection_latency_config;
+
     Config() { setConfigName("Evaluator"); }
 
    protected:
@@ -49,6 +79,12 @@ class Evaluator {
   // Constructor.
   Evaluator(const Config& config_utilities);
 
+  // Writes all pending frames before returning.
+  ~Evaluator();
+
+  Evaluator(const Evaluator&) = delete;
+  Evaluator& operator=(const Evaluator&) = delete;
+
   // Evaluation helper methods.
   /**
    * @brief Create the output directory.
@@ -56,14 +92,18 @@ class Evaluator {
   void setupFiles();
 
   /**
-   * @brief If ground truth is available, lable the cloud, compute metrics, and
-   * write them to the output. Always update the timing infomation.
+   * @brief If ground truth is available, label the cloud and queue it to
+   * compute metrics and write them to the output. Always update the timing
+   * infomation. Labeling happens on the calling thread, so the labels can be
+   * visualized right away.
    *
    * @param cloud Point cloud to be evaluated.
    * @param cloud_info Cloud info to be evaluated.
+   * @param processing_time Time from the start of processing the frame until
+   * the detection finished [s], reported with the detection latency.
    */
   void evaluateFrame(const Cloud& cloud, CloudInfo& cloud_info,
-                     const Clusters& clusters);
+                     const Clusters& clusters, double processing_time = 0.0);
 
   /**
    * @brief Update the timing information by overwriting the output file with
@@ -73,11 +113,14 @@ class Evaluator {
 
   /**
    * @brief Compute the score for the labeled input cloud and write them to the
-   * output file.
+   * output.
    *
-   * @param cloud_info Labeled input pointcloud to be evaluated.
+   * @param cloud_info Labeled input pointcloud filtered for evaluation.
+   * @param output Stream to write the scores line to.
+   * @param range_output Stream to write the scores per range bin to.
    */
-  void writeScoresToFile(CloudInfo& cloud_info);
+  void writeScores(const CloudInfo& cloud_info, std::ostream& output,
+                   std::ostream& range_output) const;
 
   /**
    * @brief Save the coordinates and additional info of the evaluated cloud to
@@ -86,9 +129,10 @@ class Evaluator {
    * @param cloud Point cloud to be saved.
    * @param cloud_info Corresponding cloud info for evaluation.
    * @param clusters Current clustering to get cluster IDs.
+   * @param cloud_id ID of the cloud to be stored.
    */
   void saveCloud(const Cloud& cloud, const CloudInfo& cloud_info,
-                 const Clusters& clusters);
+                 const Clusters& clusters, int cloud_id);
 
   /**
    * @brief Store all parameters used by the motion detector.
@@ -104,16 +148,13 @@ class Evaluator {
   int filterEvaluatedPoints(CloudInfo& cloud_info) const;
 
   /**
-   * @brief Compute the scores for a specified level and write the results to
-   * the output file.
+   * @brief Write the scores of a level to the output.
    *
-   * @param cloud_info Labeled cloud to evaluate.
-   * @param level Level to evaluate [point, cluster, object]
-   * @param output_file Filestream to write results to.
+   * @param counts Confusion matrix of the level.
+   * @param output_file Stream to write results to.
    */
-  void evaluateCloudAtLevel(const CloudInfo& cloud_info,
-                            const std::string& level,
-                            std::ofstream& output_file) const;
+  static void writeMetrics(const ConfusionCounts& counts,
+                           std::ostream& output_file);
 
   // Computation of aggregated metrics.
   static float computePrecision(const uint tp, const uint fp);
@@ -124,23 +165,47 @@ class Evaluator {
   int getNumberOfEvaluatedFrames() const { return gt_frame_counter_; }
 
  private:
+  // Data of a labeled frame handed to the writer.
+  struct PendingFrame {
+    int cloud_id;
+    double processing_time;
+    Cloud cloud;  // Only copied if clouds are saved or for the latency.
+    CloudInfo cloud_info;
+    Clusters clusters;  // Only copied if clouds are saved.
+  };
+
   const Config config_;
-  const GroundTruthHandler ground_truth_handler;
+  GroundTruthHandler ground_truth_handler;
+  DetectionLatency detection_latency_;  // Only used by the writer.
 
   // Variables.
   std::string output_directory_;
-  std::vector<std::string> evaluated_levels_;
+  std::vector<LabelPlanes::Level> evaluated_levels_;
   int gt_frame_counter_ = 0;
   bool config_saved_ = false;
+  std::unique_ptr<CloudFileWriter> cloud_writer_;
+  std::ofstream scores_file_;
+  std::ofstream range_scores_file_;
+
+  // Background writer.
+  std::thread writer_thread_;
+  std::mutex queue_mutex_;
+  std::condition_variable queue_condition_;
+  std::deque<PendingFrame> queue_;
+  std::string pending_timings_;  // Latest timing statistics to write.
+  bool stopped_ = false;
 
   // Helper Functions.
-  static std::function<bool(const PointInfo&)> getCheckLevelFunction(
-      const std::string& level);
+  void writerLoop();
+  void writeFrames(std::deque<PendingFrame>& frames);
+  void writeTimings(const std::string& timings) const;
 
   // Names of the created files.
   static const std::string config_file_name_;
   static const std::string clouds_file_name_;
+  static const std::string binary_clouds_file_name_;
   static const std::string scores_file_name_;
+  static const std::string range_scores_file_name_;
   static const std::string timings_file_name_;
 };
 
@@ -1,13 +1,19 @@
 #ifndef DYNABLOX_EVALUATION_GROUND_TRUTH_HANDLER_H_
 #define DYNABLOX_EVALUATION_GROUND_TRUTH_HANDLER_H_
 
+#include <string>
+#include <vector>
+
 #include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/mapped_file.h"
 #include "dynablox/common/types.h"
 
 namespace dynablox {
 
 // This ground-truth handler manages the data available in the DOALS
-// (https://projects.asl.ethz.ch/datasets/doku.php?id=doals) dataset.
+// (https://projects.asl.ethz.ch/datasets/doku.php?id=doals) dataset. The
+// indices file is memory mapped and only indexed by timestamp at startup, the
+// dynamic point indices of a frame are parsed when it is labeled.
 class GroundTruthHandler {
  public:
   // Config.
@@ -15,6 +21,13 @@ class GroundTruthHandler {
     // Where to read the ground truth data.
     std::string file_path;
 
+    // Maximum difference between the cloud and the ground truth timestamp to
+    // still match them [ns]. 0 requires exact matches. A cloud is matched to
+    // the closest entry, and each entry labels only the first cloud matched
+    // to it. Keep this below half the cloud period, otherwise an unannotated
+    // cloud preceding the annotated one can take its labels.
+    int timestamp_tolerance = 0;
+
     Config() { setConfigName("GroundTruthHandler"); }
 
    protected:
@@ -22,29 +35,43 @@ class GroundTruthHandler {
     void checkParams() const override;
   };
 
-  using TimestampVectorMap = std::map<std::uint64_t, std::vector<int>>;
-
   explicit GroundTruthHandler(const Config& config);
 
   /**
-   * @brief Read the DOALS indices.csv file into a map.
-   *
+   * @brief Find the timestamp and position of all lines in the DOALS
+   * indices.csv file.
    */
-  void createLookupFromCSV();
+  void indexFile();
 
   /**
    * @brief Check whether there exist annotations for the given time stamp and
    * label the cloud info if available.
    *
    * @param cloud_info Cloud info to annotate. Will use the time stamp in the
-   * cloud for matching.
+   * cloud for matching. Entries already used to label a cloud with a
+   * different time stamp are not matched again.
    * @return Whether ground truth data was found.
    */
-  bool labelCloudInfoIfAvailable(CloudInfo& cloud_info) const;
+  bool labelCloudInfoIfAvailable(CloudInfo& cloud_info);
+
+  size_t getNumberOfEntries() const { return entries_.size(); }
 
  private:
+  // Ground truth line of a timestamp in the mapped file.
+  struct Entry {
+    std::uint64_t timestamp;
+    size_t begin;  // First index of the line.
+    size_t end;    // End of the line.
+    bool consumed = false;
+    std::uint64_t cloud_timestamp = 0u;  // Cloud labeled if consumed.
+  };
+
   const Config config_;
-  TimestampVectorMap ground_truth_lookup_;
+  const MappedFile file_;
+  std::vector<Entry> entries_;  // Sorted by timestamp.
+
+  // Find the closest entry within the tolerance.
+  Entry* findEntry(std::uint64_t timestamp);
 };
 
 }  // namespace dynablox
@@ -10,6 +10,18 @@
 
 namespace dynablox {
 
+/**
+ * @brief Look up the cluster id of every point in a single pass over the
+ * clusters. Points that are not part of a cluster get id -1, points in multiple
+ * clusters get the id of the first one.
+ *
+ * @param num_points Number of points in the cloud.
+ * @param clusters Clusters referencing the points.
+ * @return The cluster id of each point.
+ */
+std::vector<int> computePointClusterIds(size_t num_points,
+                                        const Clusters& clusters);
+
 /**
  * @brief Save a cloud to a human readable csv file. Repeated calls of this
  * function will append clouds to the same file.
@@ -28,7 +40,7 @@ bool saveCloudToCsv(const std::string& file_name, const Cloud& cloud,
 
 /**
  * @brief Read all clouds from a given csv file. Each cloud will have a separate
- * entry in the vector.
+ * entry in the vector. Clouds are parsed in parallel by the MappedCloudReader.
  *
  * @param file_name Full path of input file with extension.
  * @param clouds Where to store read clouds.
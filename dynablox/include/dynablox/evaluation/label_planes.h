@@ -0,0 +1,69 @@
+#ifndef DYNABLOX_EVALUATION_LABEL_PLANES_H_
+#define DYNABLOX_EVALUATION_LABEL_PLANES_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dynablox/common/types.h"
+
+namespace dynablox {
+
+// Confusion matrix of the dynamic labels of a detection level.
+struct ConfusionCounts {
+  uint tp = 0u;
+  uint fp = 0u;
+  uint tn = 0u;
+  uint fn = 0u;
+};
+
+/**
+ * @brief The labels of a frame packed into bit planes with one bit per point,
+ * so the confusion matrices of all levels and range bins are computed with
+ * popcounts over 64 points at a time in a single pass.
+ */
+class LabelPlanes {
+ public:
+  // Evaluated detection levels.
+  enum Level : int { kPoint = 0, kCluster, kObject, kNumLevels };
+
+  using LevelCounts = std::array<ConfusionCounts, kNumLevels>;
+
+  // Counts of all levels, for all evaluated points and per range bin.
+  struct Counts {
+    LevelCounts total;
+    std::vector<LevelCounts> bins;
+  };
+
+  /**
+   * @brief Pack the labels of a frame.
+   *
+   * @param cloud_info Labeled cloud info, only points ready for evaluation are
+   * counted.
+   * @param range_bin_edges Ascending edges of the range bins [m]. Bin i
+   * contains the points with distance in [edges[i], edges[i+1]).
+   */
+  explicit LabelPlanes(const CloudInfo& cloud_info,
+                       const std::vector<float>& range_bin_edges = {});
+
+  Counts count() const;
+
+  size_t getNumberOfEvaluatedPoints() const { return num_evaluated_points_; }
+  size_t getNumberOfBins() const { return bins_.size(); }
+
+  static std::string levelToString(Level level);
+
+ private:
+  using Plane = std::vector<std::uint64_t>;
+
+  size_t num_evaluated_points_ = 0u;
+  std::array<Plane, kNumLevels> predicted_;
+  Plane ground_truth_;
+  Plane evaluated_;
+  std::vector<Plane> bins_;  // Evaluated points in each range bin.
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_EVALUATION_LABEL_PLANES_H_
@@ -0,0 +1,84 @@
+#ifndef DYNABLOX_EVALUATION_MAPPED_CLOUD_READER_H_
+#define DYNABLOX_EVALUATION_MAPPED_CLOUD_READER_H_
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dynablox/common/mapped_file.h"
+#include "dynablox/common/types.h"
+#include "dynablox/evaluation/cloud_file.h"
+
+namespace dynablox {
+
+/**
+ * @brief Read-only access to saved evaluation clouds through a memory mapping
+ * of the file. Both the binary cloud file and the csv format of
+ * saveCloudToCsv() are supported. Opening the file only finds the frame
+ * boundaries, frames are parsed on demand and can be read concurrently.
+ */
+class MappedCloudReader {
+ public:
+  /**
+   * @brief Map the file and index its frames.
+   *
+   * @param file_name Full path of a binary cloud file or a csv file.
+   */
+  explicit MappedCloudReader(const std::string& file_name);
+
+  bool isOpen() const { return file_.isOpen(); }
+  bool isBinary() const { return is_binary_; }
+  size_t getNumberOfFrames() const { return frames_.size(); }
+
+  // ID of the cloud as stored in the file.
+  int getCloudId(size_t index) const { return frames_[index].cloud_id; }
+
+  /**
+   * @brief Parse a single frame. Thread safe.
+   *
+   * @param index Index of the frame in the file.
+   * @param cloud Where to store the points.
+   * @param cloud_info Where to store the labels and distances.
+   * @param clusters Where to store the clusters of cluster-dynamic points.
+   * @return True if the frame was parsed.
+   */
+  bool readFrame(size_t index, Cloud& cloud, CloudInfo& cloud_info,
+                 Clusters& clusters) const;
+
+  /**
+   * @brief Parse all frames in parallel. Each frame gets a separate entry
+   * appended to the output vectors.
+   *
+   * @param num_threads Number of frames parsed in parallel.
+   * @return True if all frames were parsed.
+   */
+  bool readAllFrames(
+      std::vector<Cloud>& clouds, std::vector<CloudInfo>& cloud_infos,
+      std::vector<Clusters>& clusters,
+      int num_threads = std::thread::hardware_concurrency()) const;
+
+ private:
+  // Byte range of a frame in the mapped file.
+  struct Frame {
+    int cloud_id = 0;
+    size_t begin = 0u;  // Payload for binary, first line for csv files.
+    size_t end = 0u;
+    size_t num_points = 0u;
+    cloud_file::ChunkHeader header;  // Binary files only.
+  };
+
+  const MappedFile file_;
+  const char* data_ = nullptr;
+  size_t mapped_size_ = 0u;
+  bool is_binary_ = false;
+  std::vector<Frame> frames_;
+
+  void indexBinaryFrames(const std::string& file_name);
+  void indexCsvFrames();
+  bool parseCsvFrame(const Frame& frame, Cloud& cloud, CloudInfo& cloud_info,
+                     Clusters& clusters) const;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_EVALUATION_MAPPED_CLOUD_READER_H_
@@ -0,0 +1,141 @@
+#ifndef DYNABLOX_EVALUATION_PARAMETER_SWEEP_H_
+#define DYNABLOX_EVALUATION_PARAMETER_SWEEP_H_
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tf/transform_datatypes.h>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/command_line_config.h"
+#include "dynablox/common/types.h"
+#include "dynablox/evaluation/label_planes.h"
+#include "dynablox/processing/detection_pipeline.h"
+
+namespace dynablox {
+
+// A recorded sequence of preprocessed scans, loaded once and shared read-only
+// by all runs of a sweep.
+struct SweepSequence {
+  std::vector<tf::Transform> poses;    // Pose of the sensor in the map.
+  std::vector<Cloud> clouds;           // Preprocessed scans in map frame.
+  std::vector<CloudInfo> cloud_infos;  // Ground truth labels if available.
+
+  size_t size() const { return clouds.size(); }
+};
+
+/**
+ * @brief Offline grid search over the detection parameters. The sequence is
+ * loaded once and every parameter combination runs in its own
+ * DetectionPipeline, with many runs processed in parallel. Each run writes
+ * its scores in the format of the Evaluator, and a summary of all runs is
+ * written to 'sweep.csv'.
+ */
+class ParameterSweep {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Directory with the sequence, containing 'clouds.bin' or 'clouds.csv'
+    // and 'poses.csv' as written by generate_synthetic_scene.
+    std::string sequence_directory;
+
+    // Where to write the results, one sub-directory per run.
+    std::string output_directory;
+
+    // Number of runs processed in parallel. Each run holds its own map.
+    int num_parallel_runs = std::thread::hardware_concurrency();
+
+    // Number of threads of the pipeline of each run.
+    int threads_per_run = 1;
+
+    // Only process the first frames of the sequence if > 0.
+    int max_frames = 0;
+
+    // Range limitations of the evaluated points [m].
+    float min_range = 0.f;
+    float max_range = 1e6;
+
+    Config() { setConfigName("ParameterSweep"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // A swept parameter, e.g. '/clustering/min_cluster_size', and its values.
+  struct Axis {
+    std::string name;
+    std::vector<std::string> values;
+  };
+
+  /**
+   * @brief Set up the runs of the full grid over all axes. Configs are created
+   * here, as config_utilities does not support creating them concurrently.
+   *
+   * @param config Config of the sweep.
+   * @param base_params Parameters of the DetectionPipeline shared by all runs.
+   * @param axes Swept parameters, overwriting the base parameters.
+   */
+  ParameterSweep(const Config& config, const ParamMap& base_params,
+                 const std::vector<Axis>& axes);
+
+  ParameterSweep(const ParameterSweep&) = delete;
+  ParameterSweep& operator=(const ParameterSweep&) = delete;
+
+  /**
+   * @brief Load the sequence and process all runs.
+   *
+   * @return True if all runs were processed and written.
+   */
+  bool run();
+
+  size_t getNumberOfRuns() const { return runs_.size(); }
+
+  /**
+   * @brief Load a sequence directory. Scans are matched to the poses by
+   * timestamp, or by order if the scans have no timestamps.
+   *
+   * @param directory Directory with the clouds and poses.
+   * @param max_frames Only load the first frames if > 0.
+   * @param num_threads Number of frames parsed in parallel.
+   * @param sequence Where to store the sequence.
+   * @return True if the sequence was loaded.
+   */
+  static bool loadSequence(const std::string& directory, int max_frames,
+                           int num_threads, SweepSequence& sequence);
+
+  /**
+   * @brief Split a comma separated list of values.
+   */
+  static std::vector<std::string> splitValues(const std::string& values);
+
+ private:
+  // A parameter combination and its results.
+  struct Run {
+    std::vector<std::string> values;  // Value of each axis.
+    DetectionPipeline::Config config;
+    LabelPlanes::LevelCounts counts;  // Summed over all evaluated frames.
+    int num_evaluated_frames = 0;
+    double processing_time = 0.0;  // s, of all frames.
+    bool success = false;
+  };
+
+  const Config config_;
+  const std::vector<Axis> axes_;
+  std::vector<Run> runs_;
+  SweepSequence sequence_;
+
+  // Guards creating and destroying configs in the worker threads.
+  std::mutex config_mutex_;
+
+  // Helper functions.
+  void processRun(size_t index);
+  std::string getRunDirectory(size_t index) const;
+  bool writeSummary() const;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_EVALUATION_PARAMETER_SWEEP_H_
@@ -0,0 +1,118 @@
+#ifndef DYNABLOX_EVALUATION_PERFORMANCE_GATE_H_
+#define DYNABLOX_EVALUATION_PERFORMANCE_GATE_H_
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/processing/detection_pipeline.h"
+#include "dynablox/simulation/scene_generator.h"
+
+namespace dynablox {
+
+/**
+ * @brief Performance regression check of the detection. Runs a fixed
+ * workload, either a synthetic scene or a recorded sequence, records the
+ * timing statistics of all stages, and compares them against a baseline
+ * written by a previous run on the same machine. Results are stored as JSON
+ * with a fixed schema and one stage per line, so baselines can be committed
+ * and diffed.
+ */
+class PerformanceGate {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Baseline to compare against.
+    std::string baseline_file;
+
+    // If set, also write the statistics of this run here.
+    std::string output_file;
+
+    // If true, overwrite the baseline with this run instead of comparing.
+    bool update_baseline = false;
+
+    // Recorded sequence to process as in the ParameterSweep. If empty, the
+    // synthetic scene is generated.
+    std::string sequence_directory;
+
+    // Only process the first frames of a recorded sequence if > 0.
+    int max_frames = 0;
+
+    // Frames processed before recording the timings.
+    int warmup_frames = 5;
+
+    // Statistic compared against the baseline: 'mean', 'p50', or 'p95'.
+    std::string compared_statistic = "mean";
+
+    // A stage regressed if it is slower than the baseline by more than this
+    // fraction and more than min_difference_ms. Stages of the baseline can
+    // overwrite the fraction with a 'tolerance' entry.
+    float tolerance = 0.25f;
+    float min_difference_ms = 0.5f;
+
+    // Workload.
+    SceneGenerator::Config scene_config;
+    DetectionPipeline::Config pipeline_config;
+
+    // Sets a smaller scene and a single threaded pipeline.
+    Config();
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // Timing statistics of a stage [ms].
+  struct StageStatistics {
+    uint64_t count = 0u;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+    double tolerance = -1.0;  // Baseline only, < 0 to use the default.
+  };
+  using Statistics = std::map<std::string, StageStatistics>;
+
+  // Constructor.
+  explicit PerformanceGate(const Config& config);
+
+  /**
+   * @brief Run the workload and check or update the baseline.
+   *
+   * @return 0 if no stage regressed, 1 on regressions or stages of the
+   * baseline missing in this run, 2 on errors.
+   */
+  int run();
+
+  /**
+   * @brief Process the workload and collect the statistics of all stages.
+   *
+   * @return False if the workload could not be set up.
+   */
+  bool runWorkload(Statistics& statistics) const;
+
+  /**
+   * @brief Compare the statistics against the baseline and print a report.
+   *
+   * @return True if no stage regressed and all stages of the baseline ran.
+   */
+  bool compare(const Statistics& baseline, const Statistics& current,
+               std::ostream& report) const;
+
+  // Serialization.
+  static void writeJson(const Statistics& statistics, std::ostream& output);
+  static bool readJson(std::istream& input, Statistics& statistics);
+
+ private:
+  const Config config_;
+
+  double getComparedValue(const StageStatistics& statistics) const;
+  bool writeStatistics(const Statistics& statistics,
+                       const std::string& file_name) const;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_EVALUATION_PERFORMANCE_GATE_H_
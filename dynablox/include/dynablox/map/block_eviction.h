@@ -0,0 +1,119 @@
+#ifndef DYNABLOX_MAP_BLOCK_EVICTION_H_
+#define DYNABLOX_MAP_BLOCK_EVICTION_H_
+
+#include <deque>
+#include <memory>
+
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/types.h"
+#include "dynablox/map/block_store.h"
+#include "dynablox/map/ever_free_layer.h"
+
+namespace dynablox {
+
+/**
+ * @brief Keeps the map bounded by removing TSDF and ever-free blocks that are
+ * far from the sensor or were not observed for a long time. Candidates are
+ * collected periodically and removed incrementally with a per-frame budget.
+ * Optionally, evicted blocks are spilled to disk and reloaded when revisited.
+ */
+class BlockEviction {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Blocks whose center is further than this from the sensor are evicted.
+    // Set to 0 to disable distance-based eviction [m].
+    float eviction_radius = 0.f;
+
+    // Blocks not observed for more than this many frames are evicted. Set to 0
+    // to disable age-based eviction [frames].
+    int max_unobserved_frames = 0;
+
+    // Maximum number of blocks evicted per frame to bound the processing time.
+    int max_evictions_per_frame = 100;
+
+    // Search for new eviction candidates every n frames [frames].
+    int check_every_n_frames = 10;
+
+    // Evicted blocks are spilled to this store if a file path is set.
+    BlockStore::Config block_store_config;
+
+    Config() { setConfigName("BlockEviction"); }
+
+    // Whether any eviction criterion is active.
+    bool isEnabled() const {
+      return eviction_radius > 0.f || max_unobserved_frames > 0;
+    }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // Constructor.
+  BlockEviction(const Config& config, TsdfLayer::Ptr tsdf_layer,
+                EverFreeLayer::Ptr ever_free_layer);
+
+  /**
+   * @brief Evict up to max_evictions_per_frame blocks that meet the eviction
+   * criteria. Needs to be called when no other component accesses the map.
+   *
+   * @param sensor_position Current position of the sensor in map frame.
+   * @param frame_counter Index of the current lidar scan.
+   * @return Indices of all blocks that were removed.
+   */
+  voxblox::BlockIndexList evictBlocks(const Point& sensor_position,
+                                      const int frame_counter);
+
+  /**
+   * @brief Reload previously evicted blocks near the sensor from the block
+   * store. Needs to be called when no other component accesses the map.
+   *
+   * @param sensor_position Current position of the sensor in map frame.
+   * @return Indices of all blocks that were loaded.
+   */
+  voxblox::BlockIndexList reloadBlocks(const Point& sensor_position);
+
+  /**
+   * @brief Check whether a block meets any of the eviction criteria.
+   *
+   * @param block_index Index of the block to check.
+   * @param sensor_position Current position of the sensor in map frame.
+   * @param frame_counter Index of the current lidar scan.
+   * @return True if the block should be evicted.
+   */
+  bool shouldEvict(const BlockIndex& block_index, const Point& sensor_position,
+                   const int frame_counter) const;
+
+  // Number of blocks currently scheduled for eviction.
+  size_t getNumberOfCandidates() const { return candidates_.size(); }
+
+ private:
+  const Config config_;
+  const TsdfLayer::Ptr tsdf_layer_;
+  const EverFreeLayer::Ptr ever_free_layer_;
+  std::unique_ptr<BlockStore> block_store_;
+
+  // Cached frequently used values.
+  const float block_size_;
+  const float eviction_radius_squared_;
+
+  // Blocks scheduled for eviction.
+  std::deque<BlockIndex> candidates_;
+  int last_check_frame_ = 0;
+
+  /**
+   * @brief Collect all blocks that meet the eviction criteria.
+   *
+   * @param sensor_position Current position of the sensor in map frame.
+   * @param frame_counter Index of the current lidar scan.
+   */
+  void findCandidates(const Point& sensor_position, const int frame_counter);
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_MAP_BLOCK_EVICTION_H_
@@ -0,0 +1,129 @@
+#ifndef DYNABLOX_MAP_BLOCK_STORE_H_
+#define DYNABLOX_MAP_BLOCK_STORE_H_
+
+#include <fstream>
+#include <map>
+#include <string>
+
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/types.h"
+#include "dynablox/map/ever_free_layer.h"
+
+namespace dynablox {
+
+/**
+ * @brief On-disk store for TSDF and ever-free blocks that were removed from the
+ * map. Blocks are indexed in memory by their block index and paged back in when
+ * the sensor approaches them again. Storing a block again overwrites its
+ * previous record if it fits, otherwise the record is written to a free slot or
+ * appended and the old slot is freed. Records of a block have the same size
+ * unless its ever-free block was missing, so the file is bounded by the number
+ * of distinct blocks ever stored, i.e. by the explored volume, and is not
+ * compacted.
+ */
+class BlockStore {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // File to spill evicted blocks to. Leave empty to disable the store. The
+    // file is overwritten on startup.
+    std::string file_path = "";
+
+    // Stored blocks whose center is within this distance of the sensor are
+    // reloaded. Must be smaller than the eviction radius and at least the
+    // max_allocation_distance [m].
+    float reload_radius = 30.f;
+
+    // Distance from the sensor within which the integration can allocate
+    // blocks, plus the motion of the sensor between reloads. Blocks allocated
+    // before their stored record is reloaded would shadow it. Set by the
+    // motion detector from the TSDF integrator config [m].
+    float max_allocation_distance = 0.f;
+
+    Config() { setConfigName("BlockStore"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // Constructor.
+  BlockStore(const Config& config, TsdfLayer::Ptr tsdf_layer,
+             EverFreeLayer::Ptr ever_free_layer);
+
+  /**
+   * @brief Write the TSDF and ever-free block at the given index to disk. The
+   * blocks are not removed from the map.
+   *
+   * @param block_index Index of the block to store.
+   * @return True if the block was written.
+   */
+  bool storeBlock(const BlockIndex& block_index);
+
+  /**
+   * @brief Read a stored block and insert it into the TSDF and ever-free
+   * layers, overwriting blocks that may already exist.
+   *
+   * @param block_index Index of the block to load.
+   * @return True if the block was loaded.
+   */
+  bool loadBlock(const BlockIndex& block_index);
+
+  /**
+   * @brief Load all stored blocks near the sensor that are not in the map.
+   * Only searches when the sensor entered a new block. Needs to be called
+   * before integrating a scan, so stored blocks are in the map before the
+   * integration allocates them.
+   *
+   * @param sensor_position Current position of the sensor in map frame.
+   * @return Indices of all blocks that were loaded.
+   */
+  voxblox::BlockIndexList reloadBlocks(const Point& sensor_position);
+
+  // Information.
+  bool hasBlock(const BlockIndex& block_index) const {
+    return index_.count(block_index);
+  }
+  size_t getNumberOfStoredBlocks() const { return index_.size(); }
+  float getReloadRadius() const { return config_.reload_radius; }
+
+ private:
+  const Config config_;
+  const TsdfLayer::Ptr tsdf_layer_;
+  const EverFreeLayer::Ptr ever_free_layer_;
+
+  // Cached frequently used values.
+  const float block_size_;
+
+  // Slot of the file holding a record.
+  struct Slot {
+    std::streamoff offset;
+    size_t capacity;  // Bytes.
+  };
+
+  // Store file, slot of the most recent record of each block, and slots
+  // that no longer hold a record by capacity.
+  std::fstream file_;
+  voxblox::AnyIndexHashMapType<Slot>::type index_;
+  std::multimap<size_t, std::streamoff> free_slots_;
+  std::streamoff file_end_ = 0;
+
+  // Block of the sensor at the last reload.
+  BlockIndex last_sensor_block_;
+  bool has_last_sensor_block_ = false;
+
+  // Header preceding each block record in the file.
+  struct RecordHeader {
+    int32_t index[3];
+    uint32_t num_tsdf_words;
+    uint32_t num_ever_free_bytes;
+  };
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_MAP_BLOCK_STORE_H_
@@ -0,0 +1,231 @@
+#ifndef DYNABLOX_MAP_EVER_FREE_LAYER_H_
+#define DYNABLOX_MAP_EVER_FREE_LAYER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/common.h>
+
+#include "dynablox/common/types.h"
+
+namespace dynablox {
+
+/**
+ * @brief Ever-free state of all voxels of a block. The state is stored as a
+ * structure of arrays next to the TSDF block with the same index, so the
+ * ever-free passes only touch the few bytes they need per voxel.
+ */
+class EverFreeBlock {
+ public:
+  using Ptr = std::shared_ptr<EverFreeBlock>;
+  using ConstPtr = std::shared_ptr<const EverFreeBlock>;
+
+  // Voxel state flags, packed into one byte per voxel. Flags of different
+  // voxels never share a byte so blocks can be processed in parallel. Flags
+  // are only accessed by the thread processing their block, the observed
+  // state that is read across blocks is stored separately.
+  enum Flag : uint8_t {
+    kEverFree = 1u << 0,
+    kDynamic = 1u << 1,
+    kClusteringProcessed = 1u << 2,
+    kNewlyObserved = 1u << 4,  // Observed for the first time this frame.
+    kBurnIn = 1u << 5,         // Occupied and waiting for the burn-in period.
+    kDirty = 1u << 6,          // Contained in the dirty voxel list.
+  };
+
+  // Frame stamps are stored as 16 bit offsets to a per-block frame origin.
+  using Stamp = uint16_t;
+  static constexpr int kMaxStamp = std::numeric_limits<Stamp>::max();
+
+  // Occupancy counters saturate at this value.
+  static constexpr int kMaxOccupancyCounter =
+      std::numeric_limits<uint8_t>::max();
+
+  explicit EverFreeBlock(size_t voxels_per_side);
+
+  // Indexing, equivalent to voxblox::Block.
+  size_t voxels_per_side() const { return voxels_per_side_; }
+  size_t num_voxels() const { return num_voxels_; }
+  size_t computeLinearIndexFromVoxelIndex(const VoxelIndex& index) const {
+    return index.x() +
+           voxels_per_side_ * (index.y() + index.z() * voxels_per_side_);
+  }
+  VoxelIndex computeVoxelIndexFromLinearIndex(const size_t linear_index) const {
+    const int index = static_cast<int>(linear_index);
+    const int voxels_per_side = static_cast<int>(voxels_per_side_);
+    return VoxelIndex(index % voxels_per_side,
+                      (index / voxels_per_side) % voxels_per_side,
+                      index / (voxels_per_side * voxels_per_side));
+  }
+
+  // Flags.
+  bool hasFlag(const size_t linear_index, const uint8_t flag) const {
+    return flags_[linear_index] & flag;
+  }
+  void setFlag(const size_t linear_index, const uint8_t flag) {
+    flags_[linear_index] |= flag;
+  }
+  void clearFlag(const size_t linear_index, const uint8_t flag) {
+    flags_[linear_index] &= static_cast<uint8_t>(~flag);
+  }
+
+  // Whether the voxel has a TSDF weight. Read by the ever-free checks of
+  // neighboring blocks, so it does not share a byte with the flags.
+  bool isObserved(const size_t linear_index) const {
+    return observed_[linear_index];
+  }
+  void setObserved(const size_t linear_index) { observed_[linear_index] = 1u; }
+
+  // Frame stamps.
+  int getLastOccupied(const size_t linear_index) const {
+    return frame_origin_ + last_occupied_[linear_index];
+  }
+  void setLastOccupied(const size_t linear_index, const int frame) {
+    last_occupied_[linear_index] = toStamp(frame);
+  }
+  int getLastLidarOccupied(const size_t linear_index) const {
+    return frame_origin_ + last_lidar_occupied_[linear_index];
+  }
+  void setLastLidarOccupied(const size_t linear_index, const int frame) {
+    last_lidar_occupied_[linear_index] = toStamp(frame);
+  }
+
+  // Occupancy counter.
+  int getOccupancyCounter(const size_t linear_index) const {
+    return occupancy_counter_[linear_index];
+  }
+  void setOccupancyCounter(const size_t linear_index, const int value);
+  void incrementOccupancyCounter(const size_t linear_index) {
+    if (occupancy_counter_[linear_index] < kMaxOccupancyCounter) {
+      occupancy_counter_[linear_index]++;
+    }
+  }
+
+  /**
+   * @brief Add a voxel to the list of voxels whose ever-free state needs to be
+   * checked. Each voxel is added at most once.
+   *
+   * @param linear_index Linear index of the voxel.
+   */
+  void markDirty(const size_t linear_index) {
+    if (!hasFlag(linear_index, kDirty)) {
+      setFlag(linear_index, kDirty);
+      dirty_voxels_.push_back(static_cast<uint32_t>(linear_index));
+    }
+  }
+
+  // Linear indices of all dirty voxels.
+  const std::vector<uint32_t>& getDirtyVoxels() const { return dirty_voxels_; }
+
+  // Remove and return all dirty voxels.
+  std::vector<uint32_t> takeDirtyVoxels();
+
+  // Voxels whose TSDF distance is below the occupancy threshold, maintained by
+  // the EverFreeTsdfIntegrator so it does not need to scan the whole block.
+  // The list is transient and invalid until built from the TSDF block.
+  std::vector<uint32_t>& getTsdfOccupiedVoxels() {
+    return tsdf_occupied_voxels_;
+  }
+  bool hasTsdfOccupiedVoxels() const { return tsdf_occupied_voxels_valid_; }
+  void setTsdfOccupiedVoxelsValid() { tsdf_occupied_voxels_valid_ = true; }
+
+  // Last frame in which the block was observed by the sensor.
+  int getLastObserved() const { return last_observed_; }
+  void setLastObserved(const int frame) { last_observed_ = frame; }
+
+  /**
+   * @brief Serialize the persistent state of the block. The dirty and TSDF
+   * occupied voxel lists are transient and not stored.
+   *
+   * @param data Where to store the serialized block.
+   */
+  void serializeToBytes(std::vector<uint8_t>* data) const;
+
+  /**
+   * @brief Restore the state of the block. Voxels that are still in their
+   * burn-in period are marked dirty again.
+   *
+   * @param data Serialized block as written by serializeToBytes().
+   * @return True if the data matches the block size.
+   */
+  bool deserializeFromBytes(const std::vector<uint8_t>& data);
+
+  // Memory used by this block in bytes.
+  size_t getMemorySize() const;
+
+ private:
+  const size_t voxels_per_side_;
+  const size_t num_voxels_;
+
+  // All stamps are relative to this frame.
+  int frame_origin_ = 0;
+  int last_observed_ = 0;
+
+  // Data.
+  std::vector<uint8_t> flags_;
+  std::vector<uint8_t> observed_;
+  std::vector<uint8_t> occupancy_counter_;
+  std::vector<Stamp> last_occupied_;
+  std::vector<Stamp> last_lidar_occupied_;
+  std::vector<uint32_t> dirty_voxels_;
+  std::vector<uint32_t> tsdf_occupied_voxels_;
+  bool tsdf_occupied_voxels_valid_ = false;
+
+  // Convert a frame to a stamp, shifting the frame origin if necessary.
+  Stamp toStamp(const int frame) {
+    if (frame - frame_origin_ > kMaxStamp) {
+      shiftFrameOrigin(frame);
+    }
+    return static_cast<Stamp>(std::max(frame - frame_origin_, 0));
+  }
+
+  /**
+   * @brief Move the frame origin such that 'frame' can be represented. Stamps
+   * that would fall before the new origin are clamped to it, which keeps them
+   * far older than any age the ever-free logic compares against.
+   *
+   * @param frame Newest frame to be stored.
+   */
+  void shiftFrameOrigin(const int frame);
+};
+
+/**
+ * @brief Map of ever-free blocks, parallel to the TSDF layer. Blocks use the
+ * same indices and voxels per side as the TSDF layer.
+ */
+class EverFreeLayer {
+ public:
+  using Ptr = std::shared_ptr<EverFreeLayer>;
+  using BlockMap = voxblox::AnyIndexHashMapType<EverFreeBlock::Ptr>::type;
+
+  explicit EverFreeLayer(size_t voxels_per_side);
+
+  // Block access. Return nullptr if the block does not exist.
+  EverFreeBlock::Ptr getBlockPtrByIndex(const BlockIndex& index);
+  EverFreeBlock::ConstPtr getBlockPtrByIndex(const BlockIndex& index) const;
+
+  // Get the block if it exists or create a new one. Not thread safe.
+  EverFreeBlock::Ptr allocateBlockPtrByIndex(const BlockIndex& index);
+
+  // Removal. Not thread safe.
+  void removeBlock(const BlockIndex& index);
+  void removeAllBlocks();
+
+  // Information.
+  void getAllAllocatedBlocks(voxblox::BlockIndexList* blocks) const;
+  size_t getNumberOfAllocatedBlocks() const { return block_map_.size(); }
+  size_t voxels_per_side() const { return voxels_per_side_; }
+  size_t getMemorySize() const;
+
+ private:
+  const size_t voxels_per_side_;
+  BlockMap block_map_;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_MAP_EVER_FREE_LAYER_H_
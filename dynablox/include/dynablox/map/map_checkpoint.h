@@ -0,0 +1,45 @@
+#ifndef DYNABLOX_MAP_MAP_CHECKPOINT_H_
+#define DYNABLOX_MAP_MAP_CHECKPOINT_H_
+
+#include <string>
+
+#include "dynablox/common/types.h"
+#include "dynablox/map/ever_free_layer.h"
+
+namespace dynablox {
+
+/**
+ * @brief Save the TSDF and ever-free layers to a block-indexed binary file. The
+ * file starts with a header and a table of block indices and record offsets,
+ * followed by the block records, so it can be memory mapped for loading.
+ *
+ * @param file_name Full path of the output file.
+ * @param tsdf_layer TSDF layer to save.
+ * @param ever_free_layer Ever-free layer to save.
+ * @param frame_counter Current frame, which all ever-free stamps refer to.
+ * @return True if the save operation was successful.
+ */
+bool saveMapCheckpoint(const std::string& file_name,
+                       const TsdfLayer& tsdf_layer,
+                       const EverFreeLayer& ever_free_layer,
+                       const int frame_counter);
+
+/**
+ * @brief Load a checkpoint written by saveMapCheckpoint() into empty layers.
+ * The layers must have the same voxel size and voxels per side as the saved
+ * map.
+ *
+ * @param file_name Full path of the input file.
+ * @param tsdf_layer TSDF layer to load the blocks into.
+ * @param ever_free_layer Ever-free layer to load the blocks into.
+ * @param frame_counter Where to store the frame the map was saved at.
+ * @param num_threads Number of threads used to deserialize the blocks.
+ * @return True if the load operation was successful.
+ */
+bool loadMapCheckpoint(const std::string& file_name, TsdfLayer& tsdf_layer,
+                       EverFreeLayer& ever_free_layer, int& frame_counter,
+                       const int num_threads = 1);
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_MAP_MAP_CHECKPOINT_H_
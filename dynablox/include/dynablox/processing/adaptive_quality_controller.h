@@ -0,0 +1,129 @@
+#ifndef DYNABLOX_PROCESSING_ADAPTIVE_QUALITY_CONTROLLER_H_
+#define DYNABLOX_PROCESSING_ADAPTIVE_QUALITY_CONTROLLER_H_
+
+#include <string>
+#include <vector>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/types.h"
+
+namespace dynablox {
+
+/**
+ * @brief Monitors the voxblox timer scopes of every frame and trades quality
+ * for speed when frames exceed their time budget. Degradation levels are
+ * cumulative, every level includes all previous ones.
+ */
+class AdaptiveQualityController {
+ public:
+  // Degradation levels, ordered by their impact on the detection quality.
+  enum Level {
+    kFullQuality = 0,
+    kSkipVisualization = 1,
+    kApproximateSeparation = 2,
+    kDecimatePoints = 3,
+    kReduceRange = 4
+  };
+
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Time budget per frame [s]. Set to 0 to disable adaptive quality control.
+    float frame_budget = 0.f;
+
+    // Timer scope measuring the full frame.
+    std::string frame_timer = "frame";
+
+    // Timer scopes reported when the quality level changes.
+    std::vector<std::string> stage_timers = {
+        "motion_detection/indexing_setup", "motion_detection/clustering",
+        "motion_detection/update_ever_free",
+        "motion_detection/tsdf_integration", "visualizations"};
+
+    // Weight of the newest frame in the exponential moving average of the
+    // frame time. 1 only considers the last frame.
+    float smoothing_factor = 0.3f;
+
+    // Degrade if the smoothed frame time exceeds this fraction of the budget.
+    float degrade_ratio = 1.f;
+
+    // Restore quality if the smoothed frame time is below this fraction of the
+    // budget.
+    float restore_ratio = 0.6f;
+
+    // Minimum number of frames between two level changes.
+    int hold_frames = 5;
+
+    // Highest degradation level that may be applied.
+    int max_level = kReduceRange;
+
+    // Only every n-th point is processed from level kDecimatePoints on.
+    int point_decimation = 2;
+
+    // Maximum range of processed points from level kReduceRange on [m].
+    float reduced_max_range = 10.f;
+
+    Config() { setConfigName("AdaptiveQualityController"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // Constructor.
+  explicit AdaptiveQualityController(const Config& config);
+
+  /**
+   * @brief Read the timers of all frames finished since the last call and
+   * adapt the quality level. Call once before processing each frame.
+   *
+   * @return True if the quality level changed.
+   */
+  bool update();
+
+  /**
+   * @brief Mark points that are dropped at the current quality level. Points
+   * remain in the cloud so that point indices stay valid for labels.
+   *
+   * @param cloud_info Cloud info whose points will be marked.
+   */
+  void selectPoints(CloudInfo& cloud_info) const;
+
+  // Accessors.
+  bool isEnabled() const { return config_.frame_budget > 0.f; }
+  int getLevel() const { return level_; }
+  double getSmoothedFrameTime() const { return smoothed_frame_time_; }
+  bool visualize() const { return level_ < kSkipVisualization; }
+  bool approximateSeparation() const {
+    return level_ >= kApproximateSeparation;
+  }
+
+ private:
+  const Config config_;
+
+  // Current state.
+  int level_ = kFullQuality;
+  int frames_since_change_ = 0;
+  double smoothed_frame_time_ = 0.0;
+
+  // Timer totals at the last update to compute per frame durations.
+  size_t last_num_frames_ = 0u;
+  double last_frame_total_ = 0.0;
+  std::vector<double> last_stage_totals_;
+  std::vector<double> stage_times_;
+
+  /**
+   * @brief Compute the time spent in each stage since the last update.
+   *
+   * @param num_frames Number of frames finished since the last update.
+   */
+  void updateStageTimes(size_t num_frames);
+
+  /**
+   * @brief Compose a summary of the last stage times for logging.
+   */
+  std::string printStageTimes() const;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_PROCESSING_ADAPTIVE_QUALITY_CONTROLLER_H_
@@ -2,6 +2,7 @@
 #define DYNABLOX_PROCESSING_CLUSTERING_H_
 
 #include <memory>
+#include <memory_resource>
 #include <vector>
 
 #include <pcl/pcl_base.h>
@@ -19,6 +20,7 @@
 #include "dynablox/3rd_party/config_utilities.hpp"
 #include "dynablox/common/neighborhood_search.h"
 #include "dynablox/common/types.h"
+#include "dynablox/map/ever_free_layer.h"
 
 namespace dynablox {
 
@@ -54,10 +56,11 @@ class Clustering {
   };
 
   // Constructor.
-  Clustering(const Config& config, TsdfLayer::Ptr tsdf_layer);
+  Clustering(const Config& config, TsdfLayer::Ptr tsdf_layer,
+             EverFreeLayer::Ptr ever_free_layer);
 
   // Types.
-  using ClusterIndices = std::vector<voxblox::VoxelKey>;
+  using ClusterIndices = std::pmr::vector<voxblox::VoxelKey>;
 
   /**
    * @brief Cluster all currently occupied voxels that are next to an ever-free
@@ -83,9 +86,10 @@ class Clustering {
    * seed the clusters.
    * @param frame_counter Frame number to verify added voxels contain points
    * this scan.
-   * @return Vector of all found clusters.
+   * @return Vector of all found clusters, allocated from the memory resource
+   * of the seed indices.
    */
-  std::vector<ClusterIndices> voxelClustering(
+  std::pmr::vector<ClusterIndices> voxelClustering(
       const ClusterIndices& occupied_ever_free_voxel_indices,
       const int frame_counter) const;
 
@@ -108,11 +112,11 @@ class Clustering {
    *
    * @param point_map Mapping of blocks to voxels and points in the cloud.
    * @param voxel_cluster_indices Voxel indices per cluster.
-   * @return All clusters.
+   * @return All clusters, allocated from the memory resource of the point map.
    */
   Clusters inducePointClusters(
       const BlockToPointMap& point_map,
-      const std::vector<ClusterIndices>& voxel_cluster_indices) const;
+      const std::pmr::vector<ClusterIndices>& voxel_cluster_indices) const;
 
   /**
    * @brief Merge clusters together whose points are clsoe together.
@@ -155,10 +159,29 @@ class Clustering {
    */
   void computeAABB(const Cloud& cloud, Cluster& cluster) const;
 
+  /**
+   * @brief Force the approximate voxel-based cluster separation check, e.g.
+   * to reduce the processing time under load.
+   *
+   * @param approximate If true check separation per voxel, if false use the
+   * configured check.
+   */
+  void setApproximateSeparation(bool approximate) {
+    approximate_separation_ = approximate;
+  }
+
  private:
   const Config config_;
   const TsdfLayer::Ptr tsdf_layer_;
+  const EverFreeLayer::Ptr ever_free_layer_;
   const NeighborhoodSearch neighborhood_search_;
+
+  // Runtime override of config_.check_cluster_separation_exact.
+  bool approximate_separation_ = false;
+
+  bool checkSeparationExact() const {
+    return config_.check_cluster_separation_exact && !approximate_separation_;
+  }
 };
 
 }  // namespace dynablox
@@ -0,0 +1,162 @@
+#ifndef DYNABLOX_PROCESSING_DETECTION_PIPELINE_H_
+#define DYNABLOX_PROCESSING_DETECTION_PIPELINE_H_
+
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <tf/transform_datatypes.h>
+#include <voxblox/integrator/tsdf_integrator.h>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/memory_monitor.h"
+#include "dynablox/common/types.h"
+#include "dynablox/map/ever_free_layer.h"
+#include "dynablox/processing/clustering.h"
+#include "dynablox/processing/ever_free_integrator.h"
+#include "dynablox/processing/ever_free_tsdf_integrator.h"
+#include "dynablox/processing/point_map_indexer.h"
+#include "dynablox/processing/tracking.h"
+
+namespace dynablox {
+
+/**
+ * @brief The motion detection of a single preprocessed scan without ROS:
+ * indexing, clustering, tracking, ever-free update, and integration of the
+ * static points. The MotionDetector runs its frames through a pipeline on its
+ * map, independent pipelines with their own maps can process frames in
+ * parallel. Adaptive quality and block eviction are not part of the pipeline.
+ */
+class DetectionPipeline {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Map resolution, unused if the layers are passed to the constructor.
+    float voxel_size = 0.2f;  // m.
+    int voxels_per_side = 16;
+
+    // Number of threads used by each processing component.
+    int num_threads = std::thread::hardware_concurrency();
+
+    // Points labeled dynamic at this level are not integrated into the map.
+    // One of 'none', 'ever_free', 'cluster', 'object'.
+    std::string integration_exclusion_level = "none";
+
+    // If true, integrate the TSDF with the dynablox projective integrator,
+    // which updates the ever-free state while writing voxels. Else use the
+    // voxblox integrator of 'voxblox_integrator_method'.
+    bool use_ever_free_tsdf_integrator = true;
+
+    // Voxblox integrator type, one of 'simple', 'merged', 'fast', and
+    // 'projective'. Configured from the 'voxblox' parameters.
+    std::string voxblox_integrator_method = "projective";
+
+    // Blocks further from the sensor are removed after integration [m].
+    float max_block_distance_from_body = std::numeric_limits<float>::max();
+
+    // Configs of the processing components. The number of threads is
+    // overwritten by 'num_threads'.
+    PointMapIndexer::Config point_map_indexer_config;
+    Clustering::Config clustering_config;
+    Tracking::Config tracking_config;
+    EverFreeIntegrator::Config ever_free_integrator_config;
+    EverFreeTsdfIntegrator::Config tsdf_integrator_config;
+
+    // Sets the TSDF defaults of the motion detector.
+    Config();
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  /**
+   * @brief Set up the pipeline.
+   *
+   * @param config Config of the pipeline.
+   * @param tsdf_layer Map to process on, a new layer is created if null.
+   * @param ever_free_layer Ever-free state of the map, created if null.
+   * @param voxblox_integrator_config Config of the voxblox integrator, e.g.
+   * read from the voxblox server parameters. Derived from
+   * 'tsdf_integrator_config' if not set.
+   */
+  explicit DetectionPipeline(
+      const Config& config, TsdfLayer::Ptr tsdf_layer = nullptr,
+      EverFreeLayer::Ptr ever_free_layer = nullptr,
+      const std::optional<voxblox::TsdfIntegratorBase::Config>&
+          voxblox_integrator_config = std::nullopt);
+
+  /**
+   * @brief Detect the moving points of a scan and integrate the static ones.
+   *
+   * @param T_M_S Pose of the sensor in the map.
+   * @param cloud Preprocessed scan in map frame.
+   * @param cloud_info Info of the scan, the detection labels are set here.
+   * @return The clusters of the scan.
+   */
+  Clusters processFrame(const tf::Transform& T_M_S, const Cloud& cloud,
+                        CloudInfo& cloud_info);
+
+  /**
+   * @brief Integrate all points that are not excluded by the
+   * integration_exclusion_level into the TSDF, without running detection.
+   *
+   * @param T_M_S Pose of the sensor in the map.
+   * @param cloud Preprocessed scan in map frame.
+   * @param cloud_info Info of the scan containing the dynamic labels.
+   */
+  void integrateStaticPoints(const tf::Transform& T_M_S, const Cloud& cloud,
+                             const CloudInfo& cloud_info);
+
+  // Memory of the per-frame point map, the default heap if not set.
+  void setFrameResource(std::pmr::memory_resource* frame_resource) {
+    frame_resource_ = frame_resource;
+  }
+
+  // If set, the per-frame structures are recorded in the monitor.
+  void setMemoryMonitor(std::shared_ptr<MemoryMonitor> memory_monitor) {
+    memory_monitor_ = std::move(memory_monitor);
+  }
+
+  void setApproximateSeparation(bool approximate) {
+    clustering_->setApproximateSeparation(approximate);
+  }
+
+  // Resume counting frames, e.g. after loading a map checkpoint.
+  void setFrameCounter(int frame_counter) { frame_counter_ = frame_counter; }
+  int getFrameCounter() const { return frame_counter_; }
+  const TsdfLayer& getTsdfLayer() const { return *tsdf_layer_; }
+  const EverFreeLayer& getEverFreeLayer() const { return *ever_free_layer_; }
+
+ private:
+  const Config config_;
+
+  // Map.
+  std::shared_ptr<TsdfLayer> tsdf_layer_;
+  std::shared_ptr<EverFreeLayer> ever_free_layer_;
+
+  // Processing.
+  std::unique_ptr<PointMapIndexer> point_map_indexer_;
+  std::unique_ptr<Clustering> clustering_;
+  std::unique_ptr<Tracking> tracking_;
+  std::shared_ptr<EverFreeIntegrator> ever_free_integrator_;
+  std::unique_ptr<EverFreeTsdfIntegrator> tsdf_integrator_;
+  voxblox::TsdfIntegratorBase::Ptr voxblox_integrator_;
+  std::pmr::memory_resource* frame_resource_ =
+      std::pmr::get_default_resource();
+  std::shared_ptr<MemoryMonitor> memory_monitor_;
+
+  // Variables.
+  int frame_counter_ = 0;
+
+  // Remove all blocks beyond max_block_distance_from_body of the sensor.
+  void removeDistantBlocks(const voxblox::Point& sensor_position);
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_PROCESSING_DETECTION_PIPELINE_H_
@@ -2,7 +2,9 @@
 #define DYNABLOX_PROCESSING_EVER_FREE_INTEGRATOR_H_
 
 #include <memory>
+#include <memory_resource>
 #include <thread>
+#include <vector>
 
 #include <voxblox/core/common.h>
 #include <voxblox/core/layer.h>
@@ -10,6 +12,7 @@
 #include "dynablox/3rd_party/config_utilities.hpp"
 #include "dynablox/common/neighborhood_search.h"
 #include "dynablox/common/types.h"
+#include "dynablox/map/ever_free_layer.h"
 
 namespace dynablox {
 
@@ -37,6 +40,11 @@ class EverFreeIntegrator {
     // Number of threads to use.
     int num_threads = std::thread::hardware_concurrency();
 
+    // If true, scan all updated blocks to synchronize the observed and occupied
+    // state with the TSDF. Disable if the TSDF integrator calls
+    // synchronizeVoxel() for every voxel it updates.
+    bool synchronize_tsdf = true;
+
     Config() { setConfigName("EverFreeIntegrator"); }
 
    protected:
@@ -45,64 +53,93 @@ class EverFreeIntegrator {
   };
 
   EverFreeIntegrator(const Config& config,
-                     std::shared_ptr<TsdfLayer> tsdf_layer);
+                     std::shared_ptr<TsdfLayer> tsdf_layer,
+                     std::shared_ptr<EverFreeLayer> ever_free_layer);
 
   /**
    * @brief Update the ever-free state of all changed TSDF-voxels by checking
    * when they were last occupied and for how long.
    *
    * @param frame_counter Index of current lidar scan to compute age.
+   * @param resource Memory resource for the transient per-frame data.
    */
-  void updateEverFreeVoxels(const int frame_counter) const;
+  void updateEverFreeVoxels(const int frame_counter,
+                            std::pmr::memory_resource* resource =
+                                std::pmr::get_default_resource()) const;
 
   /**
-   * @brief Process each block in parallel.
+   * @brief Process each block in parallel. Synchronizes the observed and
+   * occupied state with the TSDF and updates the dirty voxels of the block.
    *
    * @param block_index Index of block to process.
    * @param frame_counter Index of current lidar scan to compute age.
-   * @return All voxels that fell outside the block and need clearing later.
+   * @param voxels_to_remove Where to append all voxels that fell outside the
+   * block and need clearing later.
+   * @return True if any voxels need clearing.
    */
   bool blockWiseUpdateEverFree(
       const BlockIndex& block_index, const int frame_counter,
-      voxblox::AlignedVector<voxblox::VoxelKey>& voxels_to_remove) const;
+      std::pmr::vector<voxblox::VoxelKey>& voxels_to_remove) const;
+
+  /**
+   * @brief Update the observed and occupied state of a voxel from its TSDF
+   * value and mark it dirty if this can change its ever-free state. Only
+   * modifies the given block.
+   *
+   * @param block Ever-free block containing the voxel.
+   * @param linear_index Linear index of the voxel to update.
+   * @param tsdf_voxel Current TSDF value of the voxel.
+   * @param frame_counter Current lidar scan time index.
+   */
+  void synchronizeVoxel(EverFreeBlock& block, const size_t linear_index,
+                        const TsdfVoxel& tsdf_voxel,
+                        const int frame_counter) const;
+
+  // Whether a TSDF voxel counts as occupied for the occupancy counter.
+  bool isTsdfOccupied(const TsdfVoxel& tsdf_voxel) const {
+    return tsdf_voxel.distance < config_.tsdf_occupancy_threshold;
+  }
 
   /**
    * @brief If the voxel is currently static we leave it. If it was last static
-   * last frame, increment the occupancy counter, else reset it.
+   * last frame, increment the occupancy counter, else reset it. Marks the voxel
+   * as dirty until its burn-in period has passed.
    *
-   * @param tsdf_voxel Voxel to update.
+   * @param block Ever-free block containing the voxel.
+   * @param linear_index Linear index of the voxel to update.
    * @param frame_counter Current lidar scan time index.
    */
-  void updateOccupancyCounter(TsdfVoxel& tsdf_voxel,
+  void updateOccupancyCounter(EverFreeBlock& block, const size_t linear_index,
                               const int frame_counter) const;
 
   /**
    * @brief Remove the ever-free and dynamic attributes from a given voxel and
    * all its neighbors (which now also don't meet the criteria anymore.)
    *
-   * @param block Tsdf block containing the voxel.
-   * @param voxel Voxel to be cleared from ever-free.
+   * @param block Ever-free block containing the voxel.
    * @param block_index Index of the containing block.
    * @param voxel_index Index of the voxel in the block.
    * @return All voxels that fell outside the block and need clearing later.
    */
   voxblox::AlignedVector<voxblox::VoxelKey> removeEverFree(
-      TsdfBlock& block, TsdfVoxel& voxel, const BlockIndex& block_index,
+      EverFreeBlock& block, const BlockIndex& block_index,
       const VoxelIndex& voxel_index) const;
 
   /**
    * @brief Check for any occupied or unknown voxels in neighborhood, otherwise
-   * mark voxel as ever free. Check all voxels in the block.
+   * mark voxel as ever free. Check all dirty voxels in the block.
    *
    * @param block_index Index of block to check.
    * @param frame_counter Current frame to compute occupied time.
+   * @return All voxels outside the block that need to be checked later.
    */
-  void blockWiseMakeEverFree(const BlockIndex& block_index,
-                    const int frame_counter) const;
+  voxblox::AlignedVector<voxblox::VoxelKey> blockWiseMakeEverFree(
+      const BlockIndex& block_index, const int frame_counter) const;
 
  private:
   const Config config_;
   const TsdfLayer::Ptr tsdf_layer_;
+  const EverFreeLayer::Ptr ever_free_layer_;
   const NeighborhoodSearch neighborhood_search_;
 
   // Cached frequently used values.
@@ -0,0 +1,128 @@
+#ifndef DYNABLOX_PROCESSING_EVER_FREE_TSDF_INTEGRATOR_H_
+#define DYNABLOX_PROCESSING_EVER_FREE_TSDF_INTEGRATOR_H_
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <voxblox/core/common.h>
+#include <voxblox/core/layer.h>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/types.h"
+#include "dynablox/map/ever_free_layer.h"
+#include "dynablox/processing/ever_free_integrator.h"
+
+namespace dynablox {
+
+/**
+ * @brief Projective TSDF integrator for spinning lidars that updates the
+ * observed and occupied state of the ever-free layer while processing each
+ * block, so the ever-free update does not need another pass over the updated
+ * blocks. It differs from the voxblox projective integrator as follows:
+ * - Only blocks traversed by a ray, cast at block resolution up to the
+ *   truncation distance behind its point, are allocated and projected.
+ * - Non-constant weights are 1/d^2 of the voxel distance to the sensor, and
+ *   there is no weight dropoff behind the surface. Voxblox weights by the
+ *   voxel depth along the sensor z-axis. The default configs use constant
+ *   weights, where both agree.
+ * - Ranges are looked up with nearest-neighbor instead of interpolation.
+ * The ever-free state is updated as by EverFreeIntegrator with
+ * synchronize_tsdf, including the frame stamps and counter_to_reset. Written
+ * voxels are synchronized in the write loop, the other occupied voxels of an
+ * updated block are tracked in a per-block list instead of scanning it.
+ */
+class EverFreeTsdfIntegrator {
+ public:
+  // Config. Parameter names match the voxblox projective integrator.
+  struct Config : public config_utilities::Config<Config> {
+    // Truncation distance of the TSDF [m].
+    float truncation_distance = 0.4f;
+
+    // Maximum weight of a voxel.
+    float max_weight = 10000.f;
+
+    // Use a constant weight of 1 instead of weighting by distance.
+    bool use_const_weight = false;
+
+    // Range of points to integrate [m].
+    float min_ray_length_m = 0.1f;
+    float max_ray_length_m = 5.f;
+
+    // Sensor model.
+    int sensor_horizontal_resolution = 0;
+    int sensor_vertical_resolution = 0;
+    double sensor_vertical_field_of_view_degrees = 0.0;
+
+    // Number of threads to use.
+    int integrator_threads = std::thread::hardware_concurrency();
+
+    Config() { setConfigName("EverFreeTsdfIntegrator"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  EverFreeTsdfIntegrator(
+      const Config& config, TsdfLayer::Ptr tsdf_layer,
+      EverFreeLayer::Ptr ever_free_layer,
+      std::shared_ptr<EverFreeIntegrator> ever_free_integrator);
+
+  /**
+   * @brief Integrate a point cloud into the TSDF layer and update the ever-free
+   * bookkeeping of all written voxels.
+   *
+   * @param T_G_C Pose of the sensor in map frame.
+   * @param points_C Points in sensor frame.
+   * @param frame_counter Index of the current lidar scan. The ever-free state
+   * is stamped with the next frame, whose ever-free update would otherwise
+   * synchronize it.
+   */
+  void integratePointCloud(const voxblox::Transformation& T_G_C,
+                           const voxblox::Pointcloud& points_C,
+                           const int frame_counter);
+
+ private:
+  const Config config_;
+  const TsdfLayer::Ptr tsdf_layer_;
+  const EverFreeLayer::Ptr ever_free_layer_;
+  const std::shared_ptr<EverFreeIntegrator> ever_free_integrator_;
+
+  // Cached frequently used values.
+  const float block_size_;
+  const size_t voxels_per_block_;
+  const float vertical_fov_rad_;
+
+  // Range image of the current scan, row-major. Pixels without a measurement
+  // are negative.
+  std::vector<float> range_image_;
+
+  /**
+   * @brief Project a point in sensor frame onto the range image.
+   *
+   * @param point_C Point in sensor frame.
+   * @param row Where to store the row of the pixel.
+   * @param col Where to store the column of the pixel.
+   * @return True if the point falls into the image.
+   */
+  bool projectToImage(const voxblox::Point& point_C, int& row, int& col) const;
+
+  /**
+   * @brief Update all voxels of a block that are observed in the range image,
+   * synchronize the ever-free state of the written voxels, and count the
+   * occupied voxels of the block if any was updated.
+   *
+   * @param block_index Index of the block to update.
+   * @param T_C_G Transform from map to sensor frame.
+   * @param frame_counter Index of the current lidar scan.
+   * @return True if any voxel was updated.
+   */
+  bool updateBlock(const BlockIndex& block_index,
+                   const voxblox::Transformation& T_C_G,
+                   const int frame_counter) const;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_PROCESSING_EVER_FREE_TSDF_INTEGRATOR_H_
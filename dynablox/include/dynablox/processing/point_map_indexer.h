@@ -0,0 +1,95 @@
+#ifndef DYNABLOX_PROCESSING_POINT_MAP_INDEXER_H_
+#define DYNABLOX_PROCESSING_POINT_MAP_INDEXER_H_
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <voxblox/core/block_hash.h>
+#include <voxblox/core/common.h>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/types.h"
+#include "dynablox/map/ever_free_layer.h"
+#include "dynablox/processing/clustering.h"
+
+namespace dynablox {
+
+class PointMapIndexer {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Number of threads to use.
+    int num_threads = std::thread::hardware_concurrency();
+
+    Config() { setConfigName("PointMapIndexer"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // Constructor.
+  PointMapIndexer(const Config& config, TsdfLayer::Ptr tsdf_layer,
+                  EverFreeLayer::Ptr ever_free_layer);
+
+  /**
+   * @brief Create a mapping of each voxel index to the points it contains. Each
+   * point will be checked whether it falls into an ever-free voxel and updates
+   * voxel occupancy, since we go through voxels anyways already. All
+   * containers are allocated from the memory resource of the point map.
+   *
+   * @param cloud Complete point cloud to look up positions.
+   * @param frame_counter Index of the current frame.
+   * @param point_map Resulting map.
+   * @param occupied_ever_free_voxel_indices Indices of voxels containing
+   * ever-free points.
+   * @param cloud_info Cloud info to store ever-free flags of checked points.
+   */
+  void setUpPointMap(
+      const Cloud& cloud, const int frame_counter, BlockToPointMap& point_map,
+      Clustering::ClusterIndices& occupied_ever_free_voxel_indices,
+      CloudInfo& cloud_info) const;
+
+  /**
+   * @brief Create a mapping of each block to ids of points that fall into it.
+   * Points dropped by the quality controller are not mapped.
+   *
+   * @param cloud Points to process.
+   * @param cloud_info Cloud info marking which points to process.
+   * @param result Mapping of block to point ids in cloud.
+   */
+  void buildBlockToPointsMap(const Cloud& cloud, const CloudInfo& cloud_info,
+                             BlockToPointIndicesMap& result) const;
+
+  /**
+   * @brief Create a mapping of each voxel index to the points it contains. Each
+   * point will be checked whether it falls into an ever-free voxel and updates
+   * voxel occupancy, since we go through voxels anyways already. This function
+   * operates on a single block for data parallelism.
+   *
+   * @param cloud Complete point cloud to look up positions.
+   * @param frame_counter Index of the current frame.
+   * @param block_index Index of the block to be processed.
+   * @param points_in_block Indices of all points in the block.
+   * @param point_map Where to store the resulting point map for this block.
+   * @param occupied_ever_free_voxel_indices Where to store the indices of ever
+   * free voxels in this block.
+   * @param cloud_info Cloud info to store ever-free flags of checked points.
+   */
+  void blockwiseBuildPointMap(
+      const Cloud& cloud, const int frame_counter,
+      const BlockIndex& block_index, const PointIndices& points_in_block,
+      VoxelToPointMap& point_map,
+      Clustering::ClusterIndices& occupied_ever_free_voxel_indices,
+      CloudInfo& cloud_info) const;
+
+ private:
+  const Config config_;
+  const TsdfLayer::Ptr tsdf_layer_;
+  const EverFreeLayer::Ptr ever_free_layer_;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_PROCESSING_POINT_MAP_INDEXER_H_
@@ -44,6 +44,20 @@ class Preprocessing {
                          const tf::StampedTransform T_M_S, Cloud& cloud,
                          CloudInfo& cloud_info) const;
 
+  /**
+   * @brief Transform a pointcloud in place to world frame and store the
+   * timestamp, sensor position, and per point distance to the sensor in the
+   * cloud info. Points are not range filtered or marked valid here.
+   *
+   * @param timestamp Timestamp of the pointcloud [ns].
+   * @param T_M_S Transform sensor (S) to map (M).
+   * @param cloud Input pointcloud in sensor frame, transformed to world frame.
+   * @param cloud_info Cloud info to store the data of the input cloud.
+   * @return Success.
+   */
+  bool processPointcloud(const uint64_t timestamp, const tf::Transform& T_M_S,
+                         Cloud& cloud, CloudInfo& cloud_info) const;
+
  private:
   // Config.
   const Config config_;
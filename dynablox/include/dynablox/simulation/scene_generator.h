@@ -0,0 +1,135 @@
+#ifndef DYNABLOX_SIMULATION_SCENE_GENERATOR_H_
+#define DYNABLOX_SIMULATION_SCENE_GENERATOR_H_
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tf/transform_datatypes.h>
+#include <voxblox/core/common.h>
+
+#include "dynablox/3rd_party/config_utilities.hpp"
+#include "dynablox/common/types.h"
+
+namespace dynablox {
+
+// A simulated lidar scan with ground truth.
+struct SyntheticFrame {
+  std::uint64_t timestamp;  // [ns]
+  tf::Transform T_M_S;      // Pose of the sensor (S) in the map (M).
+  Cloud cloud;              // Points in sensor frame.
+
+  // Index of the dynamic object each point belongs to, -1 for static points.
+  std::vector<int> object_ids;
+};
+
+/**
+ * @brief Deterministic generator of synthetic dynamic scenes. A spinning lidar
+ * moves through a walled room with static boxes, while boxes and pedestrians
+ * move back and forth along scripted straight trajectories. All frames can be
+ * generated independently and only depend on the config.
+ */
+class SceneGenerator {
+ public:
+  // Config.
+  struct Config : public config_utilities::Config<Config> {
+    // Seed of the scene layout and measurement noise.
+    int seed = 0;
+
+    // Sequence.
+    int num_frames = 100;
+    float frame_rate = 10.f;  // Hz.
+    double start_time = 1.0;  // s.
+
+    // Lidar.
+    int num_rings = 64;
+    int num_columns = 1024;
+    float min_elevation = -22.5f;  // deg.
+    float max_elevation = 22.5f;   // deg.
+    float min_range = 0.5f;        // m.
+    float max_range = 30.f;        // m.
+    float range_noise = 0.01f;     // m, standard deviation.
+
+    // Sensor motion, back and forth along the x-axis.
+    float sensor_height = 1.8f;   // m.
+    float sensor_speed = 0.5f;    // m/s.
+    float sensor_distance = 10.f;  // m.
+
+    // Static environment.
+    float room_size = 40.f;    // m.
+    float wall_height = 4.f;   // m.
+    int num_static_objects = 20;
+
+    // Dynamic objects.
+    int num_boxes = 4;
+    int num_pedestrians = 6;
+    float object_speed = 1.2f;  // m/s.
+
+    Config() { setConfigName("SceneGenerator"); }
+
+   protected:
+    void setupParamsAndPrinting() override;
+    void checkParams() const override;
+  };
+
+  // Constructor.
+  explicit SceneGenerator(const Config& config);
+
+  /**
+   * @brief Simulate a single scan.
+   *
+   * @param frame_index Index of the frame in [0, num_frames).
+   */
+  SyntheticFrame generateFrame(int frame_index) const;
+
+  /**
+   * @brief Generate the whole sequence and write it to a directory:
+   * 'indices.csv' with the dynamic point indices per timestamp as read by the
+   * GroundTruthHandler, 'poses.csv' with the sensor poses, and 'clouds.bin'
+   * with the labeled scans in map frame as written by the CloudFileWriter.
+   *
+   * @param directory Output directory, created if it does not exist.
+   * @param num_threads Number of frames generated in parallel.
+   * @return Whether all files were written.
+   */
+  bool writeSequence(
+      const std::string& directory,
+      int num_threads = std::thread::hardware_concurrency()) const;
+
+  /**
+   * @brief Convert a frame to the preprocessed cloud in map frame and the
+   * cloud info with ground truth labels, as produced by the Preprocessing
+   * and GroundTruthHandler.
+   */
+  static void toLabeledCloud(const SyntheticFrame& frame, Cloud& cloud,
+                             CloudInfo& cloud_info);
+
+ private:
+  // Axis aligned box.
+  struct Box {
+    voxblox::Point min_corner;
+    voxblox::Point max_corner;
+  };
+
+  // Object moving back and forth between two points on the ground.
+  struct DynamicObject {
+    bool is_pedestrian;
+    voxblox::Point size;  // Extent, the diameter for pedestrians.
+    voxblox::Point start;
+    voxblox::Point end;
+    float phase;  // Distance already travelled at time zero.
+  };
+
+  const Config config_;
+  std::vector<Box> static_boxes_;
+  std::vector<DynamicObject> objects_;
+
+  voxblox::Point getSensorPosition(int frame_index) const;
+  voxblox::Point getObjectPosition(const DynamicObject& object,
+                                   int frame_index) const;
+};
+
+}  // namespace dynablox
+
+#endif  // DYNABLOX_SIMULATION_SCENE_GENERATOR_H_
@@ -0,0 +1,76 @@
+#include "dynablox/common/allocation_counter.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace dynablox {
+
+std::atomic<bool> AllocationCounter::installed_{false};
+std::atomic<bool> AllocationCounter::enabled_{false};
+std::atomic<uint64_t> AllocationCounter::num_allocations_{0u};
+std::atomic<uint64_t> AllocationCounter::allocated_bytes_{0u};
+std::atomic<int64_t> AllocationCounter::current_bytes_{0};
+std::atomic<int64_t> AllocationCounter::peak_bytes_{0};
+thread_local AllocationCounter::Counts AllocationCounter::thread_counts_;
+thread_local AllocationCounter::StageCounts AllocationCounter::worker_counts_;
+
+namespace {
+
+// Stage counters are never removed, so returned pointers stay valid.
+std::mutex& stageCountsMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::map<std::string, std::unique_ptr<AllocationCounter::StageCounts>>&
+stageCounts() {
+  static std::map<std::string,
+                  std::unique_ptr<AllocationCounter::StageCounts>>
+      counts;
+  return counts;
+}
+
+}  // namespace
+
+bool AllocationCounter::enable() {
+  if (!installed_) {
+    return false;
+  }
+  enabled_ = true;
+  return true;
+}
+
+AllocationCounter::Counts AllocationCounter::getCounts() {
+  Counts counts;
+  counts.num_allocations = num_allocations_.load(std::memory_order_relaxed);
+  counts.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+  return counts;
+}
+
+AllocationCounter::StageCounts* AllocationCounter::getStageCounts(
+    const std::string& tag) {
+  if (!isEnabled()) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(stageCountsMutex());
+  std::unique_ptr<StageCounts>& counts = stageCounts()[tag];
+  if (!counts) {
+    counts = std::make_unique<StageCounts>();
+  }
+  return counts.get();
+}
+
+std::map<std::string, AllocationCounter::Counts>
+AllocationCounter::getAllStageCounts() {
+  std::map<std::string, Counts> result;
+  std::lock_guard<std::mutex> lock(stageCountsMutex());
+  for (const auto& tag_counts : stageCounts()) {
+    Counts& counts = result[tag_counts.first];
+    counts.num_allocations = tag_counts.second->num_allocations;
+    counts.allocated_bytes = tag_counts.second->allocated_bytes;
+  }
+  return result;
+}
+
+}  // namespace dynablox
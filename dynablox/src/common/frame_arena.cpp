@@ -0,0 +1,113 @@
+#include "dynablox/common/frame_arena.h"
+
+#include <algorithm>
+#include <new>
+
+namespace dynablox {
+
+namespace {
+
+// Chunk a thread currently bump allocates from.
+struct SubArena {
+  uint64_t arena_id = 0u;
+  uint64_t generation = 0u;
+  char* current = nullptr;
+  char* end = nullptr;
+  size_t next_chunk_size = 0u;
+};
+
+thread_local SubArena sub_arena;
+
+std::atomic<uint64_t> next_arena_id{1u};
+
+char* alignUp(char* ptr, const size_t alignment) {
+  const uintptr_t value = reinterpret_cast<uintptr_t>(ptr);
+  return reinterpret_cast<char*>((value + alignment - 1u) & ~(alignment - 1u));
+}
+
+}  // namespace
+
+FrameArena::FrameArena(const size_t chunk_size)
+    : chunk_size_(std::max<size_t>(chunk_size, 4u * kChunkAlignment)),
+      id_(next_arena_id++) {}
+
+FrameArena::~FrameArena() {
+  for (const Chunk& chunk : chunks_) {
+    ::operator delete(chunk.data, std::align_val_t(kChunkAlignment));
+  }
+}
+
+void FrameArena::reset() {
+  std::lock_guard<std::mutex> lock(chunks_mutex_);
+  free_chunks_ = chunks_;
+  used_bytes_ = 0u;
+  generation_.fetch_add(1u, std::memory_order_release);
+}
+
+size_t FrameArena::getCapacity() const {
+  std::lock_guard<std::mutex> lock(chunks_mutex_);
+  size_t capacity = 0u;
+  for (const Chunk& chunk : chunks_) {
+    capacity += chunk.size;
+  }
+  return capacity;
+}
+
+void* FrameArena::do_allocate(const size_t bytes, const size_t alignment) {
+  used_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+
+  // Large allocations get a dedicated chunk.
+  if (bytes + alignment > chunk_size_ / 4u) {
+    return alignUp(acquireChunk(bytes + alignment).data, alignment);
+  }
+
+  // Start a new sub-arena if the thread has none for this arena and frame.
+  const uint64_t generation = generation_.load(std::memory_order_acquire);
+  if (sub_arena.arena_id != id_ || sub_arena.generation != generation) {
+    sub_arena = SubArena();
+    sub_arena.arena_id = id_;
+    sub_arena.generation = generation;
+    sub_arena.next_chunk_size = std::min(kInitialChunkSize, chunk_size_);
+  }
+  char* ptr = alignUp(sub_arena.current, alignment);
+  if (!sub_arena.current || ptr + bytes > sub_arena.end) {
+    const Chunk chunk =
+        acquireChunk(std::max(sub_arena.next_chunk_size, bytes + alignment));
+    sub_arena.next_chunk_size = std::min(2u * chunk.size, chunk_size_);
+    sub_arena.current = chunk.data;
+    sub_arena.end = chunk.data + chunk.size;
+    ptr = alignUp(sub_arena.current, alignment);
+  }
+  sub_arena.current = ptr + bytes;
+  return ptr;
+}
+
+FrameArena::Chunk FrameArena::acquireChunk(const size_t min_size) {
+  std::lock_guard<std::mutex> lock(chunks_mutex_);
+
+  // Reuse the smallest free chunk that fits.
+  auto best = free_chunks_.end();
+  for (auto it = free_chunks_.begin(); it != free_chunks_.end(); ++it) {
+    if (it->size >= min_size && (best == free_chunks_.end() ||
+                                 it->size < best->size)) {
+      best = it;
+    }
+  }
+  if (best != free_chunks_.end()) {
+    const Chunk chunk = *best;
+    *best = free_chunks_.back();
+    free_chunks_.pop_back();
+    return chunk;
+  }
+
+  // Allocate a new chunk.
+  Chunk chunk;
+  chunk.size = (min_size + kChunkAlignment - 1u) / kChunkAlignment *
+               kChunkAlignment;
+  chunk.data = static_cast<char*>(
+      ::operator new(chunk.size, std::align_val_t(kChunkAlignment)));
+  chunks_.push_back(chunk);
+  return chunk;
+}
+
+}  // namespace dynablox
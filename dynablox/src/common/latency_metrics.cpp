@@ -0,0 +1,279 @@
+#include "dynablox/common/latency_metrics.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dynablox {
+
+LatencyHistogram::LatencyHistogram(const int num_slices)
+    : num_slices_(num_slices),
+      slices_(std::make_unique<Slice[]>(num_slices)) {}
+
+int LatencyHistogram::computeBucket(const double seconds) {
+  if (!(seconds > kMinSeconds)) {
+    return 0;
+  }
+  // seconds = mantissa * 2^exponent with mantissa in [0.5, 1).
+  int exponent;
+  const double mantissa = std::frexp(seconds / kMinSeconds, &exponent);
+  const int octave = exponent - 1;
+  if (octave >= kNumOctaves) {
+    return kNumBuckets - 1;
+  }
+  const int sub_bucket =
+      static_cast<int>((2.0 * mantissa - 1.0) * kBucketsPerOctave);
+  return 1 + octave * kBucketsPerOctave +
+         std::min(sub_bucket, kBucketsPerOctave - 1);
+}
+
+double LatencyHistogram::getBucketUpperBound(const int bucket) {
+  if (bucket <= 0) {
+    return kMinSeconds;
+  }
+  const int octave = (bucket - 1) / kBucketsPerOctave;
+  const int sub_bucket = (bucket - 1) % kBucketsPerOctave;
+  return kMinSeconds * std::ldexp(1.0, octave) *
+         (1.0 + static_cast<double>(sub_bucket + 1) / kBucketsPerOctave);
+}
+
+void LatencyHistogram::rotate() {
+  const int next = (current_slice_.load(std::memory_order_relaxed) + 1) %
+                   num_slices_;
+  Slice& slice = slices_[next];
+  for (auto& bucket : slice.buckets) {
+    bucket.store(0u, std::memory_order_relaxed);
+  }
+  slice.sum_ns.store(0u, std::memory_order_relaxed);
+  slice.max_ns.store(0u, std::memory_order_relaxed);
+  current_slice_.store(next, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarizeWindow() const {
+  // Accumulate all slices.
+  std::array<uint64_t, kNumBuckets> buckets{};
+  Summary result;
+  uint64_t sum_ns = 0u;
+  uint64_t max_ns = 0u;
+  for (int i = 0; i < num_slices_; ++i) {
+    const Slice& slice = slices_[i];
+    for (int j = 0; j < kNumBuckets; ++j) {
+      const uint64_t count = slice.buckets[j].load(std::memory_order_relaxed);
+      buckets[j] += count;
+      result.count += count;
+    }
+    sum_ns += slice.sum_ns.load(std::memory_order_relaxed);
+    max_ns = std::max(max_ns, slice.max_ns.load(std::memory_order_relaxed));
+  }
+  result.sum = sum_ns * 1e-9;
+  result.max = max_ns * 1e-9;
+  if (result.count == 0u) {
+    return result;
+  }
+
+  // Percentiles are reported as the upper bound of their bucket, clamped to
+  // the observed maximum.
+  const std::vector<std::pair<double, double*>> percentiles = {
+      {0.5, &result.p50}, {0.95, &result.p95}, {0.99, &result.p99}};
+  uint64_t cumulative = 0u;
+  size_t percentile_index = 0u;
+  for (int j = 0; j < kNumBuckets && percentile_index < percentiles.size();
+       ++j) {
+    cumulative += buckets[j];
+    while (percentile_index < percentiles.size() &&
+           cumulative >= std::ceil(percentiles[percentile_index].first *
+                                   result.count)) {
+      *percentiles[percentile_index].second =
+          std::min(getBucketUpperBound(j), result.max);
+      ++percentile_index;
+    }
+  }
+  return result;
+}
+
+void LatencyMetrics::Config::checkParams() const {
+  checkParamGT(dump_period, 0.f, "dump_period");
+  checkParamGT(window_duration, 0.f, "window_duration");
+  checkParamGE(window_slices, 1, "window_slices");
+}
+
+void LatencyMetrics::Config::setupParamsAndPrinting() {
+  setupParam("enable", &enable);
+  setupParam("output_directory", &output_directory);
+  setupParam("dump_period", &dump_period, "s");
+  setupParam("window_duration", &window_duration, "s");
+  setupParam("window_slices", &window_slices);
+}
+
+LatencyMetrics& LatencyMetrics::instance() {
+  static LatencyMetrics instance;
+  return instance;
+}
+
+void LatencyMetrics::setup(const Config& config) {
+  LatencyMetrics& metrics = instance();
+  shutdown();
+  metrics.config_ = config.checkValid();
+  metrics.enabled_ = metrics.config_.enable;
+  if (!metrics.config_.enable || metrics.config_.output_directory.empty()) {
+    return;
+  }
+  metrics.stop_export_ = false;
+  metrics.export_thread_ = std::thread(&LatencyMetrics::exportLoop, &metrics);
+}
+
+void LatencyMetrics::shutdown() {
+  LatencyMetrics& metrics = instance();
+  if (!metrics.export_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(metrics.export_mutex_);
+    metrics.stop_export_ = true;
+  }
+  metrics.export_condition_.notify_all();
+  metrics.export_thread_.join();
+  writeToFiles();
+}
+
+LatencyHistogram* LatencyMetrics::getHistogram(const std::string& tag) {
+  LatencyMetrics& metrics = instance();
+  if (!metrics.enabled_.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(metrics.histograms_mutex_);
+  std::unique_ptr<LatencyHistogram>& histogram = metrics.histograms_[tag];
+  if (!histogram) {
+    histogram =
+        std::make_unique<LatencyHistogram>(metrics.config_.window_slices);
+  }
+  return histogram.get();
+}
+
+void LatencyMetrics::exportLoop() {
+  using Clock = std::chrono::steady_clock;
+  const auto slice_period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(config_.window_duration /
+                                    config_.window_slices));
+  const auto dump_period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(config_.dump_period));
+  auto next_rotation = Clock::now() + slice_period;
+  auto next_dump = Clock::now() + dump_period;
+
+  std::unique_lock<std::mutex> lock(export_mutex_);
+  while (!export_condition_.wait_until(
+      lock, std::min(next_rotation, next_dump),
+      [this]() { return stop_export_; })) {
+    const auto now = Clock::now();
+    if (now >= next_rotation) {
+      std::lock_guard<std::mutex> histograms_lock(histograms_mutex_);
+      for (auto& tag_histogram : histograms_) {
+        tag_histogram.second->rotate();
+      }
+      next_rotation += slice_period;
+    }
+    if (now >= next_dump) {
+      writeToFiles();
+      next_dump += dump_period;
+    }
+  }
+}
+
+std::map<std::string, LatencyHistogram::Summary>
+LatencyMetrics::getSummaries() {
+  LatencyMetrics& metrics = instance();
+  std::map<std::string, LatencyHistogram::Summary> summaries;
+  std::lock_guard<std::mutex> lock(metrics.histograms_mutex_);
+  for (const auto& tag_histogram : metrics.histograms_) {
+    summaries[tag_histogram.first] = tag_histogram.second->summarizeWindow();
+  }
+  return summaries;
+}
+
+std::string LatencyMetrics::printPrometheus() {
+  LatencyMetrics& metrics = instance();
+  std::stringstream ss;
+  ss << std::setprecision(9);
+  ss << "# HELP dynablox_stage_latency_seconds Stage latency over the last "
+     << metrics.config_.window_duration << "s.\n"
+     << "# TYPE dynablox_stage_latency_seconds summary\n";
+  std::stringstream max_ss;
+  max_ss << std::setprecision(9);
+  max_ss << "# HELP dynablox_stage_latency_max_seconds Maximum stage latency "
+            "over the last "
+         << metrics.config_.window_duration << "s.\n"
+         << "# TYPE dynablox_stage_latency_max_seconds gauge\n";
+
+  std::lock_guard<std::mutex> lock(metrics.histograms_mutex_);
+  for (const auto& tag_histogram : metrics.histograms_) {
+    const std::string label = "stage=\"" + tag_histogram.first + "\"";
+    const LatencyHistogram& histogram = *tag_histogram.second;
+    const LatencyHistogram::Summary summary = histogram.summarizeWindow();
+    ss << "dynablox_stage_latency_seconds{" << label << ",quantile=\"0.5\"} "
+       << summary.p50 << "\n"
+       << "dynablox_stage_latency_seconds{" << label << ",quantile=\"0.95\"} "
+       << summary.p95 << "\n"
+       << "dynablox_stage_latency_seconds{" << label << ",quantile=\"0.99\"} "
+       << summary.p99 << "\n"
+       << "dynablox_stage_latency_seconds_sum{" << label << "} "
+       << histogram.getTotalSeconds() << "\n"
+       << "dynablox_stage_latency_seconds_count{" << label << "} "
+       << histogram.getTotalCount() << "\n";
+    max_ss << "dynablox_stage_latency_max_seconds{" << label << "} "
+           << summary.max << "\n";
+  }
+  return ss.str() + max_ss.str();
+}
+
+std::string LatencyMetrics::printJson() {
+  LatencyMetrics& metrics = instance();
+  std::stringstream ss;
+  ss << std::setprecision(9);
+  ss << "{\n  \"window_duration\": " << metrics.config_.window_duration
+     << ",\n  \"stages\": {";
+
+  std::lock_guard<std::mutex> lock(metrics.histograms_mutex_);
+  bool first = true;
+  for (const auto& tag_histogram : metrics.histograms_) {
+    const LatencyHistogram& histogram = *tag_histogram.second;
+    const LatencyHistogram::Summary summary = histogram.summarizeWindow();
+    ss << (first ? "\n" : ",\n") << "    \"" << tag_histogram.first
+       << "\": {\"count\": " << summary.count << ", \"sum\": " << summary.sum
+       << ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95
+       << ", \"p99\": " << summary.p99 << ", \"max\": " << summary.max
+       << ", \"total_count\": " << histogram.getTotalCount()
+       << ", \"total_sum\": " << histogram.getTotalSeconds() << "}";
+    first = false;
+  }
+  ss << "\n  }\n}\n";
+  return ss.str();
+}
+
+void LatencyMetrics::writeToFiles() {
+  const std::string& directory = instance().config_.output_directory;
+  if (directory.empty()) {
+    return;
+  }
+  // Write to a temporary file first so readers never see partial files.
+  const std::vector<std::pair<std::string, std::string>> files = {
+      {"metrics.prom", printPrometheus()}, {"metrics.json", printJson()}};
+  for (const auto& name_content : files) {
+    const std::string file_name = directory + "/" + name_content.first;
+    const std::string tmp_file_name = file_name + ".tmp";
+    std::ofstream file(tmp_file_name, std::ios::trunc);
+    if (!file.is_open()) {
+      LOG(WARNING) << "Could not write metrics to '" << file_name << "'.";
+      continue;
+    }
+    file << name_content.second;
+    file.close();
+    std::rename(tmp_file_name.c_str(), file_name.c_str());
+  }
+}
+
+}  // namespace dynablox
@@ -0,0 +1,155 @@
+#include "dynablox/common/memory_monitor.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <glog/logging.h>
+
+namespace dynablox {
+
+std::string MemoryReport::print() const {
+  auto megabytes = [](double bytes) { return bytes / (1024.0 * 1024.0); };
+  std::stringstream ss;
+  ss.precision(3);
+  ss << std::fixed << "Memory report at frame " << frame << ":\n"
+     << "  TSDF layer:      " << tsdf_blocks << " blocks, "
+     << megabytes(tsdf_bytes) << " MB\n"
+     << "  Ever-free layer: " << ever_free_blocks << " blocks, "
+     << megabytes(ever_free_bytes) << " MB\n"
+     << "  Mesh layer:      " << mesh_blocks << " blocks, "
+     << megabytes(mesh_bytes) << " MB\n"
+     << "  Point map:       " << megabytes(point_map_bytes) << " MB\n"
+     << "  Clusters:        " << megabytes(cluster_bytes) << " MB";
+  if (!has_heap_statistics) {
+    return ss.str();
+  }
+  ss << "\n  Heap:            " << megabytes(heap_bytes)
+     << " MB allocated while counting\n"
+     << "  Frame peak:      " << megabytes(peak_frame_transient_bytes)
+     << " MB transient, " << frame_allocations << " allocations";
+  for (const auto& stage_allocations : stage_allocations_per_frame) {
+    ss << "\n    " << stage_allocations.first << ": "
+       << stage_allocations.second << " allocations/frame";
+  }
+  return ss.str();
+}
+
+void MemoryMonitor::Config::checkParams() const {
+  checkParamGT(report_every_n_frames, 0, "report_every_n_frames");
+}
+
+void MemoryMonitor::Config::setupParamsAndPrinting() {
+  setupParam("enable", &enable);
+  setupParam("count_allocations", &count_allocations);
+  setupParam("report_every_n_frames", &report_every_n_frames);
+}
+
+MemoryMonitor::MemoryMonitor(const Config& config, TsdfLayer::Ptr tsdf_layer,
+                             EverFreeLayer::Ptr ever_free_layer)
+    : config_(config.checkValid()),
+      tsdf_layer_(std::move(tsdf_layer)),
+      ever_free_layer_(std::move(ever_free_layer)) {
+  if (config_.enable && config_.count_allocations &&
+      !AllocationCounter::enable()) {
+    LOG(WARNING) << "Allocation hooks are not linked into this executable, "
+                    "heap allocations will not be counted.";
+  }
+}
+
+void MemoryMonitor::startFrame() {
+  if (!AllocationCounter::isEnabled()) {
+    return;
+  }
+  AllocationCounter::resetPeak();
+  frame_start_counts_ = AllocationCounter::getCounts();
+  frame_start_bytes_ = AllocationCounter::getCurrentBytes();
+}
+
+void MemoryMonitor::recordFrameStructures(const BlockToPointMap& point_map,
+                                          const Clusters& clusters) {
+  current_.point_map_bytes = estimateMemorySize(point_map);
+  current_.cluster_bytes = estimateMemorySize(clusters);
+}
+
+bool MemoryMonitor::finishFrame(const int frame, const size_t mesh_blocks,
+                                const size_t mesh_bytes) {
+  // Heap statistics of this frame.
+  if (AllocationCounter::isEnabled()) {
+    current_.has_heap_statistics = true;
+    current_.heap_bytes = AllocationCounter::getCurrentBytes();
+    current_.peak_frame_transient_bytes =
+        std::max(current_.peak_frame_transient_bytes,
+                 AllocationCounter::getPeakBytes() - frame_start_bytes_);
+    current_.frame_allocations =
+        std::max(current_.frame_allocations,
+                 AllocationCounter::getCounts().num_allocations -
+                     frame_start_counts_.num_allocations);
+  }
+  if (frame - last_report_frame_ < config_.report_every_n_frames) {
+    return false;
+  }
+
+  // Map layers are only traversed when a report is due.
+  current_.frame = frame;
+  current_.tsdf_blocks = tsdf_layer_->getNumberOfAllocatedBlocks();
+  current_.tsdf_bytes = tsdf_layer_->getMemorySize();
+  current_.ever_free_blocks = ever_free_layer_->getNumberOfAllocatedBlocks();
+  current_.ever_free_bytes = ever_free_layer_->getMemorySize();
+  current_.mesh_blocks = mesh_blocks;
+  current_.mesh_bytes = mesh_bytes;
+
+  // Average allocations per stage since the last report.
+  if (AllocationCounter::isEnabled()) {
+    const auto stage_counts = AllocationCounter::getAllStageCounts();
+    for (const auto& tag_counts : stage_counts) {
+      const uint64_t previous =
+          last_stage_counts_[tag_counts.first].num_allocations;
+      current_.stage_allocations_per_frame[tag_counts.first] =
+          static_cast<double>(tag_counts.second.num_allocations - previous) /
+          (frame - last_report_frame_);
+    }
+    last_stage_counts_ = stage_counts;
+  }
+  last_report_frame_ = frame;
+
+  // Publish the report and reset the maxima for the next period.
+  {
+    std::lock_guard<std::mutex> lock(report_mutex_);
+    report_ = current_;
+  }
+  current_.peak_frame_transient_bytes = 0;
+  current_.frame_allocations = 0u;
+  return true;
+}
+
+MemoryReport MemoryMonitor::getReport() const {
+  std::lock_guard<std::mutex> lock(report_mutex_);
+  return report_;
+}
+
+size_t MemoryMonitor::estimateMemorySize(const BlockToPointMap& point_map) {
+  // Approximate the hash map nodes by their key and value sizes.
+  size_t size = point_map.bucket_count() * sizeof(void*);
+  for (const auto& block_voxels : point_map) {
+    const VoxelToPointMap& voxel_map = block_voxels.second;
+    size += sizeof(block_voxels) + voxel_map.bucket_count() * sizeof(void*);
+    for (const auto& voxel_points : voxel_map) {
+      size += sizeof(voxel_points) +
+              voxel_points.second.capacity() * sizeof(size_t);
+    }
+  }
+  return size;
+}
+
+size_t MemoryMonitor::estimateMemorySize(const Clusters& clusters) {
+  size_t size = clusters.capacity() * sizeof(Cluster);
+  for (const Cluster& cluster : clusters) {
+    size += cluster.points.capacity() * sizeof(int) +
+            cluster.voxels.capacity() * sizeof(Point);
+  }
+  return size;
+}
+
+}  // namespace dynablox
@@ -0,0 +1,148 @@
+#include "dynablox/common/shared_memory_adapter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <glog/logging.h>
+
+namespace dynablox {
+
+void SharedMemoryAdapter::Config::checkParams() const {
+  checkParamGT(label_ring_slots, 0, "label_ring_slots");
+  checkParamGT(max_points, 0, "max_points");
+}
+
+void SharedMemoryAdapter::Config::setupParamsAndPrinting() {
+  setupParam("scan_ring_name", &scan_ring_name);
+  setupParam("label_ring_name", &label_ring_name);
+  setupParam("label_ring_slots", &label_ring_slots);
+  setupParam("max_points", &max_points);
+}
+
+SharedMemoryAdapter::SharedMemoryAdapter(const Config& config)
+    : config_(config.checkValid()) {
+  if (!config_.label_ring_name.empty()) {
+    label_ring_ = std::make_unique<SharedMemoryRing>(
+        config_.label_ring_name, config_.label_ring_slots,
+        sizeof(SharedMemoryLabelHeader) + config_.max_points);
+  }
+  connect();
+}
+
+bool SharedMemoryAdapter::connect() {
+  const auto now = std::chrono::steady_clock::now();
+  if (scan_ring_) {
+    // Scans left in a replaced ring are still read before switching rings.
+    if (now < next_stale_check_time_ || scan_ring_->numFilledSlots() > 0u ||
+        !scan_ring_->isStale()) {
+      if (now >= next_stale_check_time_) {
+        next_stale_check_time_ = now + std::chrono::milliseconds(100);
+      }
+      return true;
+    }
+    LOG(INFO) << "Shared memory ring '" << config_.scan_ring_name
+              << "' was replaced, reconnecting.";
+    scan_ring_.reset();
+    next_connect_time_ = now;
+    connect_backoff_ = std::chrono::milliseconds(1);
+    logged_waiting_ = false;
+  }
+  if (now < next_connect_time_) {
+    return false;
+  }
+
+  // Only open the ring once the producer created it, so waiting is quiet.
+  if (SharedMemoryRing::exists(config_.scan_ring_name)) {
+    scan_ring_ = std::make_unique<SharedMemoryRing>(config_.scan_ring_name);
+    if (scan_ring_->isOpen()) {
+      LOG(INFO) << "Connected to shared memory ring '"
+                << config_.scan_ring_name << "'.";
+      return true;
+    }
+    scan_ring_.reset();
+  } else if (!logged_waiting_) {
+    LOG(INFO) << "Waiting for shared memory ring '" << config_.scan_ring_name
+              << "' to be created.";
+    logged_waiting_ = true;
+  }
+  next_connect_time_ = now + connect_backoff_;
+  connect_backoff_ =
+      std::min(connect_backoff_ * 2, std::chrono::milliseconds(1000));
+  return false;
+}
+
+bool SharedMemoryAdapter::readScan(Cloud& cloud, uint64_t& timestamp,
+                                   tf::Transform& T_M_S) {
+  if (!scan_ring_) {
+    return false;
+  }
+  const uint8_t* slot = scan_ring_->beginRead();
+  if (!slot) {
+    return false;
+  }
+
+  // Read the header.
+  SharedMemoryScanHeader header;
+  std::memcpy(&header, slot, sizeof(header));
+  const size_t max_points = (scan_ring_->slotSize() - sizeof(header)) /
+                            (3u * sizeof(float));
+  if (header.num_points > max_points) {
+    LOG(WARNING) << "Scan in shared memory exceeds the slot size, skipping.";
+    scan_ring_->commitRead();
+    return false;
+  }
+  timestamp = header.timestamp;
+  tf::Quaternion rotation(header.rotation[0], header.rotation[1],
+                          header.rotation[2], header.rotation[3]);
+  T_M_S = tf::Transform(rotation.normalized(),
+                        tf::Vector3(header.position[0], header.position[1],
+                                    header.position[2]));
+
+  // Read the points directly from the slot.
+  const float* points =
+      reinterpret_cast<const float*>(slot + sizeof(SharedMemoryScanHeader));
+  cloud.resize(header.num_points);
+  for (size_t i = 0; i < header.num_points; ++i) {
+    cloud[i].x = points[3 * i];
+    cloud[i].y = points[3 * i + 1];
+    cloud[i].z = points[3 * i + 2];
+  }
+  scan_ring_->commitRead();
+  return true;
+}
+
+bool SharedMemoryAdapter::writeLabels(const CloudInfo& cloud_info) {
+  if (!label_ring_ || cloud_info.points.size() >
+                          static_cast<size_t>(config_.max_points)) {
+    return false;
+  }
+  uint8_t* slot = label_ring_->beginWrite();
+  if (!slot) {
+    return false;
+  }
+
+  SharedMemoryLabelHeader header;
+  header.timestamp = cloud_info.timestamp;
+  header.num_points = cloud_info.points.size();
+  header.reserved = 0u;
+  std::memcpy(slot, &header, sizeof(header));
+  uint8_t* labels = slot + sizeof(SharedMemoryLabelHeader);
+  for (size_t i = 0; i < cloud_info.points.size(); ++i) {
+    const PointInfo& info = cloud_info.points[i];
+    uint8_t label = 0u;
+    if (info.ever_free_level_dynamic) {
+      label |= kEverFreeLevelDynamic;
+    }
+    if (info.cluster_level_dynamic) {
+      label |= kClusterLevelDynamic;
+    }
+    if (info.object_level_dynamic) {
+      label |= kObjectLevelDynamic;
+    }
+    labels[i] = label;
+  }
+  label_ring_->commitWrite();
+  return true;
+}
+
+}  // namespace dynablox
@@ -0,0 +1,171 @@
+#include "dynablox/common/shared_memory_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <new>
+
+#include <glog/logging.h>
+
+namespace dynablox {
+
+SharedMemoryRing::SharedMemoryRing(const std::string& name,
+                                   const size_t num_slots,
+                                   const size_t slot_size)
+    : name_(name), is_owner_(true) {
+  // Align slots to cache lines.
+  const size_t aligned_slot_size = (slot_size + 63u) / 64u * 64u;
+  const size_t size = sizeof(Header) + num_slots * aligned_slot_size;
+  shm_unlink(name_.c_str());
+  const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0666);
+  if (fd < 0 || ftruncate(fd, size) != 0 || !map(fd, size)) {
+    LOG(ERROR) << "Could not create shared memory ring '" << name_ << "'.";
+    if (fd >= 0) {
+      close(fd);
+    }
+    return;
+  }
+  close(fd);
+
+  header_ = new (data_) Header();
+  header_->num_slots = num_slots;
+  header_->slot_size = aligned_slot_size;
+  header_->write_index.store(0u, std::memory_order_relaxed);
+  header_->read_index.store(0u, std::memory_order_relaxed);
+  header_->version = kVersion;
+  header_->magic.store(kMagic, std::memory_order_release);
+  slots_ = static_cast<uint8_t*>(data_) + sizeof(Header);
+}
+
+bool SharedMemoryRing::exists(const std::string& name) {
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  close(fd);
+  return true;
+}
+
+bool SharedMemoryRing::isStale() const {
+  const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return true;
+  }
+  struct stat file_stat;
+  const bool is_stale = fstat(fd, &file_stat) != 0 ||
+                        file_stat.st_dev != device_ ||
+                        file_stat.st_ino != inode_;
+  close(fd);
+  return is_stale;
+}
+
+SharedMemoryRing::SharedMemoryRing(const std::string& name) : name_(name) {
+  const int fd = shm_open(name_.c_str(), O_RDWR, 0666);
+  struct stat file_stat;
+  if (fd < 0 || fstat(fd, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) < sizeof(Header) ||
+      !map(fd, file_stat.st_size)) {
+    LOG(ERROR) << "Could not open shared memory ring '" << name_ << "'.";
+    if (fd >= 0) {
+      close(fd);
+    }
+    return;
+  }
+  close(fd);
+
+  // Slot sizes are checked with a division so corrupt headers cannot overflow.
+  Header* header = static_cast<Header*>(data_);
+  if (header->magic.load(std::memory_order_acquire) != kMagic ||
+      header->version != kVersion || header->num_slots == 0u ||
+      header->slot_size == 0u ||
+      header->num_slots >
+          (mapped_size_ - sizeof(Header)) / header->slot_size) {
+    LOG(ERROR) << "'" << name_ << "' is not a valid shared memory ring.";
+    munmap(data_, mapped_size_);
+    data_ = nullptr;
+    return;
+  }
+  header_ = header;
+  slots_ = static_cast<uint8_t*>(data_) + sizeof(Header);
+}
+
+SharedMemoryRing::~SharedMemoryRing() {
+  if (data_) {
+    munmap(data_, mapped_size_);
+  }
+  if (is_owner_) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+bool SharedMemoryRing::map(const int fd, const size_t size) {
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    return false;
+  }
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  data_ = data;
+  mapped_size_ = size;
+  device_ = file_stat.st_dev;
+  inode_ = file_stat.st_ino;
+  return true;
+}
+
+size_t SharedMemoryRing::numSlots() const {
+  return header_ ? header_->num_slots : 0u;
+}
+
+size_t SharedMemoryRing::slotSize() const {
+  return header_ ? header_->slot_size : 0u;
+}
+
+size_t SharedMemoryRing::numFilledSlots() const {
+  if (!header_) {
+    return 0u;
+  }
+  return header_->write_index.load(std::memory_order_acquire) -
+         header_->read_index.load(std::memory_order_acquire);
+}
+
+uint8_t* SharedMemoryRing::slot(const uint64_t index) const {
+  return slots_ + (index % header_->num_slots) * header_->slot_size;
+}
+
+uint8_t* SharedMemoryRing::beginWrite() {
+  if (!header_) {
+    return nullptr;
+  }
+  const uint64_t write = header_->write_index.load(std::memory_order_relaxed);
+  const uint64_t read = header_->read_index.load(std::memory_order_acquire);
+  if (write - read >= header_->num_slots) {
+    return nullptr;
+  }
+  return slot(write);
+}
+
+void SharedMemoryRing::commitWrite() {
+  header_->write_index.fetch_add(1u, std::memory_order_release);
+}
+
+const uint8_t* SharedMemoryRing::beginRead() {
+  if (!header_) {
+    return nullptr;
+  }
+  const uint64_t read = header_->read_index.load(std::memory_order_relaxed);
+  const uint64_t write = header_->write_index.load(std::memory_order_acquire);
+  if (read == write) {
+    return nullptr;
+  }
+  return slot(read);
+}
+
+void SharedMemoryRing::commitRead() {
+  header_->read_index.fetch_add(1u, std::memory_order_release);
+}
+
+}  // namespace dynablox
@@ -0,0 +1,151 @@
+#include "dynablox/common/trace_recorder.h"
+
+#include <fstream>
+#include <string>
+
+#include <glog/logging.h>
+
+namespace dynablox {
+
+void TraceRecorder::Config::checkParams() const {
+  checkParamGT(max_events_per_thread, 0, "max_events_per_thread");
+  if (enable) {
+    checkParamCond(!output_file.empty(), "'output_file' may not be empty.");
+  }
+}
+
+void TraceRecorder::Config::setupParamsAndPrinting() {
+  setupParam("enable", &enable);
+  setupParam("output_file", &output_file);
+  setupParam("max_events_per_thread", &max_events_per_thread);
+}
+
+TraceRecorder& TraceRecorder::instance() {
+  static TraceRecorder instance;
+  return instance;
+}
+
+void TraceRecorder::setup(const Config& config) {
+  TraceRecorder& recorder = instance();
+  recorder.config_ = config.checkValid();
+  recorder.start_time_ = Clock::now();
+  recorder.enabled_ = recorder.config_.enable;
+}
+
+void TraceRecorder::shutdown() {
+  TraceRecorder& recorder = instance();
+  if (!recorder.enabled_) {
+    return;
+  }
+  recorder.enabled_ = false;
+  writeTrace(recorder.config_.output_file);
+}
+
+const char* TraceRecorder::internName(const std::string& name) {
+  TraceRecorder& recorder = instance();
+  std::lock_guard<std::mutex> lock(recorder.names_mutex_);
+  return recorder.names_.insert(name).first->c_str();
+}
+
+TraceRecorder::ThreadBufferHandle::~ThreadBufferHandle() {
+  if (buffer) {
+    TraceRecorder& recorder = instance();
+    std::lock_guard<std::mutex> lock(recorder.buffers_mutex_);
+    recorder.free_buffers_.push_back(buffer);
+  }
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::getThreadBuffer() {
+  thread_local ThreadBufferHandle handle;
+  if (handle.buffer) {
+    return handle.buffer;
+  }
+
+  // Reuse the buffer of an exited thread or allocate a new one.
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  if (!free_buffers_.empty()) {
+    handle.buffer = free_buffers_.back();
+    free_buffers_.pop_back();
+    return handle.buffer;
+  }
+  auto buffer = std::make_unique<ThreadBuffer>();
+  buffer->id = buffers_.size();
+  buffer->events.resize(config_.max_events_per_thread);
+  handle.buffer = buffer.get();
+  buffers_.push_back(std::move(buffer));
+  return handle.buffer;
+}
+
+void TraceRecorder::record(const char* name, const Clock::time_point start,
+                           const Clock::time_point end, const int64_t count) {
+  TraceRecorder& recorder = instance();
+  ThreadBuffer* buffer = recorder.getThreadBuffer();
+  const size_t index = buffer->size.load(std::memory_order_relaxed);
+  if (index >= buffer->events.size()) {
+    buffer->dropped.fetch_add(1u, std::memory_order_relaxed);
+    return;
+  }
+  Event& event = buffer->events[index];
+  event.name = name;
+  event.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       start - recorder.start_time_)
+                       .count();
+  event.duration_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+  event.frame = recorder.frame_.load(std::memory_order_relaxed);
+  event.count = count;
+
+  // Publish the event to the writer.
+  buffer->size.store(index + 1u, std::memory_order_release);
+}
+
+bool TraceRecorder::writeTrace(const std::string& file_name) {
+  TraceRecorder& recorder = instance();
+  std::ofstream file(file_name, std::ios::trunc);
+  if (!file.is_open()) {
+    LOG(WARNING) << "Could not write trace to '" << file_name << "'.";
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(recorder.buffers_mutex_);
+  uint64_t num_events = 0u;
+  uint64_t num_dropped = 0u;
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto& buffer : recorder.buffers_) {
+    // Name the lanes by buffer, worker threads reuse buffers of exited ones.
+    file << (first ? "\n" : ",\n")
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+         << buffer->id << ",\"args\":{\"name\":\"thread " << buffer->id
+         << "\"}}";
+    first = false;
+
+    const size_t size = buffer->size.load(std::memory_order_acquire);
+    for (size_t i = 0; i < size; ++i) {
+      const Event& event = buffer->events[i];
+      file << ",\n{\"name\":\"" << event.name
+           << "\",\"cat\":\"dynablox\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+           << buffer->id << ",\"ts\":" << event.start_ns / 1000
+           << "." << event.start_ns % 1000 / 100
+           << ",\"dur\":" << event.duration_ns / 1000 << "."
+           << event.duration_ns % 1000 / 100 << ",\"args\":{\"frame\":"
+           << event.frame;
+      if (event.count >= 0) {
+        file << ",\"count\":" << event.count;
+      }
+      file << "}}";
+    }
+    num_events += size;
+    num_dropped += buffer->dropped.load(std::memory_order_relaxed);
+  }
+  file << "\n]}\n";
+  LOG(INFO) << "Wrote " << num_events << " trace events to '" << file_name
+            << "'"
+            << (num_dropped > 0u ? ", dropped " + std::to_string(num_dropped) +
+                                       " events due to full buffers."
+                                 : ".");
+  return true;
+}
+
+}  // namespace dynablox
@@ -0,0 +1,25 @@
+// Convert a binary cloud file to the csv format. Usage:
+//   convert_clouds_to_csv <clouds.bin> <clouds.csv>
+
+#include <iostream>
+
+#include <glog/logging.h>
+
+#include "dynablox/evaluation/cloud_file.h"
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <clouds.bin> <clouds.csv>"
+              << std::endl;
+    return 1;
+  }
+  if (!dynablox::convertCloudFileToCsv(argv[1], argv[2])) {
+    LOG(ERROR) << "Failed to convert '" << argv[1] << "'.";
+    return 1;
+  }
+  LOG(INFO) << "Wrote '" << argv[2] << "'.";
+  return 0;
+}
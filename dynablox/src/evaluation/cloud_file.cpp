@@ -0,0 +1,243 @@
+#include "dynablox/evaluation/cloud_file.h"
+
+#include <cstring>
+#include <filesystem>
+#include <unordered_map>
+
+#include <glog/logging.h>
+#include <zlib.h>
+
+#include "dynablox/evaluation/io_tools.h"
+#include "dynablox/evaluation/mapped_cloud_reader.h"
+
+namespace dynablox {
+
+namespace cloud_file {
+
+namespace {
+
+// Values are copied in host byte order, which is little endian on all
+// supported platforms.
+template <typename T>
+void writeColumn(const T& value, size_t index, uint8_t* column) {
+  std::memcpy(column + index * sizeof(T), &value, sizeof(T));
+}
+
+template <typename T>
+T readColumn(size_t index, const uint8_t* column) {
+  T value;
+  std::memcpy(&value, column + index * sizeof(T), sizeof(T));
+  return value;
+}
+
+bool getLabel(const PointInfo& info, const int label) {
+  switch (label) {
+    case kEverFree:
+      return info.ever_free_level_dynamic;
+    case kClusterDynamic:
+      return info.cluster_level_dynamic;
+    case kObjectDynamic:
+      return info.object_level_dynamic;
+    case kGroundTruthDynamic:
+      return info.ground_truth_dynamic;
+    case kReadyForEvaluation:
+      return info.ready_for_evaluation;
+    default:
+      return false;
+  }
+}
+
+void setLabel(const int label, const bool value, PointInfo& info) {
+  switch (label) {
+    case kEverFree:
+      info.ever_free_level_dynamic = value;
+      break;
+    case kClusterDynamic:
+      info.cluster_level_dynamic = value;
+      break;
+    case kObjectDynamic:
+      info.object_level_dynamic = value;
+      break;
+    case kGroundTruthDynamic:
+      info.ground_truth_dynamic = value;
+      break;
+    case kReadyForEvaluation:
+      info.ready_for_evaluation = value;
+      break;
+    default:
+      break;
+  }
+}
+
+}  // namespace
+
+bool decodeFrame(const ChunkHeader& header, const uint8_t* data,
+                 const size_t size, Cloud& cloud, CloudInfo& cloud_info,
+                 Clusters& clusters) {
+  const size_t num_points = header.num_points;
+  const size_t raw_size = rawPayloadSize(num_points);
+  std::vector<uint8_t> uncompressed;
+  if (header.flags & kCompressed) {
+    uncompressed.resize(raw_size);
+    uLongf uncompressed_size = raw_size;
+    if (uncompress(uncompressed.data(), &uncompressed_size, data, size) !=
+            Z_OK ||
+        uncompressed_size != raw_size) {
+      return false;
+    }
+    data = uncompressed.data();
+  } else if (size != raw_size) {
+    return false;
+  }
+
+  const size_t num_bytes = (num_points + 7u) / 8u;
+  const uint8_t* x = data;
+  const uint8_t* y = x + num_points * sizeof(float);
+  const uint8_t* z = y + num_points * sizeof(float);
+  const uint8_t* distance = z + num_points * sizeof(float);
+  const uint8_t* labels = distance + num_points * sizeof(float);
+  const uint8_t* ids = labels + kNumLabels * num_bytes;
+
+  cloud.clear();
+  cloud.reserve(num_points);
+  cloud_info.points.clear();
+  cloud_info.points.resize(num_points);
+  cloud_info.timestamp = header.timestamp;
+  cloud_info.has_labels = header.flags & kHasLabels;
+  clusters.clear();
+  std::unordered_map<int, size_t> cluster_id_to_index;
+  for (size_t i = 0; i < num_points; ++i) {
+    Point point;
+    point.x = readColumn<float>(i, x);
+    point.y = readColumn<float>(i, y);
+    point.z = readColumn<float>(i, z);
+    cloud.push_back(point);
+    PointInfo& info = cloud_info.points[i];
+    info.distance_to_sensor = readColumn<float>(i, distance);
+    for (int label = 0; label < kNumLabels; ++label) {
+      setLabel(
+          label, labels[label * num_bytes + i / 8u] & (1u << (i % 8u)), info);
+    }
+
+    // Rebuild the clusters of cluster-dynamic points as in loadCloudFromCsv().
+    if (!info.cluster_level_dynamic) {
+      continue;
+    }
+    const int cluster_id = readColumn<int32_t>(i, ids);
+    auto it = cluster_id_to_index.find(cluster_id);
+    if (it == cluster_id_to_index.end()) {
+      Cluster& cluster = clusters.emplace_back();
+      cluster.id = cluster_id;
+      cluster.valid = true;
+      it = cluster_id_to_index.emplace(cluster_id, clusters.size() - 1u).first;
+    }
+    clusters[it->second].points.push_back(i);
+  }
+  return true;
+}
+
+}  // namespace cloud_file
+
+CloudFileWriter::CloudFileWriter(const std::string& file_name,
+                                 const bool compress)
+    : compress_(compress),
+      file_(file_name, std::ios::binary | std::ios::trunc) {
+  if (!file_.is_open()) {
+    LOG(ERROR) << "Could not open cloud file '" << file_name << "'.";
+    return;
+  }
+  file_.write(cloud_file::kMagic, sizeof(cloud_file::kMagic));
+  file_.write(reinterpret_cast<const char*>(&cloud_file::kVersion),
+              sizeof(cloud_file::kVersion));
+}
+
+bool CloudFileWriter::writeFrame(const Cloud& cloud,
+                                 const CloudInfo& cloud_info,
+                                 const Clusters& clusters, const int cloud_id) {
+  if (!file_.is_open() || cloud_info.points.size() != cloud.size()) {
+    return false;
+  }
+  const size_t num_points = cloud.size();
+  const size_t num_bytes = (num_points + 7u) / 8u;
+  payload_.assign(cloud_file::rawPayloadSize(num_points), 0u);
+
+  // Columns.
+  uint8_t* x = payload_.data();
+  uint8_t* y = x + num_points * sizeof(float);
+  uint8_t* z = y + num_points * sizeof(float);
+  uint8_t* distance = z + num_points * sizeof(float);
+  uint8_t* labels = distance + num_points * sizeof(float);
+  uint8_t* ids = labels + cloud_file::kNumLabels * num_bytes;
+
+  const std::vector<int> cluster_ids =
+      computePointClusterIds(num_points, clusters);
+  for (size_t i = 0; i < num_points; ++i) {
+    const Point& point = cloud[i];
+    const PointInfo& info = cloud_info.points[i];
+    cloud_file::writeColumn(point.x, i, x);
+    cloud_file::writeColumn(point.y, i, y);
+    cloud_file::writeColumn(point.z, i, z);
+    cloud_file::writeColumn(static_cast<float>(info.distance_to_sensor), i,
+                            distance);
+    for (int label = 0; label < cloud_file::kNumLabels; ++label) {
+      if (cloud_file::getLabel(info, label)) {
+        labels[label * num_bytes + i / 8u] |= 1u << (i % 8u);
+      }
+    }
+    const int32_t cluster_id =
+        info.cluster_level_dynamic ? cluster_ids[i] : -1;
+    cloud_file::writeColumn(cluster_id, i, ids);
+  }
+
+  // Header.
+  cloud_file::ChunkHeader header;
+  header.cloud_id = cloud_id;
+  header.timestamp = cloud_info.timestamp;
+  header.num_points = static_cast<uint32_t>(num_points);
+  header.flags = cloud_info.has_labels ? cloud_file::kHasLabels : 0u;
+  const uint8_t* data = payload_.data();
+  size_t size = payload_.size();
+  if (compress_) {
+    uLongf compressed_size = compressBound(payload_.size());
+    compressed_.resize(compressed_size);
+    if (compress2(compressed_.data(), &compressed_size, payload_.data(),
+                  payload_.size(), Z_BEST_SPEED) != Z_OK) {
+      LOG(ERROR) << "Could not compress cloud " << cloud_id << ".";
+      return false;
+    }
+    header.flags |= cloud_file::kCompressed;
+    data = compressed_.data();
+    size = compressed_size;
+  }
+  header.payload_size = size;
+
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file_.write(reinterpret_cast<const char*>(data), size);
+  return static_cast<bool>(file_);
+}
+
+bool convertCloudFileToCsv(const std::string& file_name,
+                           const std::string& csv_file_name) {
+  const MappedCloudReader reader(file_name);
+  if (!reader.isOpen() || !reader.isBinary()) {
+    return false;
+  }
+  // saveCloudToCsv() appends, so start from a new file.
+  std::filesystem::remove(csv_file_name);
+
+  Cloud cloud;
+  CloudInfo cloud_info;
+  Clusters clusters;
+  for (size_t i = 0; i < reader.getNumberOfFrames(); ++i) {
+    if (!reader.readFrame(i, cloud, cloud_info, clusters) ||
+        !saveCloudToCsv(csv_file_name, cloud, cloud_info, clusters,
+                        reader.getCloudId(i))) {
+      LOG(ERROR) << "Could not convert frame " << i << " of '" << file_name
+                 << "'.";
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace dynablox
@@ -0,0 +1,239 @@
+#include "dynablox/evaluation/detection_latency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <tuple>
+#include <utility>
+
+#include <glog/logging.h>
+#include <voxblox/core/block_hash.h>
+
+namespace dynablox {
+
+namespace {
+
+// Write count, mean, and percentiles of the values as a line of the summary.
+void writeDistribution(const std::string& name, std::vector<double> values,
+                       std::ostream& output) {
+  output << name << "," << values.size();
+  if (values.empty()) {
+    output << ",,,,,,\n";
+    return;
+  }
+  std::sort(values.begin(), values.end());
+  double sum = 0.0;
+  for (const double value : values) {
+    sum += value;
+  }
+  const auto percentile = [&values](const double fraction) {
+    const size_t rank = std::ceil(fraction * values.size());
+    return values[std::max<size_t>(rank, 1u) - 1u];
+  };
+  output << "," << sum / values.size() << "," << values.front() << ","
+         << percentile(0.5) << "," << percentile(0.9) << ","
+         << percentile(0.99) << "," << values.back() << "\n";
+}
+
+}  // namespace
+
+void DetectionLatency::Config::checkParams() const {
+  checkParamGT(object_separation, 0.f, "object_separation");
+  checkParamGE(min_object_points, 1, "min_object_points");
+  checkParamGT(max_association_distance, 0.f, "max_association_distance");
+  checkParamGE(max_missed_frames, 0, "max_missed_frames");
+  checkParamGT(min_detected_fraction, 0.f, "min_detected_fraction");
+  checkParamLE(min_detected_fraction, 1.f, "min_detected_fraction");
+}
+
+void DetectionLatency::Config::setupParamsAndPrinting() {
+  setupParam("enable", &enable);
+  setupParam("object_separation", &object_separation, "m");
+  setupParam("min_object_points", &min_object_points);
+  setupParam("max_association_distance", &max_association_distance, "m");
+  setupParam("max_missed_frames", &max_missed_frames, "frames");
+  setupParam("min_detected_fraction", &min_detected_fraction);
+}
+
+DetectionLatency::DetectionLatency(const Config& config)
+    : config_(config.checkValid()) {}
+
+void DetectionLatency::addFrame(const Cloud& cloud, const CloudInfo& cloud_info,
+                                const double processing_time) {
+  const std::vector<Segment> segments = segmentObjects(cloud, cloud_info);
+
+  // Greedily associate the closest pairs of tracks and segments.
+  std::vector<std::tuple<float, size_t, size_t>> candidates;
+  const float max_distance_squared =
+      config_.max_association_distance * config_.max_association_distance;
+  for (size_t i = 0; i < tracks_.size(); ++i) {
+    for (size_t j = 0; j < segments.size(); ++j) {
+      const float distance_squared =
+          (tracks_[i].centroid - segments[j].centroid).squaredNorm();
+      if (distance_squared <= max_distance_squared) {
+        candidates.emplace_back(distance_squared, i, j);
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  std::vector<bool> track_matched(tracks_.size(), false);
+  std::vector<bool> segment_matched(segments.size(), false);
+  for (const auto& [distance_squared, track, segment] : candidates) {
+    if (track_matched[track] || segment_matched[segment]) {
+      continue;
+    }
+    track_matched[track] = true;
+    segment_matched[segment] = true;
+    updateTrack(segments[segment], cloud_info, processing_time,
+                tracks_[track]);
+  }
+
+  // End tracks that were missed for too long.
+  std::vector<Track> active_tracks;
+  active_tracks.reserve(tracks_.size() + segments.size());
+  for (Track& track : tracks_) {
+    if (frame_index_ - track.last_frame > config_.max_missed_frames) {
+      objects_.push_back(track.object);
+    } else {
+      active_tracks.push_back(std::move(track));
+    }
+  }
+  tracks_ = std::move(active_tracks);
+
+  // Unmatched segments are new objects.
+  for (size_t j = 0; j < segments.size(); ++j) {
+    if (segment_matched[j]) {
+      continue;
+    }
+    Track& track = tracks_.emplace_back();
+    track.object.id = next_id_++;
+    track.object.first_timestamp = cloud_info.timestamp;
+    track.object.first_frame = frame_index_;
+    updateTrack(segments[j], cloud_info, processing_time, track);
+  }
+  frame_index_++;
+}
+
+void DetectionLatency::updateTrack(const Segment& segment,
+                                   const CloudInfo& cloud_info,
+                                   const double processing_time,
+                                   Track& track) const {
+  track.centroid = segment.centroid;
+  track.last_frame = frame_index_;
+  Object& object = track.object;
+  object.num_frames++;
+  if (object.detected ||
+      segment.num_detected <
+          config_.min_detected_fraction * segment.num_points) {
+    return;
+  }
+  object.detected = true;
+  object.detection_timestamp = cloud_info.timestamp;
+  object.latency_frames = frame_index_ - object.first_frame;
+  object.latency_ms =
+      static_cast<double>(cloud_info.timestamp - object.first_timestamp) *
+      1e-6;
+  object.processing_latency_ms = processing_time * 1e3;
+}
+
+std::vector<DetectionLatency::Segment> DetectionLatency::segmentObjects(
+    const Cloud& cloud, const CloudInfo& cloud_info) const {
+  // Bin the evaluated ground truth dynamic points into cells.
+  voxblox::AnyIndexHashMapType<std::vector<size_t>>::type cells;
+  const float cell_size_inv = 1.f / config_.object_separation;
+  for (size_t i = 0; i < cloud.size(); ++i) {
+    const PointInfo& info = cloud_info.points[i];
+    if (!info.ready_for_evaluation || !info.ground_truth_dynamic) {
+      continue;
+    }
+    const voxblox::Point point(cloud[i].x, cloud[i].y, cloud[i].z);
+    cells[voxblox::getGridIndexFromPoint<voxblox::AnyIndex>(
+              point, cell_size_inv)]
+        .push_back(i);
+  }
+
+  // Connected components of neighboring cells are objects.
+  std::vector<Segment> segments;
+  std::vector<voxblox::AnyIndex> stack;
+  while (!cells.empty()) {
+    Segment segment;
+    stack.push_back(cells.begin()->first);
+    while (!stack.empty()) {
+      const voxblox::AnyIndex index = stack.back();
+      stack.pop_back();
+      const auto it = cells.find(index);
+      if (it == cells.end()) {
+        continue;
+      }
+      for (const size_t i : it->second) {
+        segment.centroid += voxblox::Point(cloud[i].x, cloud[i].y, cloud[i].z);
+        segment.num_points++;
+        segment.num_detected += cloud_info.points[i].object_level_dynamic;
+      }
+      cells.erase(it);
+      for (int x = -1; x <= 1; ++x) {
+        for (int y = -1; y <= 1; ++y) {
+          for (int z = -1; z <= 1; ++z) {
+            const voxblox::AnyIndex neighbor =
+                index + voxblox::AnyIndex(x, y, z);
+            if (cells.count(neighbor)) {
+              stack.push_back(neighbor);
+            }
+          }
+        }
+      }
+    }
+    if (segment.num_points >= static_cast<size_t>(config_.min_object_points)) {
+      segment.centroid /= segment.num_points;
+      segments.push_back(segment);
+    }
+  }
+  return segments;
+}
+
+void DetectionLatency::finish() {
+  for (const Track& track : tracks_) {
+    objects_.push_back(track.object);
+  }
+  tracks_.clear();
+  std::sort(objects_.begin(), objects_.end(),
+            [](const Object& a, const Object& b) { return a.id < b.id; });
+}
+
+bool DetectionLatency::writeResults(const std::string& directory) const {
+  // Latency of every object.
+  std::ofstream objects_file(directory + "/detection_latency.csv",
+                             std::ios::trunc);
+  objects_file << "ObjectID,FirstTimestamp,FirstFrame,NumFrames,Detected,"
+                  "DetectionTimestamp,LatencyFrames,LatencyMs,"
+                  "ProcessingLatencyMs\n";
+  std::vector<double> latency_frames;
+  std::vector<double> latency_ms;
+  std::vector<double> processing_latency_ms;
+  for (const Object& object : objects_) {
+    objects_file << object.id << "," << object.first_timestamp << ","
+                 << object.first_frame << "," << object.num_frames << ","
+                 << object.detected << "," << object.detection_timestamp
+                 << "," << object.latency_frames << "," << object.latency_ms
+                 << "," << object.processing_latency_ms << "\n";
+    if (object.detected) {
+      latency_frames.push_back(object.latency_frames);
+      latency_ms.push_back(object.latency_ms);
+      processing_latency_ms.push_back(object.processing_latency_ms);
+    }
+  }
+
+  // Distributions over the detected objects.
+  std::ofstream summary_file(directory + "/detection_latency_summary.csv",
+                             std::ios::trunc);
+  summary_file << "Metric,Count,Mean,Min,P50,P90,P99,Max\n";
+  writeDistribution("LatencyFrames", latency_frames, summary_file);
+  writeDistribution("LatencyMs", latency_ms, summary_file);
+  writeDistribution("ProcessingLatencyMs", processing_latency_ms,
+                    summary_file);
+  LOG(INFO) << "Detected " << latency_frames.size() << " of "
+            << objects_.size() << " ground truth objects.";
+  return objects_file.good() && summary_file.good();
+}
+
+}  // namespace dynablox
@@ -2,10 +2,11 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
-#include <functional>
 #include <iomanip>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -17,7 +18,9 @@ namespace dynablox {
 
 const std::string Evaluator::config_file_name_ = "config.txt";
 const std::string Evaluator::clouds_file_name_ = "clouds.csv";
+const std::string Evaluator::binary_clouds_file_name_ = "clouds.bin";
 const std::string Evaluator::scores_file_name_ = "scores.csv";
+const std::string Evaluator::range_scores_file_name_ = "range_scores.csv";
 const std::string Evaluator::timings_file_name_ = "timings.txt";
 
 void Evaluator::Config::checkParams() const {
@@ -25,7 +28,15 @@ void Evaluator::Config::checkParams() const {
   checkParamGE(min_range, 0.f, "min_range");
   checkParamCond(max_range > min_range,
                  "'max_range' must be larger than 'min_range'.");
+  checkParamCond(cloud_format == "binary" || cloud_format == "csv",
+                 "'cloud_format' must be 'binary' or 'csv'.");
+  checkParamGT(max_queue_size, 0, "max_queue_size");
+  checkParamCond(range_bins.size() != 1u,
+                 "'range_bins' must have at least 2 edges if set.");
+  checkParamCond(std::is_sorted(range_bins.begin(), range_bins.end()),
+                 "'range_bins' must be ascending.");
   checkParamConfig(ground_truth_config);
+  checkParamConfig(detection_latency_config);
 }
 
 void Evaluator::Config::setupParamsAndPrinting() {
@@ -35,14 +46,43 @@ void Evaluator::Config::setupParamsAndPrinting() {
   setupParam("evaluate_point_level", &evaluate_point_level);
   setupParam("evaluate_cluster_level", &evaluate_cluster_level);
   setupParam("evaluate_object_level", &evaluate_object_level);
+  setupParam("range_bins", &range_bins, "m");
   setupParam("save_clouds", &save_clouds);
+  setupParam("cloud_format", &cloud_format);
+  setupParam("compress_clouds", &compress_clouds);
+  setupParam("asynchronous", &asynchronous);
+  setupParam("max_queue_size", &max_queue_size);
   setupParam("ground_truth", &ground_truth_config, "ground_truth");
+  setupParam("detection_latency", &detection_latency_config,
+             "detection_latency");
 }
 
 Evaluator::Evaluator(const Config& config)
     : config_(config.checkValid()),
-      ground_truth_handler(config_.ground_truth_config) {
+      ground_truth_handler(config_.ground_truth_config),
+      detection_latency_(config_.detection_latency_config) {
   setupFiles();
+  if (config_.asynchronous) {
+    writer_thread_ = std::thread(&Evaluator::writerLoop, this);
+  }
+}
+
+Evaluator::~Evaluator() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stopped_ = true;
+  }
+  queue_condition_.notify_all();
+  if (writer_thread_.joinable()) {
+    writer_thread_.join();
+  }
+  writeTimingsToFile();
+
+  // Objects are only complete once all frames are evaluated.
+  if (detection_latency_.isEnabled()) {
+    detection_latency_.finish();
+    detection_latency_.writeResults(output_directory_);
+  }
 }
 
 void Evaluator::setupFiles() {
@@ -60,78 +100,192 @@ void Evaluator::setupFiles() {
 
   // Setup the header of the scores file.
   if (config_.evaluate_point_level) {
-    evaluated_levels_.push_back("point");
+    evaluated_levels_.push_back(LabelPlanes::kPoint);
   }
   if (config_.evaluate_cluster_level) {
-    evaluated_levels_.push_back("cluster");
+    evaluated_levels_.push_back(LabelPlanes::kCluster);
   }
   if (config_.evaluate_object_level) {
-    evaluated_levels_.push_back("object");
+    evaluated_levels_.push_back(LabelPlanes::kObject);
   }
 
-  // Setup scores file.
-  std::ofstream writefile;
-  writefile.open(output_directory_ + "/" + scores_file_name_, std::ios::trunc);
-  writefile << "timestamp,";
-  for (const std::string& level : evaluated_levels_) {
-    writefile << level + "_IoU," << level + "_Precision," << level + "_Recall,"
-              << level + "_TP," << level + "_TN," << level + "_FP,"
-              << level + "_FN,";
-  }
-  writefile << "EvaluatedPoints,TotalPoints" << std::endl;
-  writefile.close();
+  // Setup scores file, which is kept open and flushed after each batch.
+  scores_file_.open(output_directory_ + "/" + scores_file_name_,
+                    std::ios::trunc);
+  scores_file_ << "timestamp,";
+  for (const LabelPlanes::Level level_id : evaluated_levels_) {
+    const std::string level = LabelPlanes::levelToString(level_id);
+    scores_file_ << level + "_IoU," << level + "_Precision,"
+                 << level + "_Recall," << level + "_TP," << level + "_TN,"
+                 << level + "_FP," << level + "_FN,";
+  }
+  scores_file_ << "EvaluatedPoints,TotalPoints" << std::endl;
+
+  // Setup range scores file, one line per level and bin.
+  if (!config_.range_bins.empty()) {
+    range_scores_file_.open(output_directory_ + "/" + range_scores_file_name_,
+                            std::ios::trunc);
+    range_scores_file_ << "timestamp,Level,MinRange,MaxRange,IoU,Precision,"
+                          "Recall,TP,TN,FP,FN,EvaluatedPoints"
+                       << std::endl;
+  }
+
+  // Setup clouds file.
+  if (config_.save_clouds && config_.cloud_format == "binary") {
+    cloud_writer_ = std::make_unique<CloudFileWriter>(
+        output_directory_ + "/" + binary_clouds_file_name_,
+        config_.compress_clouds);
+  }
 }
 
 void Evaluator::evaluateFrame(const Cloud& cloud, CloudInfo& cloud_info,
-                              const Clusters& clusters) {
-  // Update the timings every frame.
-  writeTimingsToFile();
+                              const Clusters& clusters,
+                              const double processing_time) {
   saveConfig();
 
-  // If ground truth available, label the cloud and compute the metrics.
+  // If ground truth available, label the cloud and queue it for scoring.
+  std::deque<PendingFrame> frames;
   if (ground_truth_handler.labelCloudInfoIfAvailable(cloud_info)) {
-    writeScoresToFile(cloud_info);
-    saveCloud(cloud, cloud_info, clusters);
+    filterEvaluatedPoints(cloud_info);
+    PendingFrame& frame = frames.emplace_back();
+    frame.cloud_id = gt_frame_counter_;
+    frame.cloud_info = cloud_info;
+    frame.processing_time = processing_time;
+    if (config_.save_clouds || detection_latency_.isEnabled()) {
+      frame.cloud = cloud;
+    }
+    if (config_.save_clouds) {
+      frame.clusters = Clusters(clusters.begin(), clusters.end());
+    }
     gt_frame_counter_++;
     LOG(INFO) << "Evaluated cloud " << gt_frame_counter_ << " with timestamp "
               << cloud_info.timestamp << ".";
   }
+
+  // Update the timings every frame.
+  if (!config_.asynchronous) {
+    writeFrames(frames);
+    writeTimingsToFile();
+    return;
+  }
+  std::string timings = voxblox::timing::Timing::Print();
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    queue_condition_.wait(lock, [this]() {
+      return queue_.size() < static_cast<size_t>(config_.max_queue_size);
+    });
+    if (!frames.empty()) {
+      queue_.push_back(std::move(frames.front()));
+    }
+    pending_timings_ = std::move(timings);
+  }
+  queue_condition_.notify_all();
+}
+
+void Evaluator::writerLoop() {
+  std::deque<PendingFrame> frames;
+  std::string timings;
+  bool stopped = false;
+  while (!stopped) {
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_condition_.wait(lock, [this]() {
+        return stopped_ || !queue_.empty() || !pending_timings_.empty();
+      });
+      frames.swap(queue_);
+      timings.swap(pending_timings_);
+      stopped = stopped_;
+    }
+    // Release the detection thread if it waits for space in the queue.
+    queue_condition_.notify_all();
+
+    // Write everything that queued up in one batch.
+    writeFrames(frames);
+    if (!timings.empty()) {
+      writeTimings(timings);
+      timings.clear();
+    }
+  }
+}
+
+void Evaluator::writeFrames(std::deque<PendingFrame>& frames) {
+  if (frames.empty()) {
+    return;
+  }
+  std::ostringstream scores;
+  std::ostringstream range_scores;
+  for (const PendingFrame& frame : frames) {
+    writeScores(frame.cloud_info, scores, range_scores);
+    saveCloud(frame.cloud, frame.cloud_info, frame.clusters, frame.cloud_id);
+    if (detection_latency_.isEnabled()) {
+      detection_latency_.addFrame(frame.cloud, frame.cloud_info,
+                                  frame.processing_time);
+    }
+  }
+  scores_file_ << scores.str() << std::flush;
+  if (range_scores_file_.is_open()) {
+    range_scores_file_ << range_scores.str() << std::flush;
+  }
+  frames.clear();
 }
 
 void Evaluator::writeTimingsToFile() const {
+  writeTimings(voxblox::timing::Timing::Print());
+}
+
+void Evaluator::writeTimings(const std::string& timings) const {
   // Overwrite the timings with the current statistics.
   std::ofstream writefile;
   writefile.open(output_directory_ + "/" + timings_file_name_, std::ios::trunc);
-  writefile << voxblox::timing::Timing::Print() << std::endl;
+  writefile << timings << std::endl;
   writefile.close();
 }
 
-void Evaluator::writeScoresToFile(CloudInfo& cloud_info) {
-  std::ofstream writefile;
-  writefile.open(output_directory_ + "/" + scores_file_name_, std::ios::app);
-
-  // Time stamp and preprocessing.
-  writefile << cloud_info.timestamp;
-  const int evaluated_points = filterEvaluatedPoints(cloud_info);
+void Evaluator::writeScores(const CloudInfo& cloud_info, std::ostream& output,
+                            std::ostream& range_output) const {
+  // Count all levels and range bins in one pass.
+  const LabelPlanes planes(cloud_info, config_.range_bins);
+  const LabelPlanes::Counts counts = planes.count();
 
-  // Evaluated levels.
-  for (const std::string& level : evaluated_levels_) {
-    evaluateCloudAtLevel(cloud_info, level, writefile);
+  // Time stamp and evaluated levels.
+  output << cloud_info.timestamp;
+  for (const LabelPlanes::Level level : evaluated_levels_) {
+    writeMetrics(counts.total[level], output);
   }
 
   // Number of evaluated points.
-  writefile << "," << evaluated_points << "," << cloud_info.points.size()
-            << std::endl;
+  output << "," << planes.getNumberOfEvaluatedPoints() << ","
+         << cloud_info.points.size() << "\n";
+
+  // Scores per range bin.
+  for (size_t bin = 0; bin < counts.bins.size(); ++bin) {
+    for (const LabelPlanes::Level level : evaluated_levels_) {
+      const ConfusionCounts& bin_counts = counts.bins[bin][level];
+      range_output << cloud_info.timestamp << ","
+                   << LabelPlanes::levelToString(level) << ","
+                   << config_.range_bins[bin] << ","
+                   << config_.range_bins[bin + 1];
+      writeMetrics(bin_counts, range_output);
+      range_output << ","
+                   << bin_counts.tp + bin_counts.fp + bin_counts.tn +
+                          bin_counts.fn
+                   << "\n";
+    }
+  }
 }
 
 void Evaluator::saveCloud(const Cloud& cloud, const CloudInfo& cloud_info,
-                          const Clusters& clusters) {
+                          const Clusters& clusters, const int cloud_id) {
   if (!config_.save_clouds) {
     return;
   }
 
+  if (cloud_writer_) {
+    cloud_writer_->writeFrame(cloud, cloud_info, clusters, cloud_id);
+    return;
+  }
   const std::string file_name = output_directory_ + "/" + clouds_file_name_;
-  saveCloudToCsv(file_name, cloud, cloud_info, clusters, gt_frame_counter_);
+  saveCloudToCsv(file_name, cloud, cloud_info, clusters, cloud_id);
 }
 
 int Evaluator::filterEvaluatedPoints(CloudInfo& cloud_info) const {
@@ -146,49 +300,12 @@ int Evaluator::filterEvaluatedPoints(CloudInfo& cloud_info) const {
   return number_of_points;
 }
 
-std::function<bool(const PointInfo&)> Evaluator::getCheckLevelFunction(
-    const std::string& level) {
-  if (level == "point") {
-    return [](const PointInfo& point) { return point.ever_free_level_dynamic; };
-  } else if (level == "cluster") {
-    return [](const PointInfo& point) { return point.cluster_level_dynamic; };
-  } else if (level == "object") {
-    return [](const PointInfo& point) { return point.object_level_dynamic; };
-  } else {
-    LOG(ERROR) << "Unknown evaluation level '" << level << "'!";
-    return [](const PointInfo& /* point */) { return false; };
-  }
-}
-
-void Evaluator::evaluateCloudAtLevel(const CloudInfo& cloud_info,
-                                     const std::string& level,
-                                     std::ofstream& output_file) const {
-  // Setup.
-  std::function<bool(const PointInfo&)> check_level =
-      getCheckLevelFunction(level);
-
-  // Compute true/false positives/negatives.
-  uint tp = 0u;
-  uint fp = 0u;
-  uint tn = 0u;
-  uint fn = 0u;
-  for (const PointInfo& point : cloud_info.points) {
-    if (!point.ready_for_evaluation) {
-      continue;
-    }
-    const bool is_dynamic = check_level(point);
-    if (is_dynamic && point.ground_truth_dynamic) {
-      tp++;
-    } else if (is_dynamic && !point.ground_truth_dynamic) {
-      fp++;
-    } else if (!is_dynamic && !point.ground_truth_dynamic) {
-      tn++;
-    } else if (!is_dynamic && point.ground_truth_dynamic) {
-      fn++;
-    }
-  }
-
-  // Write metrics to file.
+void Evaluator::writeMetrics(const ConfusionCounts& counts,
+                             std::ostream& output_file) {
+  const uint tp = counts.tp;
+  const uint fp = counts.fp;
+  const uint tn = counts.tn;
+  const uint fn = counts.fn;
   output_file << "," << computeIntersectionOverUnion(tp, fp, fn) << ","
               << computePrecision(tp, fp) << "," << computeRecall(tp, fn) << ","
               << tp << "," << tn << "," << fp << "," << fn;
@@ -1,76 +1,124 @@
 #include "dynablox/evaluation/ground_truth_handler.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <filesystem>
-#include <iostream>
-#include <map>
+#include <iterator>
+#include <limits>
 #include <string>
 #include <vector>
 
-#include <boost/filesystem.hpp>
-#include <pcl/filters/crop_box.h>
-#include <pcl_ros/impl/transforms.hpp>
-
 namespace dynablox {
 
 void GroundTruthHandler::Config::checkParams() const {
   checkParamCond(std::filesystem::exists(file_path),
                  "Target file '" + file_path + "' does not exist.");
+  checkParamGE(timestamp_tolerance, 0, "timestamp_tolerance");
 }
 
 void GroundTruthHandler::Config::setupParamsAndPrinting() {
   setupParam("file_path", &file_path);
+  setupParam("timestamp_tolerance", &timestamp_tolerance, "ns");
 }
 
 GroundTruthHandler::GroundTruthHandler(const Config& config)
-    : config_(config.checkValid()) {
+    : config_(config.checkValid()), file_(config_.file_path) {
   // Setup the lookup table.
-  createLookupFromCSV();
+  indexFile();
 }
 
-void GroundTruthHandler::createLookupFromCSV() {
-  // Open file.
-  std::ifstream readfile;
-  readfile.open(config_.file_path);
+void GroundTruthHandler::indexFile() {
+  entries_.clear();
+  if (!file_.isOpen()) {
+    LOG(ERROR) << "Could not read '" << config_.file_path << "'.";
+    return;
+  }
 
-  // Read data.
-  std::string line;
-  size_t counter = 0;
-  while (getline(readfile, line)) {
-    if (line.empty()) {
-      continue;
-    }
-    bool first_column = true;
-    std::uint64_t timestamp;
-    std::istringstream iss(line);
-    std::string linestream;
-    std::vector<int> row;
-    while (std::getline(iss, linestream, ',')) {
-      if (first_column) {
-        timestamp = static_cast<uint64_t>(std::stoul(linestream));
-        first_column = false;
-      } else {
-        row.push_back(std::stoi(linestream));
-      }
+  // Only parse the leading timestamp of each line.
+  const char* line = file_.data();
+  while (line < file_.end()) {
+    const void* newline = std::memchr(line, '\n', file_.end() - line);
+    const char* line_end =
+        newline ? static_cast<const char*>(newline) : file_.end();
+    Entry entry;
+    const std::from_chars_result result =
+        std::from_chars(line, line_end, entry.timestamp);
+    if (result.ec == std::errc()) {
+      entry.begin = result.ptr - file_.data();
+      entry.end = line_end - file_.data();
+      entries_.push_back(entry);
     }
-    ground_truth_lookup_[timestamp] = row;
-    counter++;
+    line = line_end + 1;
   }
-  LOG(INFO) << "Read " << counter << " entries from '" << config_.file_path
-            << "'.";
+
+  // Later lines overwrite earlier ones with the same timestamp.
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const Entry& a, const Entry& b) {
+                     return a.timestamp < b.timestamp;
+                   });
+  auto last = std::unique(entries_.rbegin(), entries_.rend(),
+                          [](const Entry& a, const Entry& b) {
+                            return a.timestamp == b.timestamp;
+                          });
+  entries_.erase(entries_.begin(), last.base());
+  LOG(INFO) << "Indexed " << entries_.size() << " entries from '"
+            << config_.file_path << "'.";
 }
 
-bool GroundTruthHandler::labelCloudInfoIfAvailable(
-    CloudInfo& cloud_info) const {
-  // Check whether there exists a label for this timestamp.
-  auto it = ground_truth_lookup_.find(cloud_info.timestamp);
-  if (it == ground_truth_lookup_.end()) {
+GroundTruthHandler::Entry* GroundTruthHandler::findEntry(
+    const std::uint64_t timestamp) {
+  auto it = std::lower_bound(entries_.begin(), entries_.end(), timestamp,
+                             [](const Entry& entry, const std::uint64_t t) {
+                               return entry.timestamp < t;
+                             });
+  Entry* closest = nullptr;
+  std::uint64_t min_difference = std::numeric_limits<std::uint64_t>::max();
+  if (it != entries_.end()) {
+    closest = &*it;
+    min_difference = it->timestamp - timestamp;
+  }
+  if (it != entries_.begin() &&
+      timestamp - std::prev(it)->timestamp < min_difference) {
+    closest = &*std::prev(it);
+    min_difference = timestamp - closest->timestamp;
+  }
+  const auto tolerance =
+      static_cast<std::uint64_t>(config_.timestamp_tolerance);
+  return min_difference <= tolerance ? closest : nullptr;
+}
+
+bool GroundTruthHandler::labelCloudInfoIfAvailable(CloudInfo& cloud_info) {
+  // Check whether there exists a label for this timestamp that was not used
+  // for another cloud.
+  Entry* entry = findEntry(cloud_info.timestamp);
+  if (!entry ||
+      (entry->consumed && entry->cloud_timestamp != cloud_info.timestamp)) {
     return false;
   }
+  entry->consumed = true;
+  entry->cloud_timestamp = cloud_info.timestamp;
 
-  // label the cloud.
+  // Label the cloud, parsing the indices of this line.
   cloud_info.has_labels = true;
-  for (const auto& index : it->second) {
-    cloud_info.points[index].ground_truth_dynamic = true;
+  const char* pos = file_.data() + entry->begin;
+  const char* end = file_.data() + entry->end;
+  while (pos < end) {
+    if (*pos == ',' || *pos == ' ' || *pos == '\r') {
+      ++pos;
+      continue;
+    }
+    size_t index;
+    const std::from_chars_result result = std::from_chars(pos, end, index);
+    if (result.ec != std::errc()) {
+      LOG(WARNING) << "Invalid ground truth index for timestamp "
+                   << entry->timestamp << ".";
+      break;
+    }
+    pos = result.ptr;
+    if (index < cloud_info.points.size()) {
+      cloud_info.points[index].ground_truth_dynamic = true;
+    }
   }
   return true;
 }
@@ -0,0 +1,103 @@
+#include "dynablox/evaluation/label_planes.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace dynablox {
+
+namespace {
+
+inline uint popcount(const std::uint64_t word) {
+  return static_cast<uint>(__builtin_popcountll(word));
+}
+
+inline void countWord(const std::uint64_t predicted,
+                      const std::uint64_t ground_truth,
+                      const std::uint64_t mask, ConfusionCounts& counts) {
+  counts.tp += popcount(predicted & ground_truth & mask);
+  counts.fp += popcount(predicted & ~ground_truth & mask);
+  counts.fn += popcount(~predicted & ground_truth & mask);
+  counts.tn += popcount(~predicted & ~ground_truth & mask);
+}
+
+}  // namespace
+
+LabelPlanes::LabelPlanes(const CloudInfo& cloud_info,
+                         const std::vector<float>& range_bin_edges) {
+  const size_t num_words = (cloud_info.points.size() + 63u) / 64u;
+  for (Plane& plane : predicted_) {
+    plane.assign(num_words, 0u);
+  }
+  ground_truth_.assign(num_words, 0u);
+  evaluated_.assign(num_words, 0u);
+  if (range_bin_edges.size() > 1u) {
+    bins_.assign(range_bin_edges.size() - 1u, Plane(num_words, 0u));
+  }
+
+  for (size_t i = 0; i < cloud_info.points.size(); ++i) {
+    const PointInfo& point = cloud_info.points[i];
+    if (!point.ready_for_evaluation) {
+      continue;
+    }
+    const size_t word = i / 64u;
+    const std::uint64_t bit = std::uint64_t(1) << (i % 64u);
+    num_evaluated_points_++;
+    evaluated_[word] |= bit;
+    if (point.ground_truth_dynamic) {
+      ground_truth_[word] |= bit;
+    }
+    if (point.ever_free_level_dynamic) {
+      predicted_[kPoint][word] |= bit;
+    }
+    if (point.cluster_level_dynamic) {
+      predicted_[kCluster][word] |= bit;
+    }
+    if (point.object_level_dynamic) {
+      predicted_[kObject][word] |= bit;
+    }
+    if (bins_.empty()) {
+      continue;
+    }
+    const auto upper =
+        std::upper_bound(range_bin_edges.begin(), range_bin_edges.end(),
+                         static_cast<float>(point.distance_to_sensor));
+    if (upper != range_bin_edges.begin() && upper != range_bin_edges.end()) {
+      bins_[upper - range_bin_edges.begin() - 1][word] |= bit;
+    }
+  }
+}
+
+LabelPlanes::Counts LabelPlanes::count() const {
+  Counts counts;
+  counts.bins.resize(bins_.size());
+  for (size_t word = 0; word < evaluated_.size(); ++word) {
+    const std::uint64_t ground_truth = ground_truth_[word];
+    for (int level = 0; level < kNumLevels; ++level) {
+      const std::uint64_t predicted = predicted_[level][word];
+      countWord(predicted, ground_truth, evaluated_[word],
+                counts.total[level]);
+      for (size_t bin = 0; bin < bins_.size(); ++bin) {
+        countWord(predicted, ground_truth, bins_[bin][word],
+                  counts.bins[bin][level]);
+      }
+    }
+  }
+  return counts;
+}
+
+std::string LabelPlanes::levelToString(const Level level) {
+  switch (level) {
+    case kPoint:
+      return "point";
+    case kCluster:
+      return "cluster";
+    case kObject:
+      return "object";
+    default:
+      LOG(ERROR) << "Unknown evaluation level " << level << "!";
+      return "unknown";
+  }
+}
+
+}  // namespace dynablox
@@ -0,0 +1,267 @@
+#include "dynablox/evaluation/mapped_cloud_reader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <unordered_map>
+
+#include <glog/logging.h>
+
+#include "dynablox/common/index_getter.h"
+
+namespace dynablox {
+
+namespace {
+
+// Parse the value at 'pos' and advance past the following comma.
+template <typename T>
+bool parseField(const char*& pos, const char* end, T* value) {
+  const std::from_chars_result result = std::from_chars(pos, end, *value);
+  if (result.ec != std::errc()) {
+    return false;
+  }
+  pos = result.ptr;
+  if (pos < end && *pos == ',') {
+    ++pos;
+  }
+  return true;
+}
+
+bool parseField(const char*& pos, const char* end, float* value) {
+#if defined(__cpp_lib_to_chars)
+  return parseField<float>(pos, end, value);
+#else
+  // Older standard libraries lack floating point from_chars. Float fields are
+  // never last in a line, so strtof always stops within the mapping. Parse in
+  // the "C" locale, as from_chars does, independent of the global locale.
+  static const locale_t c_locale = newlocale(LC_ALL_MASK, "C", nullptr);
+  char* parsed;
+  *value = strtof_l(pos, &parsed, c_locale);
+  if (parsed == pos || parsed > end) {
+    return false;
+  }
+  pos = parsed;
+  if (pos < end && *pos == ',') {
+    ++pos;
+  }
+  return true;
+#endif
+}
+
+bool parseField(const char*& pos, const char* end, bool* value) {
+  int flag;
+  if (!parseField(pos, end, &flag)) {
+    return false;
+  }
+  *value = flag != 0;
+  return true;
+}
+
+// End of the line starting at 'pos', excluding the newline.
+const char* findLineEnd(const char* pos, const char* end) {
+  const void* newline = std::memchr(pos, '\n', end - pos);
+  return newline ? static_cast<const char*>(newline) : end;
+}
+
+bool isEmptyLine(const char* begin, const char* end) {
+  return begin == end || (end - begin == 1 && *begin == '\r');
+}
+
+}  // namespace
+
+MappedCloudReader::MappedCloudReader(const std::string& file_name)
+    : file_(file_name) {
+  if (!file_.isOpen()) {
+    LOG(ERROR) << "Could not map cloud file '" << file_name << "'.";
+    return;
+  }
+  data_ = file_.data();
+  mapped_size_ = file_.size();
+  is_binary_ = mapped_size_ >= sizeof(cloud_file::kMagic) &&
+               std::memcmp(data_, cloud_file::kMagic,
+                           sizeof(cloud_file::kMagic)) == 0;
+  if (is_binary_) {
+    indexBinaryFrames(file_name);
+  } else {
+    indexCsvFrames();
+  }
+}
+
+void MappedCloudReader::indexBinaryFrames(const std::string& file_name) {
+  uint32_t version = 0u;
+  size_t pos = sizeof(cloud_file::kMagic) + sizeof(version);
+  if (mapped_size_ >= pos) {
+    std::memcpy(&version, data_ + sizeof(cloud_file::kMagic), sizeof(version));
+  }
+  if (version != cloud_file::kVersion) {
+    LOG(ERROR) << "'" << file_name << "' is not a cloud file of version "
+               << cloud_file::kVersion << ".";
+    return;
+  }
+
+  // Walk the chunk headers.
+  while (mapped_size_ - pos >= sizeof(cloud_file::ChunkHeader)) {
+    Frame frame;
+    std::memcpy(&frame.header, data_ + pos, sizeof(frame.header));
+    pos += sizeof(frame.header);
+    if (frame.header.magic != cloud_file::kChunkMagic ||
+        mapped_size_ - pos < frame.header.payload_size) {
+      LOG(WARNING) << "Corrupted or truncated chunk in '" << file_name
+                   << "' after " << frames_.size() << " frames.";
+      break;
+    }
+    frame.cloud_id = frame.header.cloud_id;
+    frame.begin = pos;
+    frame.end = pos + frame.header.payload_size;
+    frame.num_points = frame.header.num_points;
+    frames_.push_back(frame);
+    pos = frame.end;
+  }
+}
+
+void MappedCloudReader::indexCsvFrames() {
+  // Skip the headers, then start a new frame whenever the cloud id changes.
+  const char* end = data_ + mapped_size_;
+  const char* line = findLineEnd(data_, end) + 1;
+  while (line < end) {
+    const char* line_end = findLineEnd(line, end);
+    int cloud_id;
+    if (!isEmptyLine(line, line_end) &&
+        std::from_chars(line, line_end, cloud_id).ec == std::errc()) {
+      if (frames_.empty() || frames_.back().cloud_id != cloud_id) {
+        if (!frames_.empty()) {
+          frames_.back().end = line - data_;
+        }
+        frames_.emplace_back();
+        frames_.back().cloud_id = cloud_id;
+        frames_.back().begin = line - data_;
+      }
+      frames_.back().num_points++;
+    }
+    line = line_end + 1;
+  }
+  if (!frames_.empty()) {
+    frames_.back().end = mapped_size_;
+  }
+}
+
+bool MappedCloudReader::readFrame(const size_t index, Cloud& cloud,
+                                  CloudInfo& cloud_info,
+                                  Clusters& clusters) const {
+  if (index >= frames_.size()) {
+    return false;
+  }
+  const Frame& frame = frames_[index];
+  if (is_binary_) {
+    return cloud_file::decodeFrame(
+        frame.header, reinterpret_cast<const uint8_t*>(data_ + frame.begin),
+        frame.end - frame.begin, cloud, cloud_info, clusters);
+  }
+  return parseCsvFrame(frame, cloud, cloud_info, clusters);
+}
+
+bool MappedCloudReader::parseCsvFrame(const Frame& frame, Cloud& cloud,
+                                      CloudInfo& cloud_info,
+                                      Clusters& clusters) const {
+  cloud.clear();
+  cloud.reserve(frame.num_points);
+  cloud_info.points.clear();
+  cloud_info.points.reserve(frame.num_points);
+  cloud_info.has_labels = true;
+  cloud_info.timestamp = 0u;
+  clusters.clear();
+  std::unordered_map<int, size_t> cluster_id_to_index;
+
+  const char* end = data_ + frame.end;
+  const char* line = data_ + frame.begin;
+  while (line < end) {
+    const char* line_end = findLineEnd(line, end);
+    if (isEmptyLine(line, line_end)) {
+      line = line_end + 1;
+      continue;
+    }
+
+    // Columns: CloudNo,X,Y,Z,Distance,PointDynamic,ClusterDynamic,
+    // ObjectDynamic,GTDynamic,ReadyForEvaluation,ClusterID.
+    const char* pos = line;
+    int cloud_id;
+    int cluster_id;
+    float distance;
+    Point point;
+    PointInfo info;
+    if (!parseField(pos, line_end, &cloud_id) ||
+        !parseField(pos, line_end, &point.x) ||
+        !parseField(pos, line_end, &point.y) ||
+        !parseField(pos, line_end, &point.z) ||
+        !parseField(pos, line_end, &distance) ||
+        !parseField(pos, line_end, &info.ever_free_level_dynamic) ||
+        !parseField(pos, line_end, &info.cluster_level_dynamic) ||
+        !parseField(pos, line_end, &info.object_level_dynamic) ||
+        !parseField(pos, line_end, &info.ground_truth_dynamic) ||
+        !parseField(pos, line_end, &info.ready_for_evaluation) ||
+        !parseField(pos, line_end, &cluster_id)) {
+      LOG(ERROR) << "Could not parse line '" << std::string(line, line_end)
+                 << "'.";
+      return false;
+    }
+    info.distance_to_sensor = distance;
+    cloud.push_back(point);
+    cloud_info.points.push_back(info);
+    line = line_end + 1;
+
+    // Rebuild the clusters of cluster-dynamic points.
+    if (!info.cluster_level_dynamic) {
+      continue;
+    }
+    auto it = cluster_id_to_index.find(cluster_id);
+    if (it == cluster_id_to_index.end()) {
+      Cluster& cluster = clusters.emplace_back();
+      cluster.id = cluster_id;
+      cluster.valid = true;
+      it = cluster_id_to_index.emplace(cluster_id, clusters.size() - 1u).first;
+    }
+    clusters[it->second].points.push_back(cloud.size() - 1u);
+  }
+  return true;
+}
+
+bool MappedCloudReader::readAllFrames(std::vector<Cloud>& clouds,
+                                      std::vector<CloudInfo>& cloud_infos,
+                                      std::vector<Clusters>& clusters,
+                                      const int num_threads) const {
+  const size_t offset = clouds.size();
+  clouds.resize(offset + frames_.size());
+  cloud_infos.resize(offset + frames_.size());
+  clusters.resize(offset + frames_.size());
+
+  std::vector<size_t> indices(frames_.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    indices[i] = i;
+  }
+  IndexGetter<size_t> index_getter(indices);
+  std::atomic<bool> success = true;
+  std::vector<std::future<void>> threads;
+  for (int i = 0; i < std::max(num_threads, 1); ++i) {
+    threads.emplace_back(std::async(std::launch::async, [&]() {
+      size_t index;
+      while (index_getter.getNextIndex(&index)) {
+        if (!readFrame(index, clouds[offset + index],
+                       cloud_infos[offset + index],
+                       clusters[offset + index])) {
+          LOG(ERROR) << "Could not read frame " << index << ".";
+          success = false;
+        }
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.get();
+  }
+  return success;
+}
+
+}  // namespace dynablox
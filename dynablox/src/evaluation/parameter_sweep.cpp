@@ -0,0 +1,356 @@
+#include "dynablox/evaluation/parameter_sweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+
+#include <glog/logging.h>
+
+#include "dynablox/common/index_getter.h"
+#include "dynablox/evaluation/evaluator.h"
+#include "dynablox/evaluation/mapped_cloud_reader.h"
+
+namespace dynablox {
+
+namespace {
+
+// Write the header of the metrics of all levels as written by
+// Evaluator::writeMetrics().
+void writeLevelsHeader(std::ostream& output) {
+  for (int level_id = 0; level_id < LabelPlanes::kNumLevels; ++level_id) {
+    const std::string level =
+        LabelPlanes::levelToString(static_cast<LabelPlanes::Level>(level_id));
+    output << "," << level + "_IoU," << level + "_Precision,"
+           << level + "_Recall," << level + "_TP," << level + "_TN,"
+           << level + "_FP," << level + "_FN";
+  }
+}
+
+bool readPoses(const std::string& file_name, std::vector<std::uint64_t>& stamps,
+               std::vector<tf::Transform>& poses) {
+  std::ifstream file(file_name);
+  if (!file.is_open()) {
+    LOG(ERROR) << "Could not open poses file '" << file_name << "'.";
+    return false;
+  }
+
+  // Columns: Timestamp,X,Y,Z,QX,QY,QZ,QW.
+  std::string line;
+  std::getline(file, line);
+  while (std::getline(file, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::stringstream stream(line);
+    std::string field;
+    std::vector<double> values;
+    std::uint64_t stamp;
+    try {
+      std::getline(stream, field, ',');
+      stamp = std::stoull(field);
+      while (std::getline(stream, field, ',')) {
+        values.push_back(std::stod(field));
+      }
+    } catch (const std::exception&) {
+      values.clear();
+    }
+    if (values.size() != 7u) {
+      LOG(ERROR) << "Could not parse pose '" << line << "'.";
+      return false;
+    }
+    stamps.push_back(stamp);
+    poses.emplace_back(
+        tf::Quaternion(values[3], values[4], values[5], values[6]),
+        tf::Vector3(values[0], values[1], values[2]));
+  }
+  return true;
+}
+
+}  // namespace
+
+void ParameterSweep::Config::checkParams() const {
+  checkParamCond(!sequence_directory.empty(),
+                 "'sequence_directory' must be set.");
+  checkParamCond(!output_directory.empty(), "'output_directory' must be set.");
+  checkParamGT(num_parallel_runs, 0, "num_parallel_runs");
+  checkParamGT(threads_per_run, 0, "threads_per_run");
+  checkParamGE(max_frames, 0, "max_frames");
+  checkParamGE(min_range, 0.f, "min_range");
+  checkParamCond(max_range > min_range,
+                 "'max_range' must be larger than 'min_range'.");
+}
+
+void ParameterSweep::Config::setupParamsAndPrinting() {
+  setupParam("sequence_directory", &sequence_directory);
+  setupParam("output_directory", &output_directory);
+  setupParam("num_parallel_runs", &num_parallel_runs);
+  setupParam("threads_per_run", &threads_per_run);
+  setupParam("max_frames", &max_frames);
+  setupParam("min_range", &min_range, "m");
+  setupParam("max_range", &max_range, "m");
+}
+
+ParameterSweep::ParameterSweep(const Config& config,
+                               const ParamMap& base_params,
+                               const std::vector<Axis>& axes)
+    : config_(config.checkValid()), axes_(axes) {
+  size_t num_runs = 1u;
+  for (const Axis& axis : axes_) {
+    num_runs *= axis.values.size();
+  }
+
+  // Enumerate the grid with the last axis varying fastest.
+  runs_.resize(num_runs);
+  std::set<std::string> printed_configs;
+  for (size_t index = 0; index < num_runs; ++index) {
+    Run& run = runs_[index];
+    ParamMap params = base_params;
+    size_t remainder = index;
+    run.values.resize(axes_.size());
+    for (size_t i = axes_.size(); i-- > 0;) {
+      const Axis& axis = axes_[i];
+      run.values[i] = axis.values[remainder % axis.values.size()];
+      remainder /= axis.values.size();
+      params[axis.name] = parseParamValue(run.values[i]);
+    }
+    run.config = getConfigFromParamMap<DetectionPipeline::Config>(params);
+    run.config.num_threads = config_.threads_per_run;
+    run.config.checkValid();
+    printed_configs.insert(run.config.toString());
+  }
+  LOG_IF(WARNING, printed_configs.size() < runs_.size())
+      << "Some runs of the sweep have identical configs, check the names of "
+         "the swept parameters.";
+}
+
+bool ParameterSweep::run() {
+  if (!loadSequence(config_.sequence_directory, config_.max_frames,
+                    config_.num_parallel_runs, sequence_)) {
+    return false;
+  }
+
+  // Set up the output of all runs.
+  for (size_t index = 0; index < runs_.size(); ++index) {
+    const std::string directory = getRunDirectory(index);
+    std::filesystem::create_directories(directory);
+    std::ofstream config_file(directory + "/config.txt", std::ios::trunc);
+    config_file << runs_[index].config.toString() << std::endl;
+  }
+  LOG(INFO) << "Processing " << runs_.size() << " runs on "
+            << sequence_.size() << " frames.";
+
+  // Process the runs in parallel.
+  std::vector<size_t> indices(runs_.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    indices[i] = i;
+  }
+  IndexGetter<size_t> index_getter(indices);
+  std::atomic<size_t> num_finished = 0u;
+  std::vector<std::future<void>> threads;
+  const size_t num_threads =
+      std::min<size_t>(config_.num_parallel_runs, runs_.size());
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back(std::async(std::launch::async, [&]() {
+      size_t index;
+      while (index_getter.getNextIndex(&index)) {
+        processRun(index);
+        LOG(INFO) << "Finished run " << ++num_finished << " of "
+                  << runs_.size() << ".";
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.get();
+  }
+
+  bool success = writeSummary();
+  for (const Run& run : runs_) {
+    success &= run.success;
+  }
+  return success;
+}
+
+void ParameterSweep::processRun(const size_t index) {
+  Run& run = runs_[index];
+  std::unique_ptr<DetectionPipeline> pipeline;
+  {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    pipeline = std::make_unique<DetectionPipeline>(run.config);
+  }
+
+  std::ofstream scores_file(getRunDirectory(index) + "/scores.csv",
+                            std::ios::trunc);
+  scores_file << "timestamp";
+  writeLevelsHeader(scores_file);
+  scores_file << ",EvaluatedPoints,TotalPoints\n";
+
+  CloudInfo cloud_info;
+  for (size_t i = 0; i < sequence_.size(); ++i) {
+    cloud_info = sequence_.cloud_infos[i];
+    const auto start = std::chrono::steady_clock::now();
+    pipeline->processFrame(sequence_.poses[i], sequence_.clouds[i],
+                           cloud_info);
+    run.processing_time += std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    if (!cloud_info.has_labels) {
+      continue;
+    }
+
+    // Score the frame as the Evaluator does.
+    for (PointInfo& point : cloud_info.points) {
+      point.ready_for_evaluation =
+          point.distance_to_sensor >= config_.min_range &&
+          point.distance_to_sensor <= config_.max_range;
+    }
+    const LabelPlanes planes(cloud_info);
+    const LabelPlanes::Counts counts = planes.count();
+    scores_file << cloud_info.timestamp;
+    for (int level = 0; level < LabelPlanes::kNumLevels; ++level) {
+      const ConfusionCounts& level_counts = counts.total[level];
+      Evaluator::writeMetrics(level_counts, scores_file);
+      ConfusionCounts& total = run.counts[level];
+      total.tp += level_counts.tp;
+      total.fp += level_counts.fp;
+      total.tn += level_counts.tn;
+      total.fn += level_counts.fn;
+    }
+    scores_file << "," << planes.getNumberOfEvaluatedPoints() << ","
+                << cloud_info.points.size() << "\n";
+    run.num_evaluated_frames++;
+  }
+  run.success = scores_file.good();
+
+  std::lock_guard<std::mutex> lock(config_mutex_);
+  pipeline.reset();
+}
+
+std::string ParameterSweep::getRunDirectory(const size_t index) const {
+  return config_.output_directory + "/run_" + std::to_string(index);
+}
+
+bool ParameterSweep::writeSummary() const {
+  const std::string file_name = config_.output_directory + "/sweep.csv";
+  std::ofstream file(file_name, std::ios::trunc);
+  if (!file.is_open()) {
+    LOG(ERROR) << "Could not write '" << file_name << "'.";
+    return false;
+  }
+
+  // One line per run with the swept values and the scores of all frames.
+  file << "Run";
+  for (const Axis& axis : axes_) {
+    file << "," << axis.name.substr(axis.name.find_first_not_of('/'));
+  }
+  writeLevelsHeader(file);
+  file << ",EvaluatedFrames,MeanFrameTime\n";
+  for (size_t index = 0; index < runs_.size(); ++index) {
+    const Run& run = runs_[index];
+    file << index;
+    for (const std::string& value : run.values) {
+      file << "," << value;
+    }
+    for (const ConfusionCounts& counts : run.counts) {
+      Evaluator::writeMetrics(counts, file);
+    }
+    file << "," << run.num_evaluated_frames << ","
+         << (sequence_.size() > 0u ? run.processing_time / sequence_.size()
+                                   : 0.0)
+         << "\n";
+  }
+  LOG(INFO) << "Wrote the summary of " << runs_.size() << " runs to '"
+            << file_name << "'.";
+  return file.good();
+}
+
+bool ParameterSweep::loadSequence(const std::string& directory,
+                                  const int max_frames, const int num_threads,
+                                  SweepSequence& sequence) {
+  // Clouds, preferring the binary format.
+  std::string clouds_file = directory + "/clouds.bin";
+  if (!std::filesystem::exists(clouds_file)) {
+    clouds_file = directory + "/clouds.csv";
+  }
+  const MappedCloudReader reader(clouds_file);
+  std::vector<Clusters> clusters;
+  if (!reader.isOpen() || reader.getNumberOfFrames() == 0u ||
+      !reader.readAllFrames(sequence.clouds, sequence.cloud_infos, clusters,
+                            num_threads)) {
+    LOG(ERROR) << "Could not read the clouds of '" << directory << "'.";
+    return false;
+  }
+  if (max_frames > 0 &&
+      sequence.clouds.size() > static_cast<size_t>(max_frames)) {
+    sequence.clouds.resize(max_frames);
+    sequence.cloud_infos.resize(max_frames);
+  }
+
+  // Poses, matched by timestamp if available.
+  std::vector<std::uint64_t> stamps;
+  std::vector<tf::Transform> poses;
+  if (!readPoses(directory + "/poses.csv", stamps, poses)) {
+    return false;
+  }
+  std::unordered_map<std::uint64_t, size_t> stamp_to_pose;
+  for (size_t i = 0; i < stamps.size(); ++i) {
+    stamp_to_pose[stamps[i]] = i;
+  }
+  const bool match_by_order = std::any_of(
+      sequence.cloud_infos.begin(), sequence.cloud_infos.end(),
+      [&](const CloudInfo& cloud_info) {
+        return stamp_to_pose.find(cloud_info.timestamp) == stamp_to_pose.end();
+      });
+  if (match_by_order && poses.size() < sequence.size()) {
+    LOG(ERROR) << "Could not match the " << sequence.size()
+               << " clouds to the " << poses.size() << " poses of '"
+               << directory << "'.";
+    return false;
+  }
+  LOG_IF(WARNING, match_by_order)
+      << "Not all clouds have a pose with the same timestamp, matching them "
+         "by order.";
+
+  // Start all runs from unlabeled scans.
+  sequence.poses.resize(sequence.size());
+  for (size_t i = 0; i < sequence.size(); ++i) {
+    CloudInfo& cloud_info = sequence.cloud_infos[i];
+    const tf::Transform& T_M_S =
+        match_by_order ? poses[i] : poses[stamp_to_pose[cloud_info.timestamp]];
+    sequence.poses[i] = T_M_S;
+    cloud_info.sensor_position.x = T_M_S.getOrigin().x();
+    cloud_info.sensor_position.y = T_M_S.getOrigin().y();
+    cloud_info.sensor_position.z = T_M_S.getOrigin().z();
+    for (PointInfo& point : cloud_info.points) {
+      point.ever_free_level_dynamic = false;
+      point.cluster_level_dynamic = false;
+      point.object_level_dynamic = false;
+      point.ready_for_evaluation = false;
+      point.processed = true;
+    }
+  }
+  LOG(INFO) << "Loaded " << sequence.size() << " frames from '" << directory
+            << "'.";
+  return true;
+}
+
+std::vector<std::string> ParameterSweep::splitValues(
+    const std::string& values) {
+  std::vector<std::string> result;
+  std::stringstream stream(values);
+  std::string value;
+  while (std::getline(stream, value, ',')) {
+    if (!value.empty()) {
+      result.push_back(value);
+    }
+  }
+  return result;
+}
+
+}  // namespace dynablox
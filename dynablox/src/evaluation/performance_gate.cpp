@@ -0,0 +1,340 @@
+#include "dynablox/evaluation/performance_gate.h"
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <regex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "dynablox/common/latency_metrics.h"
+#include "dynablox/common/stage_timer.h"
+#include "dynablox/evaluation/parameter_sweep.h"
+#include "dynablox/processing/preprocessing.h"
+
+namespace dynablox {
+
+using Timer = StageTimer;
+
+namespace {
+
+// Version of the JSON schema, increase on incompatible changes.
+constexpr int kSchemaVersion = 1;
+
+}  // namespace
+
+void PerformanceGate::Config::checkParams() const {
+  checkParamCond(!baseline_file.empty(), "'baseline_file' must be set.");
+  checkParamGE(max_frames, 0, "max_frames");
+  checkParamGE(warmup_frames, 0, "warmup_frames");
+  checkParamCond(compared_statistic == "mean" || compared_statistic == "p50" ||
+                     compared_statistic == "p95",
+                 "'compared_statistic' must be 'mean', 'p50', or 'p95'.");
+  checkParamGE(tolerance, 0.f, "tolerance");
+  checkParamGE(min_difference_ms, 0.f, "min_difference_ms");
+  checkParamConfig(scene_config);
+  checkParamConfig(pipeline_config);
+}
+
+void PerformanceGate::Config::setupParamsAndPrinting() {
+  setupParam("baseline_file", &baseline_file);
+  setupParam("output_file", &output_file);
+  setupParam("update_baseline", &update_baseline);
+  setupParam("sequence_directory", &sequence_directory);
+  setupParam("max_frames", &max_frames);
+  setupParam("warmup_frames", &warmup_frames, "frames");
+  setupParam("compared_statistic", &compared_statistic);
+  setupParam("tolerance", &tolerance);
+  setupParam("min_difference_ms", &min_difference_ms, "ms");
+  setupParam("scene", &scene_config, "scene");
+  setupParam("pipeline", &pipeline_config, "pipeline");
+}
+
+PerformanceGate::Config::Config() {
+  setConfigName("PerformanceGate");
+
+  // Short sequence, processed single threaded for stable timings.
+  scene_config.num_frames = 50;
+  pipeline_config.num_threads = 1;
+
+  // Sensor model of the default synthetic lidar.
+  EverFreeTsdfIntegrator::Config& tsdf_config =
+      pipeline_config.tsdf_integrator_config;
+  tsdf_config.sensor_horizontal_resolution = scene_config.num_columns;
+  tsdf_config.sensor_vertical_resolution = scene_config.num_rings;
+  tsdf_config.sensor_vertical_field_of_view_degrees =
+      scene_config.max_elevation - scene_config.min_elevation;
+}
+
+PerformanceGate::PerformanceGate(const Config& config)
+    : config_(config.checkValid()) {}
+
+int PerformanceGate::run() {
+  Statistics current;
+  if (!runWorkload(current)) {
+    return 2;
+  }
+  if (!config_.output_file.empty() &&
+      !writeStatistics(current, config_.output_file)) {
+    return 2;
+  }
+
+  // Read the baseline.
+  Statistics baseline;
+  std::ifstream baseline_file(config_.baseline_file);
+  const bool has_baseline =
+      baseline_file.is_open() && readJson(baseline_file, baseline);
+  if (config_.update_baseline) {
+    // Keep the tolerances set for single stages.
+    for (auto& [stage, statistics] : current) {
+      const auto it = baseline.find(stage);
+      if (it != baseline.end()) {
+        statistics.tolerance = it->second.tolerance;
+      }
+    }
+    return writeStatistics(current, config_.baseline_file) ? 0 : 2;
+  }
+  if (!has_baseline) {
+    LOG(ERROR) << "Could not read the baseline '" << config_.baseline_file
+               << "', create it with '--update_baseline=true'.";
+    return 2;
+  }
+
+  // Compare.
+  std::stringstream report;
+  const bool passed = compare(baseline, current, report);
+  std::cout << report.str() << std::flush;
+  if (!passed) {
+    LOG(ERROR) << "Performance regressed or stages are missing w.r.t. '"
+               << config_.baseline_file << "'.";
+    return 1;
+  }
+  LOG(INFO) << "No performance regressions w.r.t. '" << config_.baseline_file
+            << "'.";
+  return 0;
+}
+
+bool PerformanceGate::runWorkload(Statistics& statistics) const {
+  // Set up all frames first, so only the processing is timed.
+  std::vector<SyntheticFrame> frames;
+  SweepSequence sequence;
+  const bool synthetic = config_.sequence_directory.empty();
+  if (synthetic) {
+    const SceneGenerator generator(config_.scene_config);
+    frames.reserve(config_.scene_config.num_frames);
+    for (int i = 0; i < config_.scene_config.num_frames; ++i) {
+      frames.push_back(generator.generateFrame(i));
+    }
+  } else if (!ParameterSweep::loadSequence(
+                 config_.sequence_directory, config_.max_frames,
+                 std::thread::hardware_concurrency(), sequence)) {
+    return false;
+  }
+  const size_t num_frames = synthetic ? frames.size() : sequence.size();
+  if (num_frames <= static_cast<size_t>(config_.warmup_frames)) {
+    LOG(ERROR) << "The workload has only " << num_frames
+               << " frames, which are all used for warmup.";
+    return false;
+  }
+
+  // Process the workload as the MotionDetector does.
+  const Preprocessing preprocessing((Preprocessing::Config()));
+  DetectionPipeline pipeline(config_.pipeline_config);
+  // The statistics cover all frames after the warmup: the window spans the
+  // whole run and is never rotated, since no metrics are exported.
+  LatencyMetrics::Config metrics_config;
+  metrics_config.output_directory = "";
+  metrics_config.window_duration = std::numeric_limits<float>::max();
+  metrics_config.window_slices = 1;
+  LatencyMetrics::setup(metrics_config);
+  for (size_t i = 0; i < num_frames; ++i) {
+    if (i == static_cast<size_t>(config_.warmup_frames)) {
+      metrics_config.enable = true;
+      LatencyMetrics::setup(metrics_config);
+    }
+    Timer detection_timer("motion_detection");
+    if (synthetic) {
+      const SyntheticFrame& frame = frames[i];
+      Timer preprocessing_timer("motion_detection/preprocessing");
+      Cloud cloud = frame.cloud;
+      CloudInfo cloud_info;
+      preprocessing.processPointcloud(frame.timestamp, frame.T_M_S, cloud,
+                                      cloud_info);
+      preprocessing_timer.Stop();
+      pipeline.processFrame(frame.T_M_S, cloud, cloud_info);
+    } else {
+      CloudInfo cloud_info = sequence.cloud_infos[i];
+      pipeline.processFrame(sequence.poses[i], sequence.clouds[i],
+                            cloud_info);
+    }
+    detection_timer.Stop();
+  }
+
+  // Collect the statistics of all stages.
+  statistics.clear();
+  for (const auto& [stage, summary] : LatencyMetrics::getSummaries()) {
+    if (summary.count == 0u) {
+      continue;
+    }
+    StageStatistics& stage_statistics = statistics[stage];
+    stage_statistics.count = summary.count;
+    stage_statistics.mean = summary.sum / summary.count * 1e3;
+    stage_statistics.p50 = summary.p50 * 1e3;
+    stage_statistics.p95 = summary.p95 * 1e3;
+    stage_statistics.max = summary.max * 1e3;
+  }
+  metrics_config.enable = false;
+  LatencyMetrics::setup(metrics_config);
+  return true;
+}
+
+bool PerformanceGate::compare(const Statistics& baseline,
+                              const Statistics& current,
+                              std::ostream& report) const {
+  bool passed = true;
+  report << std::fixed << std::setprecision(3) << std::left
+         << std::setw(48) << "Stage" << std::right << std::setw(12)
+         << "Baseline" << std::setw(12) << "Current" << std::setw(10)
+         << "Change"
+         << "  Status [" << config_.compared_statistic << ", ms]\n";
+  for (const auto& [stage, baseline_statistics] : baseline) {
+    const auto it = current.find(stage);
+    if (it == current.end()) {
+      // A stage that stopped running can not be compared, so it fails.
+      report << std::left << std::setw(48) << stage << std::right
+             << "  MISSING in this run\n";
+      passed = false;
+      continue;
+    }
+    const double baseline_value = getComparedValue(baseline_statistics);
+    const double value = getComparedValue(it->second);
+    const double difference = value - baseline_value;
+    const double change =
+        baseline_value > 0.0 ? difference / baseline_value : 0.0;
+    const double tolerance = baseline_statistics.tolerance >= 0.0
+                                 ? baseline_statistics.tolerance
+                                 : config_.tolerance;
+
+    // Only differences above both thresholds count.
+    std::string status = "ok";
+    if (difference > config_.min_difference_ms && change > tolerance) {
+      status = "REGRESSION";
+      passed = false;
+    } else if (-difference > config_.min_difference_ms && -change > tolerance) {
+      status = "improved";
+    }
+    if (it->second.count != baseline_statistics.count) {
+      status += ", count " + std::to_string(baseline_statistics.count) +
+                " -> " + std::to_string(it->second.count);
+    }
+    report << std::left << std::setw(48) << stage << std::right
+           << std::setw(12) << baseline_value << std::setw(12) << value
+           << std::setw(9) << change * 100.0 << "%  " << status << "\n";
+  }
+  for (const auto& [stage, statistics] : current) {
+    if (baseline.find(stage) == baseline.end()) {
+      report << std::left << std::setw(48) << stage << std::right
+             << std::setw(12) << "-" << std::setw(12)
+             << getComparedValue(statistics) << "  new stage\n";
+    }
+  }
+  return passed;
+}
+
+double PerformanceGate::getComparedValue(
+    const StageStatistics& statistics) const {
+  if (config_.compared_statistic == "p50") {
+    return statistics.p50;
+  } else if (config_.compared_statistic == "p95") {
+    return statistics.p95;
+  }
+  return statistics.mean;
+}
+
+bool PerformanceGate::writeStatistics(const Statistics& statistics,
+                                      const std::string& file_name) const {
+  std::ofstream file(file_name, std::ios::trunc);
+  writeJson(statistics, file);
+  if (!file.good()) {
+    LOG(ERROR) << "Could not write the statistics to '" << file_name << "'.";
+    return false;
+  }
+  LOG(INFO) << "Wrote the statistics of " << statistics.size()
+            << " stages to '" << file_name << "'.";
+  return true;
+}
+
+void PerformanceGate::writeJson(const Statistics& statistics,
+                                std::ostream& output) {
+  // One stage per line, sorted by name.
+  output << std::fixed << std::setprecision(4);
+  output << "{\n  \"schema_version\": " << kSchemaVersion
+         << ",\n  \"unit\": \"ms\",\n  \"stages\": {";
+  bool first = true;
+  for (const auto& [stage, stage_statistics] : statistics) {
+    output << (first ? "\n" : ",\n") << "    \"" << stage
+           << "\": {\"count\": " << stage_statistics.count
+           << ", \"mean\": " << stage_statistics.mean
+           << ", \"p50\": " << stage_statistics.p50
+           << ", \"p95\": " << stage_statistics.p95
+           << ", \"max\": " << stage_statistics.max;
+    if (stage_statistics.tolerance >= 0.0) {
+      output << ", \"tolerance\": " << stage_statistics.tolerance;
+    }
+    output << "}";
+    first = false;
+  }
+  output << "\n  }\n}\n";
+}
+
+bool PerformanceGate::readJson(std::istream& input, Statistics& statistics) {
+  // Reads the line based layout written by writeJson().
+  static const std::regex version_regex("\"schema_version\":\\s*(\\d+)");
+  static const std::regex stage_regex("^\\s*\"([^\"]+)\":\\s*\\{(.*)\\}");
+  static const std::regex value_regex("\"(\\w+)\":\\s*([-+0-9.eE]+)");
+  statistics.clear();
+  int version = -1;
+  std::string line;
+  std::smatch match;
+  while (std::getline(input, line)) {
+    if (std::regex_search(line, match, version_regex)) {
+      version = std::stoi(match[1]);
+      continue;
+    }
+    if (!std::regex_search(line, match, stage_regex)) {
+      continue;
+    }
+    StageStatistics& stage_statistics = statistics[match[1]];
+    const std::string values = match[2];
+    for (auto it = std::sregex_iterator(values.begin(), values.end(),
+                                        value_regex);
+         it != std::sregex_iterator(); ++it) {
+      const std::string key = (*it)[1];
+      const double value = std::stod((*it)[2]);
+      if (key == "count") {
+        stage_statistics.count = static_cast<uint64_t>(value);
+      } else if (key == "mean") {
+        stage_statistics.mean = value;
+      } else if (key == "p50") {
+        stage_statistics.p50 = value;
+      } else if (key == "p95") {
+        stage_statistics.p95 = value;
+      } else if (key == "max") {
+        stage_statistics.max = value;
+      } else if (key == "tolerance") {
+        stage_statistics.tolerance = value;
+      }
+    }
+  }
+  if (version != kSchemaVersion) {
+    LOG(ERROR) << "Expected statistics of schema version " << kSchemaVersion
+               << ", got " << version << ".";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace dynablox
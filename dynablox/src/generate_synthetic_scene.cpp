@@ -0,0 +1,32 @@
+// Headless generator of synthetic dynamic scenes. Usage:
+//   generate_synthetic_scene --output_directory=<dir> [--<param>=<value> ...]
+// All SceneGenerator::Config params can be set, e.g. '--num_frames=200'.
+
+#include <iostream>
+#include <string>
+
+#include <glog/logging.h>
+
+#include "dynablox/common/command_line_config.h"
+#include "dynablox/simulation/scene_generator.h"
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  const dynablox::ParamMap params = dynablox::getParamMapFromArgs(argc, argv);
+  const auto output_directory = params.find("/output_directory");
+  if (output_directory == params.end()) {
+    std::cerr << "Usage: " << argv[0]
+              << " --output_directory=<dir> [--<param>=<value> ...]"
+              << std::endl;
+    return 1;
+  }
+
+  const auto config =
+      dynablox::getConfigFromParamMap<dynablox::SceneGenerator::Config>(params);
+  LOG(INFO) << "\n" << config.toString();
+  const dynablox::SceneGenerator generator(config);
+  XmlRpc::XmlRpcValue directory = output_directory->second;
+  return generator.writeSequence(static_cast<std::string>(directory)) ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+#include "dynablox/map/block_eviction.h"
+
+#include <utility>
+
+#include <voxblox/utils/timing.h>
+
+#include "dynablox/common/stage_timer.h"
+
+namespace dynablox {
+
+using Timer = StageTimer;
+
+void BlockEviction::Config::checkParams() const {
+  checkParamGE(eviction_radius, 0.f, "eviction_radius");
+  checkParamGE(max_unobserved_frames, 0, "max_unobserved_frames");
+  checkParamGT(max_evictions_per_frame, 0, "max_evictions_per_frame");
+  checkParamGT(check_every_n_frames, 0, "check_every_n_frames");
+  checkParamConfig(block_store_config);
+  if (!block_store_config.file_path.empty() && eviction_radius > 0.f) {
+    checkParamCond(block_store_config.reload_radius < eviction_radius,
+                   "'block_store.reload_radius' must be smaller than "
+                   "'eviction_radius'.");
+  }
+  if (!block_store_config.file_path.empty()) {
+    checkParamCond(block_store_config.reload_radius >=
+                       block_store_config.max_allocation_distance,
+                   "'block_store.reload_radius' must be at least "
+                   "'block_store.max_allocation_distance' (max ray length "
+                   "plus truncation distance plus 1.5 block diagonals), else "
+                   "newly allocated blocks shadow stored ones.");
+  }
+}
+
+void BlockEviction::Config::setupParamsAndPrinting() {
+  setupParam("eviction_radius", &eviction_radius, "m");
+  setupParam("max_unobserved_frames", &max_unobserved_frames, "frames");
+  setupParam("max_evictions_per_frame", &max_evictions_per_frame);
+  setupParam("check_every_n_frames", &check_every_n_frames, "frames");
+  setupParam("block_store", &block_store_config, "block_store");
+}
+
+BlockEviction::BlockEviction(const Config& config, TsdfLayer::Ptr tsdf_layer,
+                             EverFreeLayer::Ptr ever_free_layer)
+    : config_(config.checkValid()),
+      tsdf_layer_(std::move(tsdf_layer)),
+      ever_free_layer_(std::move(ever_free_layer)),
+      block_size_(tsdf_layer_->block_size()),
+      eviction_radius_squared_(config_.eviction_radius *
+                               config_.eviction_radius) {
+  if (config_.isEnabled() && !config_.block_store_config.file_path.empty()) {
+    block_store_ = std::make_unique<BlockStore>(config_.block_store_config,
+                                                tsdf_layer_, ever_free_layer_);
+  }
+}
+
+voxblox::BlockIndexList BlockEviction::evictBlocks(
+    const Point& sensor_position, const int frame_counter) {
+  voxblox::BlockIndexList evicted_blocks;
+  if (!config_.isEnabled()) {
+    return evicted_blocks;
+  }
+
+  // Search for new candidates once the previous ones are processed.
+  if (candidates_.empty() &&
+      frame_counter - last_check_frame_ >= config_.check_every_n_frames) {
+    Timer candidates_timer("block_eviction/find_candidates");
+    findCandidates(sensor_position, frame_counter);
+    last_check_frame_ = frame_counter;
+  }
+
+  // Evict candidates within the budget. The sensor may have moved since they
+  // were found so re-check the criteria.
+  Timer evict_timer("block_eviction/evict");
+  while (!candidates_.empty() &&
+         evicted_blocks.size() <
+             static_cast<size_t>(config_.max_evictions_per_frame)) {
+    const BlockIndex block_index = candidates_.front();
+    candidates_.pop_front();
+    if (!shouldEvict(block_index, sensor_position, frame_counter)) {
+      continue;
+    }
+    if (block_store_) {
+      block_store_->storeBlock(block_index);
+    }
+    tsdf_layer_->removeBlock(block_index);
+    ever_free_layer_->removeBlock(block_index);
+    evicted_blocks.push_back(block_index);
+  }
+  return evicted_blocks;
+}
+
+voxblox::BlockIndexList BlockEviction::reloadBlocks(
+    const Point& sensor_position) {
+  if (!block_store_) {
+    return voxblox::BlockIndexList();
+  }
+  return block_store_->reloadBlocks(sensor_position);
+}
+
+bool BlockEviction::shouldEvict(const BlockIndex& block_index,
+                                const Point& sensor_position,
+                                const int frame_counter) const {
+  if (config_.eviction_radius > 0.f) {
+    const voxblox::Point center =
+        voxblox::getCenterPointFromGridIndex(block_index, block_size_);
+    const voxblox::Point sensor(sensor_position.x, sensor_position.y,
+                                sensor_position.z);
+    if ((center - sensor).squaredNorm() > eviction_radius_squared_) {
+      return true;
+    }
+  }
+  if (config_.max_unobserved_frames > 0) {
+    // Blocks without ever-free data were allocated by the last integration.
+    EverFreeBlock::ConstPtr ever_free_block =
+        ever_free_layer_->getBlockPtrByIndex(block_index);
+    if (ever_free_block && frame_counter - ever_free_block->getLastObserved() >
+                               config_.max_unobserved_frames) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void BlockEviction::findCandidates(const Point& sensor_position,
+                                   const int frame_counter) {
+  voxblox::BlockIndexList blocks;
+  tsdf_layer_->getAllAllocatedBlocks(&blocks);
+  for (const BlockIndex& block_index : blocks) {
+    if (shouldEvict(block_index, sensor_position, frame_counter)) {
+      candidates_.push_back(block_index);
+    }
+  }
+}
+
+}  // namespace dynablox
@@ -0,0 +1,185 @@
+#include "dynablox/map/block_store.h"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include <voxblox/utils/timing.h>
+
+#include "dynablox/common/stage_timer.h"
+
+namespace dynablox {
+
+using Timer = StageTimer;
+
+void BlockStore::Config::checkParams() const {
+  checkParamGE(reload_radius, 0.f, "reload_radius");
+  checkParamGE(max_allocation_distance, 0.f, "max_allocation_distance");
+}
+
+void BlockStore::Config::setupParamsAndPrinting() {
+  setupParam("file_path", &file_path);
+  setupParam("reload_radius", &reload_radius, "m");
+  setupParam("max_allocation_distance", &max_allocation_distance, "m");
+}
+
+BlockStore::BlockStore(const Config& config, TsdfLayer::Ptr tsdf_layer,
+                       EverFreeLayer::Ptr ever_free_layer)
+    : config_(config.checkValid()),
+      tsdf_layer_(std::move(tsdf_layer)),
+      ever_free_layer_(std::move(ever_free_layer)),
+      block_size_(tsdf_layer_->block_size()) {
+  file_.open(config_.file_path, std::ios::in | std::ios::out |
+                                    std::ios::binary | std::ios::trunc);
+  if (!file_.is_open()) {
+    LOG(ERROR) << "Could not open block store '" << config_.file_path << "'.";
+  }
+}
+
+bool BlockStore::storeBlock(const BlockIndex& block_index) {
+  TsdfBlock::ConstPtr tsdf_block =
+      tsdf_layer_->getBlockPtrByIndex(block_index);
+  if (!tsdf_block || !file_.is_open()) {
+    return false;
+  }
+
+  // Serialize the block. Ever-free blocks are missing for blocks that were
+  // allocated by the last integration only.
+  std::vector<uint32_t> tsdf_data;
+  tsdf_block->serializeToIntegers(&tsdf_data);
+  std::vector<uint8_t> ever_free_data;
+  EverFreeBlock::ConstPtr ever_free_block =
+      ever_free_layer_->getBlockPtrByIndex(block_index);
+  if (ever_free_block) {
+    ever_free_block->serializeToBytes(&ever_free_data);
+  }
+
+  // Write the record into the slot of the previous record of the block if it
+  // fits, otherwise reuse a free slot or append.
+  RecordHeader header;
+  header.index[0] = block_index.x();
+  header.index[1] = block_index.y();
+  header.index[2] = block_index.z();
+  header.num_tsdf_words = tsdf_data.size();
+  header.num_ever_free_bytes = ever_free_data.size();
+  const size_t size = sizeof(header) + tsdf_data.size() * sizeof(uint32_t) +
+                      ever_free_data.size();
+  Slot slot{file_end_, size};
+  const auto it = index_.find(block_index);
+  if (it != index_.end() && it->second.capacity >= size) {
+    slot = it->second;
+  } else {
+    const auto free_slot = free_slots_.lower_bound(size);
+    if (free_slot != free_slots_.end()) {
+      slot = {free_slot->second, free_slot->first};
+      free_slots_.erase(free_slot);
+    }
+  }
+  file_.seekp(slot.offset);
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file_.write(reinterpret_cast<const char*>(tsdf_data.data()),
+              tsdf_data.size() * sizeof(uint32_t));
+  file_.write(reinterpret_cast<const char*>(ever_free_data.data()),
+              ever_free_data.size());
+  if (!file_.good()) {
+    LOG(ERROR) << "Failed to write block to '" << config_.file_path << "'.";
+    file_.clear();
+    return false;
+  }
+  if (slot.offset == file_end_) {
+    file_end_ += size;
+  }
+  if (it == index_.end()) {
+    index_.emplace(block_index, slot);
+  } else {
+    if (it->second.offset != slot.offset) {
+      free_slots_.emplace(it->second.capacity, it->second.offset);
+    }
+    it->second = slot;
+  }
+  return true;
+}
+
+bool BlockStore::loadBlock(const BlockIndex& block_index) {
+  const auto it = index_.find(block_index);
+  if (it == index_.end()) {
+    return false;
+  }
+
+  // Read the record.
+  RecordHeader header;
+  file_.seekg(it->second.offset);
+  file_.read(reinterpret_cast<char*>(&header), sizeof(header));
+  std::vector<uint32_t> tsdf_data(header.num_tsdf_words);
+  file_.read(reinterpret_cast<char*>(tsdf_data.data()),
+             tsdf_data.size() * sizeof(uint32_t));
+  std::vector<uint8_t> ever_free_data(header.num_ever_free_bytes);
+  file_.read(reinterpret_cast<char*>(ever_free_data.data()),
+             ever_free_data.size());
+  if (!file_.good()) {
+    LOG(ERROR) << "Failed to read block from '" << config_.file_path << "'.";
+    file_.clear();
+    return false;
+  }
+
+  // Insert the blocks into the map. Mark the TSDF block as updated so all
+  // dependent data is recomputed.
+  TsdfBlock::Ptr tsdf_block = tsdf_layer_->allocateBlockPtrByIndex(block_index);
+  tsdf_block->deserializeFromIntegers(tsdf_data);
+  tsdf_block->set_has_data(true);
+  tsdf_block->updated().set();
+  if (!ever_free_data.empty()) {
+    EverFreeBlock::Ptr ever_free_block =
+        ever_free_layer_->allocateBlockPtrByIndex(block_index);
+    if (!ever_free_block->deserializeFromBytes(ever_free_data)) {
+      LOG(WARNING) << "Stored ever-free block has unexpected size, dropping.";
+      ever_free_layer_->removeBlock(block_index);
+    }
+  }
+  return true;
+}
+
+voxblox::BlockIndexList BlockStore::reloadBlocks(const Point& sensor_position) {
+  voxblox::BlockIndexList loaded_blocks;
+  const voxblox::Point sensor(sensor_position.x, sensor_position.y,
+                              sensor_position.z);
+  const BlockIndex sensor_block =
+      voxblox::getGridIndexFromPoint<BlockIndex>(sensor, 1.f / block_size_);
+  if (index_.empty() ||
+      (has_last_sensor_block_ && sensor_block == last_sensor_block_)) {
+    return loaded_blocks;
+  }
+  last_sensor_block_ = sensor_block;
+  has_last_sensor_block_ = true;
+
+  // Check all blocks within the reload radius. This is bounded by the radius
+  // rather than the number of stored blocks.
+  Timer reload_timer("block_store/reload");
+  const int radius_in_blocks =
+      static_cast<int>(std::ceil(config_.reload_radius / block_size_));
+  const float radius_squared = config_.reload_radius * config_.reload_radius;
+  BlockIndex block_index;
+  for (int x = -radius_in_blocks; x <= radius_in_blocks; ++x) {
+    for (int y = -radius_in_blocks; y <= radius_in_blocks; ++y) {
+      for (int z = -radius_in_blocks; z <= radius_in_blocks; ++z) {
+        block_index = sensor_block + BlockIndex(x, y, z);
+        if (!index_.count(block_index) ||
+            tsdf_layer_->getBlockPtrByIndex(block_index)) {
+          continue;
+        }
+        const voxblox::Point center =
+            voxblox::getCenterPointFromGridIndex(block_index, block_size_);
+        if ((center - sensor).squaredNorm() > radius_squared) {
+          continue;
+        }
+        if (loadBlock(block_index)) {
+          loaded_blocks.push_back(block_index);
+        }
+      }
+    }
+  }
+  return loaded_blocks;
+}
+
+}  // namespace dynablox
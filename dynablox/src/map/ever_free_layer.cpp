@@ -0,0 +1,168 @@
+#include "dynablox/map/ever_free_layer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dynablox {
+
+namespace {
+
+// The observed state is stored in the flag byte of serialized blocks.
+constexpr uint8_t kSerializedObserved = 1u << 3;
+
+}  // namespace
+
+EverFreeBlock::EverFreeBlock(size_t voxels_per_side)
+    : voxels_per_side_(voxels_per_side),
+      num_voxels_(voxels_per_side * voxels_per_side * voxels_per_side),
+      flags_(num_voxels_, 0u),
+      observed_(num_voxels_, 0u),
+      occupancy_counter_(num_voxels_, 0u),
+      last_occupied_(num_voxels_, 0u),
+      last_lidar_occupied_(num_voxels_, 0u) {}
+
+void EverFreeBlock::setOccupancyCounter(const size_t linear_index,
+                                        const int value) {
+  occupancy_counter_[linear_index] =
+      static_cast<uint8_t>(std::clamp(value, 0, kMaxOccupancyCounter));
+}
+
+void EverFreeBlock::shiftFrameOrigin(const int frame) {
+  // Leave half the stamp range for future frames.
+  const int new_origin = frame - kMaxStamp / 2;
+  const int shift = new_origin - frame_origin_;
+  frame_origin_ = new_origin;
+  auto shift_stamp = [shift](Stamp& stamp) {
+    stamp = static_cast<Stamp>(std::max(static_cast<int>(stamp) - shift, 0));
+  };
+  std::for_each(last_occupied_.begin(), last_occupied_.end(), shift_stamp);
+  std::for_each(last_lidar_occupied_.begin(), last_lidar_occupied_.end(),
+                shift_stamp);
+}
+
+std::vector<uint32_t> EverFreeBlock::takeDirtyVoxels() {
+  std::vector<uint32_t> result;
+  result.swap(dirty_voxels_);
+  for (const uint32_t linear_index : result) {
+    clearFlag(linear_index, kDirty);
+  }
+  return result;
+}
+
+void EverFreeBlock::serializeToBytes(std::vector<uint8_t>* data) const {
+  const size_t stamps_size = num_voxels_ * sizeof(Stamp);
+  data->resize(2 * sizeof(int32_t) + 2 * num_voxels_ + 2 * stamps_size);
+  uint8_t* ptr = data->data();
+  const int32_t header[2] = {frame_origin_, last_observed_};
+  std::memcpy(ptr, header, sizeof(header));
+  ptr += sizeof(header);
+  for (size_t i = 0; i < num_voxels_; ++i) {
+    ptr[i] = flags_[i] | (observed_[i] ? kSerializedObserved : 0u);
+  }
+  ptr += num_voxels_;
+  std::memcpy(ptr, occupancy_counter_.data(), num_voxels_);
+  ptr += num_voxels_;
+  std::memcpy(ptr, last_occupied_.data(), stamps_size);
+  ptr += stamps_size;
+  std::memcpy(ptr, last_lidar_occupied_.data(), stamps_size);
+}
+
+bool EverFreeBlock::deserializeFromBytes(const std::vector<uint8_t>& data) {
+  const size_t stamps_size = num_voxels_ * sizeof(Stamp);
+  if (data.size() != 2 * sizeof(int32_t) + 2 * num_voxels_ + 2 * stamps_size) {
+    return false;
+  }
+  const uint8_t* ptr = data.data();
+  int32_t header[2];
+  std::memcpy(header, ptr, sizeof(header));
+  frame_origin_ = header[0];
+  last_observed_ = header[1];
+  ptr += sizeof(header);
+  for (size_t i = 0; i < num_voxels_; ++i) {
+    observed_[i] = (ptr[i] & kSerializedObserved) ? 1u : 0u;
+    flags_[i] = ptr[i] & static_cast<uint8_t>(~kSerializedObserved);
+  }
+  ptr += num_voxels_;
+  std::memcpy(occupancy_counter_.data(), ptr, num_voxels_);
+  ptr += num_voxels_;
+  std::memcpy(last_occupied_.data(), ptr, stamps_size);
+  ptr += stamps_size;
+  std::memcpy(last_lidar_occupied_.data(), ptr, stamps_size);
+
+  // Rebuild the transient dirty state. The TSDF occupied voxels are rebuilt by
+  // the integrator.
+  tsdf_occupied_voxels_.clear();
+  tsdf_occupied_voxels_valid_ = false;
+  dirty_voxels_.clear();
+  for (size_t i = 0; i < num_voxels_; ++i) {
+    clearFlag(i, kDirty | kNewlyObserved);
+    if (hasFlag(i, kBurnIn)) {
+      markDirty(i);
+    }
+  }
+  return true;
+}
+
+size_t EverFreeBlock::getMemorySize() const {
+  return sizeof(EverFreeBlock) + flags_.capacity() + observed_.capacity() +
+         occupancy_counter_.capacity() +
+         (last_occupied_.capacity() + last_lidar_occupied_.capacity()) *
+             sizeof(Stamp) +
+         (dirty_voxels_.capacity() + tsdf_occupied_voxels_.capacity()) *
+             sizeof(uint32_t);
+}
+
+EverFreeLayer::EverFreeLayer(size_t voxels_per_side)
+    : voxels_per_side_(voxels_per_side) {}
+
+EverFreeBlock::Ptr EverFreeLayer::getBlockPtrByIndex(const BlockIndex& index) {
+  auto it = block_map_.find(index);
+  if (it == block_map_.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+EverFreeBlock::ConstPtr EverFreeLayer::getBlockPtrByIndex(
+    const BlockIndex& index) const {
+  auto it = block_map_.find(index);
+  if (it == block_map_.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+EverFreeBlock::Ptr EverFreeLayer::allocateBlockPtrByIndex(
+    const BlockIndex& index) {
+  EverFreeBlock::Ptr& block = block_map_[index];
+  if (!block) {
+    block = std::make_shared<EverFreeBlock>(voxels_per_side_);
+  }
+  return block;
+}
+
+void EverFreeLayer::removeBlock(const BlockIndex& index) {
+  block_map_.erase(index);
+}
+
+void EverFreeLayer::removeAllBlocks() { block_map_.clear(); }
+
+void EverFreeLayer::getAllAllocatedBlocks(
+    voxblox::BlockIndexList* blocks) const {
+  CHECK_NOTNULL(blocks);
+  blocks->clear();
+  blocks->reserve(block_map_.size());
+  for (const auto& index_block_pair : block_map_) {
+    blocks->emplace_back(index_block_pair.first);
+  }
+}
+
+size_t EverFreeLayer::getMemorySize() const {
+  size_t size = 0u;
+  for (const auto& index_block_pair : block_map_) {
+    size += index_block_pair.second->getMemorySize();
+  }
+  return size;
+}
+
+}  // namespace dynablox
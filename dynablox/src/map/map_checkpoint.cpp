@@ -0,0 +1,246 @@
+#include "dynablox/map/map_checkpoint.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "dynablox/common/allocation_counter.h"
+#include "dynablox/common/index_getter.h"
+
+namespace dynablox {
+
+namespace {
+
+constexpr char kMagic[8] = {'D', 'B', 'L', 'X', 'M', 'A', 'P', '\0'};
+constexpr uint32_t kVersion = 1;
+
+// Voxblox serializes each TSDF voxel into distance, weight, and color words.
+constexpr size_t kTsdfWordsPerVoxel = 3;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  float voxel_size;
+  uint32_t voxels_per_side;
+  int32_t frame_counter;
+  uint64_t num_blocks;
+};
+
+struct IndexEntry {
+  int32_t index[3];
+  uint32_t num_tsdf_words;
+  uint64_t offset;
+  uint64_t num_ever_free_bytes;
+};
+
+}  // namespace
+
+bool saveMapCheckpoint(const std::string& file_name,
+                       const TsdfLayer& tsdf_layer,
+                       const EverFreeLayer& ever_free_layer,
+                       const int frame_counter) {
+  std::ofstream file(file_name, std::ios::out | std::ios::binary);
+  if (!file.is_open()) {
+    LOG(ERROR) << "Could not open checkpoint file '" << file_name << "'.";
+    return false;
+  }
+
+  // Serialize all blocks.
+  voxblox::BlockIndexList blocks;
+  tsdf_layer.getAllAllocatedBlocks(&blocks);
+  std::vector<std::vector<uint32_t>> tsdf_data(blocks.size());
+  std::vector<std::vector<uint8_t>> ever_free_data(blocks.size());
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    tsdf_layer.getBlockByIndex(blocks[i]).serializeToIntegers(&tsdf_data[i]);
+    EverFreeBlock::ConstPtr ever_free_block =
+        ever_free_layer.getBlockPtrByIndex(blocks[i]);
+    if (ever_free_block) {
+      ever_free_block->serializeToBytes(&ever_free_data[i]);
+    }
+  }
+
+  // Header.
+  FileHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.voxel_size = tsdf_layer.voxel_size();
+  header.voxels_per_side = tsdf_layer.voxels_per_side();
+  header.frame_counter = frame_counter;
+  header.num_blocks = blocks.size();
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  // Index table.
+  uint64_t offset = sizeof(FileHeader) + blocks.size() * sizeof(IndexEntry);
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    IndexEntry entry;
+    entry.index[0] = blocks[i].x();
+    entry.index[1] = blocks[i].y();
+    entry.index[2] = blocks[i].z();
+    entry.num_tsdf_words = tsdf_data[i].size();
+    entry.offset = offset;
+    entry.num_ever_free_bytes = ever_free_data[i].size();
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    offset += tsdf_data[i].size() * sizeof(uint32_t) + ever_free_data[i].size();
+  }
+
+  // Records.
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    file.write(reinterpret_cast<const char*>(tsdf_data[i].data()),
+               tsdf_data[i].size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(ever_free_data[i].data()),
+               ever_free_data[i].size());
+  }
+  if (!file.good()) {
+    LOG(ERROR) << "Failed to write checkpoint file '" << file_name << "'.";
+    return false;
+  }
+  return true;
+}
+
+bool loadMapCheckpoint(const std::string& file_name, TsdfLayer& tsdf_layer,
+                       EverFreeLayer& ever_free_layer, int& frame_counter,
+                       const int num_threads) {
+  // Map the file.
+  const int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG(ERROR) << "Could not open checkpoint file '" << file_name << "'.";
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) < sizeof(FileHeader)) {
+    LOG(ERROR) << "Checkpoint file '" << file_name << "' is too small.";
+    close(fd);
+    return false;
+  }
+  const size_t file_size = file_stat.st_size;
+  void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    LOG(ERROR) << "Could not map checkpoint file '" << file_name << "'.";
+    return false;
+  }
+  const char* data = static_cast<const char*>(mapped);
+  auto unmap = [&]() { munmap(mapped, file_size); };
+
+  // Check the header.
+  FileHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion) {
+    LOG(ERROR) << "'" << file_name << "' is not a valid map checkpoint.";
+    unmap();
+    return false;
+  }
+  if (std::abs(header.voxel_size - tsdf_layer.voxel_size()) > 1e-6 ||
+      header.voxels_per_side != tsdf_layer.voxels_per_side()) {
+    LOG(ERROR) << "Checkpoint voxel size (" << header.voxel_size << ", "
+               << header.voxels_per_side
+               << ") does not match the map configuration.";
+    unmap();
+    return false;
+  }
+  if (header.num_blocks >
+      (file_size - sizeof(FileHeader)) / sizeof(IndexEntry)) {
+    LOG(ERROR) << "Checkpoint file '" << file_name << "' is truncated.";
+    unmap();
+    return false;
+  }
+
+  // Read the index and allocate all blocks single threaded.
+  const size_t num_tsdf_words = kTsdfWordsPerVoxel *
+                                tsdf_layer.voxels_per_side() *
+                                tsdf_layer.voxels_per_side() *
+                                tsdf_layer.voxels_per_side();
+  std::vector<IndexEntry> entries(header.num_blocks);
+  std::memcpy(entries.data(), data + sizeof(FileHeader),
+              entries.size() * sizeof(IndexEntry));
+  std::vector<size_t> ids;
+  ids.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const IndexEntry& entry = entries[i];
+    const uint64_t tsdf_bytes =
+        static_cast<uint64_t>(entry.num_tsdf_words) * sizeof(uint32_t);
+    if (entry.offset > file_size || tsdf_bytes > file_size - entry.offset ||
+        entry.num_ever_free_bytes > file_size - entry.offset - tsdf_bytes) {
+      LOG(WARNING) << "Skipping truncated block in checkpoint.";
+      continue;
+    }
+    if (entry.num_tsdf_words != num_tsdf_words) {
+      LOG(WARNING) << "Skipping block with " << entry.num_tsdf_words
+                   << " TSDF words in checkpoint, expected " << num_tsdf_words
+                   << ".";
+      continue;
+    }
+    const BlockIndex block_index(entry.index[0], entry.index[1],
+                                 entry.index[2]);
+    tsdf_layer.allocateBlockPtrByIndex(block_index);
+    if (entry.num_ever_free_bytes > 0) {
+      ever_free_layer.allocateBlockPtrByIndex(block_index);
+    }
+    ids.push_back(i);
+  }
+
+  // Deserialize the blocks in parallel. Blocks are not marked as updated, they
+  // are unchanged with respect to the checkpoint.
+  IndexGetter<size_t> index_getter(ids);
+  AllocationCounter::StageCounts* const worker_allocations =
+      AllocationCounter::getWorkerCounts();
+  std::vector<std::future<bool>> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back(std::async(std::launch::async, [&]() {
+      const AllocationCounter::WorkerScope allocation_scope(worker_allocations);
+      bool success = true;
+      size_t id;
+      std::vector<uint32_t> tsdf_data;
+      std::vector<uint8_t> ever_free_data;
+      while (index_getter.getNextIndex(&id)) {
+        const IndexEntry& entry = entries[id];
+        const BlockIndex block_index(entry.index[0], entry.index[1],
+                                     entry.index[2]);
+        const char* record = data + entry.offset;
+        tsdf_data.resize(entry.num_tsdf_words);
+        std::memcpy(tsdf_data.data(), record,
+                    tsdf_data.size() * sizeof(uint32_t));
+        TsdfBlock::Ptr tsdf_block = tsdf_layer.getBlockPtrByIndex(block_index);
+        tsdf_block->deserializeFromIntegers(tsdf_data);
+        tsdf_block->set_has_data(true);
+        if (entry.num_ever_free_bytes > 0) {
+          record += tsdf_data.size() * sizeof(uint32_t);
+          ever_free_data.assign(record, record + entry.num_ever_free_bytes);
+          if (!ever_free_layer.getBlockPtrByIndex(block_index)
+                   ->deserializeFromBytes(ever_free_data)) {
+            success = false;
+          }
+        }
+      }
+      return success;
+    }));
+  }
+  bool success = true;
+  for (auto& thread : threads) {
+    success &= thread.get();
+  }
+  unmap();
+  if (!success) {
+    LOG(ERROR) << "Checkpoint file '" << file_name
+               << "' contains invalid ever-free blocks.";
+    return false;
+  }
+
+  frame_counter = header.frame_counter;
+  LOG(INFO) << "Loaded " << ids.size() << " blocks from checkpoint '"
+            << file_name << "'.";
+  return true;
+}
+
+}  // namespace dynablox
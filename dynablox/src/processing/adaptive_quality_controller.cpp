@@ -0,0 +1,128 @@
+#include "dynablox/processing/adaptive_quality_controller.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include <voxblox/utils/timing.h>
+
+namespace dynablox {
+
+using Timing = voxblox::timing::Timing;
+
+void AdaptiveQualityController::Config::checkParams() const {
+  checkParamGE(frame_budget, 0.f, "frame_budget");
+  checkParamCond(!frame_timer.empty(), "'frame_timer' may not be empty.");
+  checkParamGT(smoothing_factor, 0.f, "smoothing_factor");
+  checkParamLE(smoothing_factor, 1.f, "smoothing_factor");
+  checkParamGT(restore_ratio, 0.f, "restore_ratio");
+  checkParamCond(degrade_ratio > restore_ratio,
+                 "'degrade_ratio' must be larger than 'restore_ratio'.");
+  checkParamGE(hold_frames, 0, "hold_frames");
+  checkParamGE(max_level, static_cast<int>(kFullQuality), "max_level");
+  checkParamLE(max_level, static_cast<int>(kReduceRange), "max_level");
+  checkParamGE(point_decimation, 1, "point_decimation");
+  checkParamGT(reduced_max_range, 0.f, "reduced_max_range");
+}
+
+void AdaptiveQualityController::Config::setupParamsAndPrinting() {
+  setupParam("frame_budget", &frame_budget, "s");
+  setupParam("frame_timer", &frame_timer);
+  setupParam("stage_timers", &stage_timers);
+  setupParam("smoothing_factor", &smoothing_factor);
+  setupParam("degrade_ratio", &degrade_ratio);
+  setupParam("restore_ratio", &restore_ratio);
+  setupParam("hold_frames", &hold_frames);
+  setupParam("max_level", &max_level);
+  setupParam("point_decimation", &point_decimation);
+  setupParam("reduced_max_range", &reduced_max_range, "m");
+}
+
+AdaptiveQualityController::AdaptiveQualityController(const Config& config)
+    : config_(config.checkValid()),
+      last_stage_totals_(config_.stage_timers.size(), 0.0),
+      stage_times_(config_.stage_timers.size(), 0.0) {}
+
+bool AdaptiveQualityController::update() {
+  if (!isEnabled()) {
+    return false;
+  }
+
+  // Get the average duration of all frames finished since the last update.
+  const size_t frame_handle = Timing::GetHandle(config_.frame_timer);
+  const size_t num_frames = Timing::GetNumSamples(frame_handle);
+  if (num_frames <= last_num_frames_) {
+    return false;
+  }
+  const double frame_total = Timing::GetTotalSeconds(frame_handle);
+  const size_t new_frames = num_frames - last_num_frames_;
+  const double frame_time = (frame_total - last_frame_total_) / new_frames;
+  last_num_frames_ = num_frames;
+  last_frame_total_ = frame_total;
+  updateStageTimes(new_frames);
+
+  // Smooth the frame time to not react to single outliers.
+  if (smoothed_frame_time_ <= 0.0) {
+    smoothed_frame_time_ = frame_time;
+  } else {
+    smoothed_frame_time_ = config_.smoothing_factor * frame_time +
+                           (1.0 - config_.smoothing_factor) *
+                               smoothed_frame_time_;
+  }
+
+  // Change at most one level at a time and let the timings settle in between.
+  frames_since_change_ += new_frames;
+  if (frames_since_change_ < config_.hold_frames) {
+    return false;
+  }
+  const int previous_level = level_;
+  if (smoothed_frame_time_ > config_.degrade_ratio * config_.frame_budget) {
+    level_ = std::min(level_ + 1, config_.max_level);
+  } else if (smoothed_frame_time_ <
+             config_.restore_ratio * config_.frame_budget) {
+    level_ = std::max(level_ - 1, static_cast<int>(kFullQuality));
+  }
+  if (level_ == previous_level) {
+    return false;
+  }
+  frames_since_change_ = 0;
+  LOG(INFO) << "Frame time " << smoothed_frame_time_ << "s (budget "
+            << config_.frame_budget << "s), changing quality level from "
+            << previous_level << " to " << level_ << ". " << printStageTimes();
+  return true;
+}
+
+void AdaptiveQualityController::selectPoints(CloudInfo& cloud_info) const {
+  if (level_ < kDecimatePoints) {
+    return;
+  }
+  const bool reduce_range = level_ >= kReduceRange;
+  for (size_t i = 0; i < cloud_info.points.size(); ++i) {
+    PointInfo& info = cloud_info.points[i];
+    if (i % config_.point_decimation != 0 ||
+        (reduce_range &&
+         info.distance_to_sensor > config_.reduced_max_range)) {
+      info.processed = false;
+    }
+  }
+}
+
+void AdaptiveQualityController::updateStageTimes(const size_t num_frames) {
+  for (size_t i = 0; i < config_.stage_timers.size(); ++i) {
+    const double total =
+        Timing::GetTotalSeconds(Timing::GetHandle(config_.stage_timers[i]));
+    stage_times_[i] = (total - last_stage_totals_[i]) / num_frames;
+    last_stage_totals_[i] = total;
+  }
+}
+
+std::string AdaptiveQualityController::printStageTimes() const {
+  std::stringstream ss;
+  ss << "Stage times:";
+  for (size_t i = 0; i < config_.stage_timers.size(); ++i) {
+    ss << " " << config_.stage_timers[i] << "=" << stage_times_[i] << "s";
+  }
+  return ss.str();
+}
+
+}  // namespace dynablox
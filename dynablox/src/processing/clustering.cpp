@@ -30,9 +30,11 @@ void Clustering::Config::setupParamsAndPrinting() {
   setupParam("neighbor_connectivity", &neighbor_connectivity);
 }
 
-Clustering::Clustering(const Config& config, TsdfLayer::Ptr tsdf_layer)
+Clustering::Clustering(const Config& config, TsdfLayer::Ptr tsdf_layer,
+                       EverFreeLayer::Ptr ever_free_layer)
     : config_(config.checkValid()),
       tsdf_layer_(std::move(tsdf_layer)),
+      ever_free_layer_(std::move(ever_free_layer)),
       neighborhood_search_(config.neighbor_connectivity) {}
 
 Clusters Clustering::performClustering(
@@ -40,7 +42,7 @@ Clusters Clustering::performClustering(
     const ClusterIndices& occupied_ever_free_voxel_indices,
     const int frame_counter, const Cloud& cloud, CloudInfo& cloud_info) const {
   // Cluster all occupied voxels.
-  const std::vector<ClusterIndices> voxel_cluster_indices =
+  const std::pmr::vector<ClusterIndices> voxel_cluster_indices =
       voxelClustering(occupied_ever_free_voxel_indices, frame_counter);
 
   // Group points into clusters.
@@ -60,16 +62,17 @@ Clusters Clustering::performClustering(
   return clusters;
 }
 
-std::vector<Clustering::ClusterIndices> Clustering::voxelClustering(
+std::pmr::vector<Clustering::ClusterIndices> Clustering::voxelClustering(
     const ClusterIndices& occupied_ever_free_voxel_indices,
     const int frame_counter) const {
-  std::vector<ClusterIndices> voxel_cluster_indices;
+  std::pmr::vector<ClusterIndices> voxel_cluster_indices(
+      occupied_ever_free_voxel_indices.get_allocator());
 
   // Process all newly occupied ever-free voxels as potential cluster seeds.
   for (const voxblox::VoxelKey& voxel_key : occupied_ever_free_voxel_indices) {
-    ClusterIndices cluster;
+    ClusterIndices cluster(occupied_ever_free_voxel_indices.get_allocator());
     if (growCluster(voxel_key, frame_counter, cluster)) {
-      voxel_cluster_indices.push_back(cluster);
+      voxel_cluster_indices.push_back(std::move(cluster));
     }
   }
   return voxel_cluster_indices;
@@ -78,55 +81,61 @@ std::vector<Clustering::ClusterIndices> Clustering::voxelClustering(
 bool Clustering::growCluster(const voxblox::VoxelKey& seed,
                              const int frame_counter,
                              ClusterIndices& result) const {
-  std::vector<voxblox::VoxelKey> stack = {seed};
+  std::pmr::vector<voxblox::VoxelKey> stack({seed}, result.get_allocator());
+  voxblox::AlignedVector<voxblox::VoxelKey> neighbors;
   const size_t voxels_per_side = tsdf_layer_->voxels_per_side();
 
   while (!stack.empty()) {
     // Get the voxel.
     const voxblox::VoxelKey voxel_key = stack.back();
     stack.pop_back();
-    TsdfBlock::Ptr tsdf_block =
-        tsdf_layer_->getBlockPtrByIndex(voxel_key.first);
-    if (!tsdf_block) {
+    EverFreeBlock::Ptr block =
+        ever_free_layer_->getBlockPtrByIndex(voxel_key.first);
+    if (!block) {
       continue;
     }
-    TsdfVoxel& tsdf_voxel = tsdf_block->getVoxelByVoxelIndex(voxel_key.second);
+    const size_t index =
+        block->computeLinearIndexFromVoxelIndex(voxel_key.second);
 
     // Process every voxel only once.
-    if (tsdf_voxel.clustering_processed) {
+    if (block->hasFlag(index, EverFreeBlock::kClusteringProcessed)) {
       continue;
     }
 
     // Add voxel to cluster.
-    tsdf_voxel.dynamic = true;
-    tsdf_voxel.clustering_processed = true;
+    block->setFlag(index, EverFreeBlock::kDynamic |
+                              EverFreeBlock::kClusteringProcessed);
     result.push_back(voxel_key);
+    const bool voxel_is_ever_free =
+        block->hasFlag(index, EverFreeBlock::kEverFree);
 
     // Extend cluster to neighbor voxels.
-    const voxblox::AlignedVector<voxblox::VoxelKey> neighbors =
-        neighborhood_search_.search(voxel_key.first, voxel_key.second,
-                                    voxels_per_side);
+    neighborhood_search_.search(voxel_key.first, voxel_key.second,
+                                voxels_per_side, &neighbors);
 
     for (const voxblox::VoxelKey& neighbor_key : neighbors) {
-      TsdfBlock::Ptr neighbor_block =
-          tsdf_layer_->getBlockPtrByIndex(neighbor_key.first);
+      EverFreeBlock::Ptr neighbor_block =
+          ever_free_layer_->getBlockPtrByIndex(neighbor_key.first);
       if (!neighbor_block) {
         continue;
       }
-      TsdfVoxel& neighbor_voxel =
-          neighbor_block->getVoxelByVoxelIndex(neighbor_key.second);
+      const size_t neighbor_index =
+          neighbor_block->computeLinearIndexFromVoxelIndex(neighbor_key.second);
 
       // If neighbor is valid add it to the cluster, and potentially keep
       // growing if it is ever-free.
-      if (!neighbor_voxel.clustering_processed &&
-          neighbor_voxel.last_lidar_occupied == frame_counter) {
-        if (neighbor_voxel.ever_free ||
-            (tsdf_voxel.ever_free && config_.grow_clusters_twice)) {
+      if (!neighbor_block->hasFlag(neighbor_index,
+                                   EverFreeBlock::kClusteringProcessed) &&
+          neighbor_block->getLastLidarOccupied(neighbor_index) ==
+              frame_counter) {
+        if (neighbor_block->hasFlag(neighbor_index, EverFreeBlock::kEverFree) ||
+            (voxel_is_ever_free && config_.grow_clusters_twice)) {
           stack.push_back(neighbor_key);
         } else {
           // Add voxel to cluster.
-          neighbor_voxel.dynamic = true;
-          neighbor_voxel.clustering_processed = true;
+          neighbor_block->setFlag(neighbor_index,
+                                  EverFreeBlock::kDynamic |
+                                      EverFreeBlock::kClusteringProcessed);
           result.push_back(neighbor_key);
         }
       }
@@ -137,13 +146,13 @@ bool Clustering::growCluster(const voxblox::VoxelKey& seed,
 
 Clusters Clustering::inducePointClusters(
     const BlockToPointMap& point_map,
-    const std::vector<ClusterIndices>& voxel_cluster_indices) const {
-  Clusters candidates;
+    const std::pmr::vector<ClusterIndices>& voxel_cluster_indices) const {
+  Clusters candidates(point_map.get_allocator());
   const int voxels_per_side = tsdf_layer_->voxels_per_side();
   const float voxel_size = tsdf_layer_->voxel_size();
 
   for (const auto& voxel_cluster : voxel_cluster_indices) {
-    Cluster candidate_cluster;
+    Cluster candidate_cluster(candidates.get_allocator());
     for (const voxblox::VoxelKey& voxel_key : voxel_cluster) {
       // Find the block.
       auto block_it = point_map.find(voxel_key.first);
@@ -171,7 +180,7 @@ Clusters Clustering::inducePointClusters(
         candidate_cluster.points.push_back(point_index);
       }
     }
-    candidates.push_back(candidate_cluster);
+    candidates.push_back(std::move(candidate_cluster));
   }
   return candidates;
 }
@@ -182,7 +191,7 @@ void Clustering::computeAABB(const Cloud& cloud, Cluster& cluster) const {
   }
   Point& min = cluster.aabb.min_corner;
   Point& max = cluster.aabb.max_corner;
-  if (config_.check_cluster_separation_exact) {
+  if (checkSeparationExact()) {
     // Compute the exact AABB from points.
     min = cloud[cluster.points[0]];
     max = cloud[cluster.points[0]];
@@ -245,7 +254,7 @@ void Clustering::mergeClusters(const Cloud& cloud, Clusters& clusters) const {
 
       // Compute minimum distance between all points in both clusters.
       bool distance_met = false;
-      if (config_.check_cluster_separation_exact) {
+      if (checkSeparationExact()) {
         // Compute distances for all points in both clusters.
         for (const int point_1 : first_cluster.points) {
           for (const int point_2 : second_cluster.points) {
@@ -0,0 +1,243 @@
+#include "dynablox/processing/detection_pipeline.h"
+
+#include <cmath>
+#include <utility>
+
+#include <voxblox/utils/timing.h>
+
+#include "dynablox/common/stage_timer.h"
+
+namespace dynablox {
+
+using Timer = StageTimer;
+
+void DetectionPipeline::Config::checkParams() const {
+  checkParamGT(voxel_size, 0.f, "voxel_size");
+  checkParamGT(voxels_per_side, 0, "voxels_per_side");
+  checkParamGE(num_threads, 1, "num_threads");
+  checkParamCond(integration_exclusion_level == "none" ||
+                     integration_exclusion_level == "ever_free" ||
+                     integration_exclusion_level == "cluster" ||
+                     integration_exclusion_level == "object",
+                 "'integration_exclusion_level' must be 'none', 'ever_free', "
+                 "'cluster', or 'object'.");
+  checkParamCond(voxblox_integrator_method == "simple" ||
+                     voxblox_integrator_method == "merged" ||
+                     voxblox_integrator_method == "fast" ||
+                     voxblox_integrator_method == "projective",
+                 "'voxblox_integrator_method' must be 'simple', 'merged', "
+                 "'fast', or 'projective'.");
+  checkParamGT(max_block_distance_from_body, 0.f,
+               "max_block_distance_from_body");
+  checkParamConfig(point_map_indexer_config);
+  checkParamConfig(clustering_config);
+  checkParamConfig(tracking_config);
+  checkParamConfig(ever_free_integrator_config);
+  checkParamConfig(tsdf_integrator_config);
+}
+
+void DetectionPipeline::Config::setupParamsAndPrinting() {
+  setupParam("voxel_size", &voxel_size, "m");
+  setupParam("voxels_per_side", &voxels_per_side);
+  setupParam("num_threads", &num_threads);
+  setupParam("integration_exclusion_level", &integration_exclusion_level);
+  setupParam("use_ever_free_tsdf_integrator", &use_ever_free_tsdf_integrator);
+  setupParam("voxblox_integrator_method", &voxblox_integrator_method);
+  setupParam("max_block_distance_from_body", &max_block_distance_from_body,
+             "m");
+  setupParam("point_map_indexer", &point_map_indexer_config,
+             "point_map_indexer");
+  setupParam("clustering", &clustering_config, "clustering");
+  setupParam("tracking", &tracking_config, "tracking");
+  setupParam("ever_free_integrator", &ever_free_integrator_config,
+             "ever_free_integrator");
+  setupParam("voxblox", &tsdf_integrator_config, "voxblox");
+}
+
+DetectionPipeline::Config::Config() {
+  setConfigName("DetectionPipeline");
+
+  // Same TSDF as the voxblox server in the default motion detector config.
+  tsdf_integrator_config.truncation_distance = 0.4f;
+  tsdf_integrator_config.max_weight = 1000.f;
+  tsdf_integrator_config.use_const_weight = true;
+  tsdf_integrator_config.min_ray_length_m = 0.5f;
+  tsdf_integrator_config.max_ray_length_m = 20.f;
+  tsdf_integrator_config.sensor_horizontal_resolution = 2048;
+  tsdf_integrator_config.sensor_vertical_resolution = 64;
+  tsdf_integrator_config.sensor_vertical_field_of_view_degrees = 33.22222;
+}
+
+DetectionPipeline::DetectionPipeline(
+    const Config& config, TsdfLayer::Ptr tsdf_layer,
+    EverFreeLayer::Ptr ever_free_layer,
+    const std::optional<voxblox::TsdfIntegratorBase::Config>&
+        voxblox_integrator_config)
+    : config_(config.checkValid()),
+      tsdf_layer_(tsdf_layer ? std::move(tsdf_layer)
+                             : std::make_shared<TsdfLayer>(
+                                   config_.voxel_size,
+                                   config_.voxels_per_side)),
+      ever_free_layer_(ever_free_layer
+                           ? std::move(ever_free_layer)
+                           : std::make_shared<EverFreeLayer>(
+                                 tsdf_layer_->voxels_per_side())) {
+  // All components use the same number of threads.
+  PointMapIndexer::Config indexer_config = config_.point_map_indexer_config;
+  indexer_config.num_threads = config_.num_threads;
+  point_map_indexer_ = std::make_unique<PointMapIndexer>(
+      indexer_config, tsdf_layer_, ever_free_layer_);
+
+  clustering_ = std::make_unique<Clustering>(config_.clustering_config,
+                                             tsdf_layer_, ever_free_layer_);
+  tracking_ = std::make_unique<Tracking>(config_.tracking_config);
+
+  // The ever-free TSDF integrator synchronizes all voxels it updates, else
+  // the ever-free integrator synchronizes them with the TSDF.
+  EverFreeIntegrator::Config ever_free_config =
+      config_.ever_free_integrator_config;
+  ever_free_config.num_threads = config_.num_threads;
+  ever_free_config.synchronize_tsdf = !config_.use_ever_free_tsdf_integrator;
+  ever_free_integrator_ = std::make_shared<EverFreeIntegrator>(
+      ever_free_config, tsdf_layer_, ever_free_layer_);
+
+  EverFreeTsdfIntegrator::Config tsdf_config = config_.tsdf_integrator_config;
+  tsdf_config.integrator_threads = config_.num_threads;
+  if (config_.use_ever_free_tsdf_integrator) {
+    tsdf_integrator_ = std::make_unique<EverFreeTsdfIntegrator>(
+        tsdf_config, tsdf_layer_, ever_free_layer_, ever_free_integrator_);
+    return;
+  }
+
+  if (voxblox_integrator_config) {
+    voxblox_integrator_ = voxblox::TsdfIntegratorFactory::create(
+        config_.voxblox_integrator_method, *voxblox_integrator_config,
+        tsdf_layer_.get());
+    return;
+  }
+
+  // Without a voxblox config, use the settings of the motion detector's TSDF
+  // server, which integrates whole rays up to max_ray_length.
+  voxblox::TsdfIntegratorBase::Config voxblox_config;
+  voxblox_config.default_truncation_distance = tsdf_config.truncation_distance;
+  voxblox_config.max_weight = tsdf_config.max_weight;
+  voxblox_config.voxel_carving_enabled = true;
+  voxblox_config.allow_clear = true;
+  voxblox_config.use_const_weight = tsdf_config.use_const_weight;
+  voxblox_config.min_ray_length_m = tsdf_config.min_ray_length_m;
+  voxblox_config.max_ray_length_m = tsdf_config.max_ray_length_m;
+  voxblox_config.integrator_threads = tsdf_config.integrator_threads;
+  voxblox_config.sensor_horizontal_resolution =
+      tsdf_config.sensor_horizontal_resolution;
+  voxblox_config.sensor_vertical_resolution =
+      tsdf_config.sensor_vertical_resolution;
+  voxblox_config.sensor_vertical_field_of_view_degrees =
+      tsdf_config.sensor_vertical_field_of_view_degrees;
+  voxblox_integrator_ = voxblox::TsdfIntegratorFactory::create(
+      config_.voxblox_integrator_method, voxblox_config, tsdf_layer_.get());
+}
+
+Clusters DetectionPipeline::processFrame(const tf::Transform& T_M_S,
+                                         const Cloud& cloud,
+                                         CloudInfo& cloud_info) {
+  frame_counter_++;
+  TraceRecorder::setFrame(frame_counter_);
+
+  // Build a mapping of all blocks to voxels to points for the scan.
+  Timer setup_timer("motion_detection/indexing_setup");
+  BlockToPointMap point_map(frame_resource_);
+  Clustering::ClusterIndices occupied_ever_free_voxel_indices(frame_resource_);
+  point_map_indexer_->setUpPointMap(cloud, frame_counter_, point_map,
+                                    occupied_ever_free_voxel_indices,
+                                    cloud_info);
+  setup_timer.Stop();
+
+  // Clustering.
+  Timer clustering_timer("motion_detection/clustering");
+  Clusters clusters = clustering_->performClustering(
+      point_map, occupied_ever_free_voxel_indices, frame_counter_, cloud,
+      cloud_info);
+  clustering_timer.Stop();
+  if (memory_monitor_ && memory_monitor_->isEnabled()) {
+    memory_monitor_->recordFrameStructures(point_map, clusters);
+  }
+
+  // Tracking.
+  Timer tracking_timer("motion_detection/tracking");
+  tracking_->track(cloud, clusters, cloud_info);
+  tracking_timer.Stop();
+
+  // Integrate ever-free information.
+  Timer update_ever_free_timer("motion_detection/update_ever_free");
+  ever_free_integrator_->updateEverFreeVoxels(frame_counter_, frame_resource_);
+  update_ever_free_timer.Stop();
+
+  // Integrate the static points into the TSDF map.
+  Timer tsdf_timer("motion_detection/tsdf_integration");
+  integrateStaticPoints(T_M_S, cloud, cloud_info);
+  tsdf_timer.Stop();
+  return clusters;
+}
+
+void DetectionPipeline::integrateStaticPoints(const tf::Transform& T_M_S,
+                                              const Cloud& cloud,
+                                              const CloudInfo& cloud_info) {
+  const tf::Vector3& origin = T_M_S.getOrigin();
+  const tf::Quaternion rotation = T_M_S.getRotation();
+  const voxblox::Transformation T_G_C(
+      Eigen::Quaternionf(rotation.w(), rotation.x(), rotation.y(),
+                         rotation.z()),
+      voxblox::Point(origin.x(), origin.y(), origin.z()));
+
+  // Collect all non-dynamic points and transform them back to sensor frame.
+  const voxblox::Transformation T_C_G = T_G_C.inverse();
+  voxblox::Pointcloud points_C;
+  points_C.reserve(cloud.size());
+  for (size_t i = 0; i < cloud.size(); ++i) {
+    const Point& point = cloud[i];
+    if (!std::isfinite(point.x) || !std::isfinite(point.y) ||
+        !std::isfinite(point.z)) {
+      continue;
+    }
+    const PointInfo& info = cloud_info.points[i];
+    if (!info.processed ||
+        (config_.integration_exclusion_level == "ever_free" &&
+         info.ever_free_level_dynamic) ||
+        (config_.integration_exclusion_level == "cluster" &&
+         info.cluster_level_dynamic) ||
+        (config_.integration_exclusion_level == "object" &&
+         info.object_level_dynamic)) {
+      continue;
+    }
+    points_C.push_back(T_C_G * voxblox::Point(point.x, point.y, point.z));
+  }
+  if (tsdf_integrator_) {
+    tsdf_integrator_->integratePointCloud(T_G_C, points_C, frame_counter_);
+  } else {
+    const voxblox::Colors colors(points_C.size());
+    voxblox_integrator_->integratePointCloud(T_G_C, points_C, colors, false);
+  }
+  removeDistantBlocks(T_G_C.getPosition());
+}
+
+void DetectionPipeline::removeDistantBlocks(
+    const voxblox::Point& sensor_position) {
+  // Same as voxblox's TsdfServer after each integrated scan.
+  if (config_.max_block_distance_from_body >=
+      std::numeric_limits<float>::max()) {
+    return;
+  }
+  const float max_distance_squared = config_.max_block_distance_from_body *
+                                     config_.max_block_distance_from_body;
+  voxblox::BlockIndexList blocks;
+  tsdf_layer_->getAllAllocatedBlocks(&blocks);
+  for (const BlockIndex& block_index : blocks) {
+    if ((tsdf_layer_->getBlockByIndex(block_index).origin() - sensor_position)
+            .squaredNorm() > max_distance_squared) {
+      tsdf_layer_->removeBlock(block_index);
+      ever_free_layer_->removeBlock(block_index);
+    }
+  }
+}
+
+}  // namespace dynablox
@@ -8,10 +8,12 @@
 #include <voxblox/utils/timing.h>
 
 #include "dynablox/common/index_getter.h"
+#include "dynablox/common/stage_timer.h"
+#include "dynablox/common/trace_recorder.h"
 
 namespace dynablox {
 
-using Timer = voxblox::timing::Timer;
+using Timer = StageTimer;
 
 void EverFreeIntegrator::Config::checkParams() const {
   checkParamCond(neighbor_connectivity == 6 || neighbor_connectivity == 18 ||
@@ -19,6 +21,8 @@ void EverFreeIntegrator::Config::checkParams() const {
                  "'neighbor_connectivity' must be 6, 18, or 26.");
   checkParamGE(num_threads, 1, "num_threads");
   checkParamGE(temporal_buffer, 0, "temporal_buffer");
+  checkParamLE(counter_to_reset, EverFreeBlock::kMaxOccupancyCounter,
+               "counter_to_reset");
 }
 
 void EverFreeIntegrator::Config::setupParamsAndPrinting() {
@@ -28,19 +32,23 @@ void EverFreeIntegrator::Config::setupParamsAndPrinting() {
   setupParam("tsdf_occupancy_threshold", &tsdf_occupancy_threshold, "m");
   setupParam("neighbor_connectivity", &neighbor_connectivity);
   setupParam("num_threads", &num_threads);
+  setupParam("synchronize_tsdf", &synchronize_tsdf);
 }
 
 EverFreeIntegrator::EverFreeIntegrator(const EverFreeIntegrator::Config& config,
-                                       TsdfLayer::Ptr tsdf_layer)
+                                       TsdfLayer::Ptr tsdf_layer,
+                                       EverFreeLayer::Ptr ever_free_layer)
     : config_(config.checkValid()),
       tsdf_layer_(std::move(tsdf_layer)),
+      ever_free_layer_(std::move(ever_free_layer)),
       neighborhood_search_(config_.neighbor_connectivity),
       voxel_size_(tsdf_layer_->voxel_size()),
       voxels_per_side_(tsdf_layer_->voxels_per_side()),
       voxels_per_block_(voxels_per_side_ * voxels_per_side_ *
                         voxels_per_side_) {}
 
-void EverFreeIntegrator::updateEverFreeVoxels(const int frame_counter) const {
+void EverFreeIntegrator::updateEverFreeVoxels(
+    const int frame_counter, std::pmr::memory_resource* resource) const {
   // Get all updated blocks. NOTE: we highjack the kESDF flag here for ever-free
   // tracking.
   voxblox::BlockIndexList updated_blocks;
@@ -48,30 +56,34 @@ void EverFreeIntegrator::updateEverFreeVoxels(const int frame_counter) const {
   std::vector<BlockIndex> indices(updated_blocks.size());
   for (size_t i = 0; i < indices.size(); ++i) {
     indices[i] = updated_blocks[i];
+    ever_free_layer_->allocateBlockPtrByIndex(indices[i]);
   }
 
   // Update occupancy counter and calls removeEverFree if warranted in parallel
   // by block.
-  voxblox::AlignedVector<voxblox::VoxelKey> voxels_to_remove;
+  std::pmr::vector<voxblox::VoxelKey> voxels_to_remove(resource);
   std::mutex result_aggregation_mutex;
   IndexGetter<BlockIndex> index_getter(indices);
+  AllocationCounter::StageCounts* const worker_allocations =
+      AllocationCounter::getWorkerCounts();
   std::vector<std::future<void>> threads;
   Timer remove_timer("update_ever_free/remove_occupied");
   for (int i = 0; i < config_.num_threads; ++i) {
     threads.emplace_back(std::async(std::launch::async, [&]() {
+      TraceSpan worker_span("update_ever_free/remove_occupied/worker");
+      const AllocationCounter::WorkerScope allocation_scope(worker_allocations);
       BlockIndex index;
-      voxblox::AlignedVector<voxblox::VoxelKey> local_voxels_to_remove;
+      std::pmr::vector<voxblox::VoxelKey> local_voxels_to_remove(resource);
+      int num_blocks = 0;
 
       // Process all blocks.
       while (index_getter.getNextIndex(&index)) {
-        voxblox::AlignedVector<voxblox::VoxelKey> voxels;
-        if (blockWiseUpdateEverFree(index, frame_counter, voxels)) {
-          local_voxels_to_remove.insert(local_voxels_to_remove.end(),
-                                        voxels.begin(), voxels.end());
-        }
+        ++num_blocks;
+        blockWiseUpdateEverFree(index, frame_counter, local_voxels_to_remove);
       }
 
       // Aggregate results.
+      worker_span.setCount(num_blocks);
       std::lock_guard lock(result_aggregation_mutex);
       voxels_to_remove.insert(voxels_to_remove.end(),
                               local_voxels_to_remove.begin(),
@@ -84,140 +96,254 @@ void EverFreeIntegrator::updateEverFreeVoxels(const int frame_counter) const {
 
   // Remove the remaining voxels single threaded.
   for (const auto& voxel_key : voxels_to_remove) {
-    TsdfBlock::Ptr tsdf_block =
-        tsdf_layer_->getBlockPtrByIndex(voxel_key.first);
-    if (!tsdf_block) {
+    EverFreeBlock::Ptr ever_free_block =
+        ever_free_layer_->getBlockPtrByIndex(voxel_key.first);
+    if (!ever_free_block) {
       continue;
     }
-    TsdfVoxel& tsdf_voxel = tsdf_block->getVoxelByVoxelIndex(voxel_key.second);
-    tsdf_voxel.ever_free = false;
-    tsdf_voxel.dynamic = false;
+    const size_t linear_index =
+        ever_free_block->computeLinearIndexFromVoxelIndex(voxel_key.second);
+    ever_free_block->clearFlag(
+        linear_index, EverFreeBlock::kEverFree | EverFreeBlock::kDynamic);
+    ever_free_block->markDirty(linear_index);
   }
   remove_timer.Stop();
 
-  // Labels tsdf-updated voxels as ever-free if they satisfy the criteria.
-  // Performed blockwise in parallel.
-  index_getter.reset();
-  threads.clear();
+  // Labels dirty voxels as ever-free if they satisfy the criteria. Performed
+  // blockwise in parallel. Voxels in neighboring blocks that need to be
+  // re-checked are marked dirty single threaded and their blocks are processed
+  // in a follow-up round until no more changes propagate.
   Timer label_timer("update_ever_free/label_free");
-  for (int i = 0; i < config_.num_threads; ++i) {
-    threads.emplace_back(std::async(std::launch::async, [&]() {
-      BlockIndex index;
-      while (index_getter.getNextIndex(&index)) {
-        blockWiseMakeEverFree(index, frame_counter);
+  while (!indices.empty()) {
+    voxblox::AlignedVector<voxblox::VoxelKey> voxels_to_check;
+    IndexGetter<BlockIndex> label_index_getter(indices);
+    threads.clear();
+    for (int i = 0; i < config_.num_threads; ++i) {
+      threads.emplace_back(std::async(std::launch::async, [&]() {
+        TraceSpan worker_span("update_ever_free/label_free/worker");
+        const AllocationCounter::WorkerScope allocation_scope(
+            worker_allocations);
+        BlockIndex index;
+        voxblox::AlignedVector<voxblox::VoxelKey> local_voxels_to_check;
+        int num_blocks = 0;
+        while (label_index_getter.getNextIndex(&index)) {
+          ++num_blocks;
+          voxblox::AlignedVector<voxblox::VoxelKey> voxels =
+              blockWiseMakeEverFree(index, frame_counter);
+          local_voxels_to_check.insert(local_voxels_to_check.end(),
+                                       voxels.begin(), voxels.end());
+        }
+
+        // Aggregate results.
+        worker_span.setCount(num_blocks);
+        std::lock_guard lock(result_aggregation_mutex);
+        voxels_to_check.insert(voxels_to_check.end(),
+                               local_voxels_to_check.begin(),
+                               local_voxels_to_check.end());
+      }));
+    }
+    for (auto& thread : threads) {
+      thread.get();
+    }
+
+    // Mark the neighbors in other blocks and collect these blocks.
+    voxblox::IndexSet blocks_to_check;
+    for (const auto& voxel_key : voxels_to_check) {
+      EverFreeBlock::Ptr ever_free_block =
+          ever_free_layer_->getBlockPtrByIndex(voxel_key.first);
+      if (!ever_free_block) {
+        continue;
       }
-    }));
-  }
-  for (auto& thread : threads) {
-    thread.get();
+      ever_free_block->markDirty(
+          ever_free_block->computeLinearIndexFromVoxelIndex(voxel_key.second));
+      blocks_to_check.insert(voxel_key.first);
+    }
+    indices.assign(blocks_to_check.begin(), blocks_to_check.end());
   }
 }
 
 bool EverFreeIntegrator::blockWiseUpdateEverFree(
     const BlockIndex& block_index, const int frame_counter,
-    voxblox::AlignedVector<voxblox::VoxelKey>& voxels_to_remove) const {
-  TsdfBlock::Ptr tsdf_block = tsdf_layer_->getBlockPtrByIndex(block_index);
-  if (!tsdf_block) {
+    std::pmr::vector<voxblox::VoxelKey>& voxels_to_remove) const {
+  TsdfBlock::ConstPtr tsdf_block =
+      tsdf_layer_->getBlockPtrByIndex(block_index);
+  EverFreeBlock::Ptr ever_free_block =
+      ever_free_layer_->getBlockPtrByIndex(block_index);
+  if (!tsdf_block || !ever_free_block) {
     return false;
   }
-
-  for (size_t index = 0; index < voxels_per_block_; ++index) {
-    TsdfVoxel& tsdf_voxel = tsdf_block->getVoxelByLinearIndex(index);
-
-    // Updating the occupancy counter.
-    if (tsdf_voxel.distance < config_.tsdf_occupancy_threshold ||
-        tsdf_voxel.last_lidar_occupied == frame_counter) {
-      updateOccupancyCounter(tsdf_voxel, frame_counter);
+  ever_free_block->setLastObserved(frame_counter);
+  const size_t num_voxels_to_remove = voxels_to_remove.size();
+
+  // Voxblox does not report which voxels were touched by the integration, so
+  // synchronize the TSDF derived state of the block unless the TSDF integrator
+  // already did so.
+  if (config_.synchronize_tsdf) {
+    for (size_t index = 0; index < voxels_per_block_; ++index) {
+      synchronizeVoxel(*ever_free_block, index,
+                       tsdf_block->getVoxelByLinearIndex(index), frame_counter);
     }
-    if (tsdf_voxel.last_lidar_occupied <
-        frame_counter - config_.temporal_buffer) {
-      tsdf_voxel.dynamic = false;
+  }
+
+  // Process the dirty voxels. Voxels hit by the lidar were recorded when
+  // building the point map. NOTE: removeEverFree() marks the cleared voxels
+  // dirty, so the list can grow while iterating.
+  const std::vector<uint32_t>& dirty_voxels = ever_free_block->getDirtyVoxels();
+  for (size_t i = 0; i < dirty_voxels.size(); ++i) {
+    const size_t index = dirty_voxels[i];
+    if (ever_free_block->getLastLidarOccupied(index) == frame_counter) {
+      updateOccupancyCounter(*ever_free_block, index, frame_counter);
+    } else if (ever_free_block->getLastLidarOccupied(index) <
+               frame_counter - config_.temporal_buffer) {
+      ever_free_block->clearFlag(index, EverFreeBlock::kDynamic);
     }
 
     // Call to remove ever-free if warranted.
-    if (tsdf_voxel.occ_counter >= config_.counter_to_reset &&
-        tsdf_voxel.ever_free) {
+    if (ever_free_block->getOccupancyCounter(index) >=
+            config_.counter_to_reset &&
+        ever_free_block->hasFlag(index, EverFreeBlock::kEverFree)) {
       const VoxelIndex voxel_index =
-          tsdf_block->computeVoxelIndexFromLinearIndex(index);
+          ever_free_block->computeVoxelIndexFromLinearIndex(index);
       voxblox::AlignedVector<voxblox::VoxelKey> voxels =
-          removeEverFree(*tsdf_block, tsdf_voxel, block_index, voxel_index);
+          removeEverFree(*ever_free_block, block_index, voxel_index);
       voxels_to_remove.insert(voxels_to_remove.end(), voxels.begin(),
                               voxels.end());
     }
   }
 
-  return !voxels_to_remove.empty();
+  return voxels_to_remove.size() > num_voxels_to_remove;
 }
 
-void EverFreeIntegrator::blockWiseMakeEverFree(const BlockIndex& block_index,
-                                               const int frame_counter) const {
+voxblox::AlignedVector<voxblox::VoxelKey>
+EverFreeIntegrator::blockWiseMakeEverFree(const BlockIndex& block_index,
+                                          const int frame_counter) const {
+  voxblox::AlignedVector<voxblox::VoxelKey> voxels_to_check;
   TsdfBlock::Ptr tsdf_block = tsdf_layer_->getBlockPtrByIndex(block_index);
-  if (!tsdf_block) {
-    return;
+  EverFreeBlock::Ptr ever_free_block =
+      ever_free_layer_->getBlockPtrByIndex(block_index);
+  if (!tsdf_block || !ever_free_block) {
+    return voxels_to_check;
   }
 
-  // Check all voxels.
-  for (size_t index = 0; index < voxels_per_block_; ++index) {
-    TsdfVoxel& tsdf_voxel = tsdf_block->getVoxelByLinearIndex(index);
+  // Check all dirty voxels. Voxels that are marked dirty while processing are
+  // appended to the list of the block and processed in the next iteration.
+  std::vector<uint32_t> waiting_voxels;
+  voxblox::AlignedVector<voxblox::VoxelKey> neighbors;
+  std::vector<uint32_t> dirty_voxels = ever_free_block->takeDirtyVoxels();
+  while (!dirty_voxels.empty()) {
+    for (const size_t index : dirty_voxels) {
+      // Changes in observedness or occupancy can make the neighbors ever-free.
+      bool notify_neighbors = false;
+      if (ever_free_block->hasFlag(index, EverFreeBlock::kNewlyObserved)) {
+        ever_free_block->clearFlag(index, EverFreeBlock::kNewlyObserved);
+        notify_neighbors = true;
+      }
+      if (ever_free_block->hasFlag(index, EverFreeBlock::kBurnIn)) {
+        if (ever_free_block->getLastOccupied(index) >
+            frame_counter - config_.burn_in_period) {
+          // Voxel must be unoccupied for the last burn_in_period frames. Keep
+          // it dirty until then.
+          waiting_voxels.push_back(index);
+          continue;
+        }
+        ever_free_block->clearFlag(index, EverFreeBlock::kBurnIn);
+        notify_neighbors = true;
+      }
+      if (ever_free_block->hasFlag(index, EverFreeBlock::kDynamic)) {
+        // Dynamic labels are cleared after temporal_buffer frames.
+        waiting_voxels.push_back(index);
+      }
 
-    // If already ever-free we can save the cost of checking the neighbourhood.
-    // Only observed voxels (with weight) can be set to ever free.
-    // Voxel must be unoccupied for the last burn_in_period frames and
-    // TSDF-value must be larger than 3/2 voxel_size
-    if (tsdf_voxel.ever_free || tsdf_voxel.weight <= 1e-6 ||
-        tsdf_voxel.last_occupied > frame_counter - config_.burn_in_period) {
-      continue;
-    }
+      const VoxelIndex voxel_index =
+          ever_free_block->computeVoxelIndexFromLinearIndex(index);
+      neighborhood_search_.search(block_index, voxel_index, voxels_per_side_,
+                                  &neighbors);
+      if (notify_neighbors) {
+        for (const voxblox::VoxelKey& neighbor_key : neighbors) {
+          if (neighbor_key.first == block_index) {
+            ever_free_block->markDirty(
+                ever_free_block->computeLinearIndexFromVoxelIndex(
+                    neighbor_key.second));
+          } else {
+            // Since this is executed in parallel only modify this block.
+            voxels_to_check.push_back(neighbor_key);
+          }
+        }
+      }
 
-    // Check the neighbourhood for unobserved or occupied voxels.
-    const VoxelIndex voxel_index =
-        tsdf_block->computeVoxelIndexFromLinearIndex(index);
-
-    voxblox::AlignedVector<voxblox::VoxelKey> neighbors =
-        neighborhood_search_.search(block_index, voxel_index, voxels_per_side_);
-
-    bool neighbor_occupied_or_unobserved = false;
-
-    for (const voxblox::VoxelKey& neighbor_key : neighbors) {
-      const TsdfBlock* neighbor_block;
-      if (neighbor_key.first == block_index) {
-        // Often will be the same block.
-        neighbor_block = tsdf_block.get();
-      } else {
-        neighbor_block =
-            tsdf_layer_->getBlockPtrByIndex(neighbor_key.first).get();
-        if (neighbor_block == nullptr) {
-          // Block does not exist.
+      // If already ever-free we can save the cost of checking the
+      // neighbourhood. Only observed voxels (with weight) can be set to ever
+      // free.
+      if (ever_free_block->hasFlag(index, EverFreeBlock::kEverFree) ||
+          !ever_free_block->isObserved(index) ||
+          ever_free_block->getLastOccupied(index) >
+              frame_counter - config_.burn_in_period) {
+        continue;
+      }
+
+      // Check the neighbourhood for unobserved or occupied voxels.
+      bool neighbor_occupied_or_unobserved = false;
+      for (const voxblox::VoxelKey& neighbor_key : neighbors) {
+        const EverFreeBlock* neighbor_block;
+        if (neighbor_key.first == block_index) {
+          // Often will be the same block.
+          neighbor_block = ever_free_block.get();
+        } else {
+          neighbor_block =
+              ever_free_layer_->getBlockPtrByIndex(neighbor_key.first).get();
+          if (neighbor_block == nullptr) {
+            // Block does not exist.
+            neighbor_occupied_or_unobserved = true;
+            break;
+          }
+        }
+
+        // Check the voxel if it is unobserved or static.
+        const size_t neighbor_index =
+            neighbor_block->computeLinearIndexFromVoxelIndex(
+                neighbor_key.second);
+        if (!neighbor_block->isObserved(neighbor_index) ||
+            neighbor_block->getLastOccupied(neighbor_index) >
+                frame_counter - config_.burn_in_period) {
           neighbor_occupied_or_unobserved = true;
           break;
         }
       }
 
-      // Check the voxel if it is unobserved or static.
-      const TsdfVoxel& neighbor_voxel =
-          neighbor_block->getVoxelByVoxelIndex(neighbor_key.second);
-      if (neighbor_voxel.weight < 1e-6 ||
-          neighbor_voxel.last_occupied >
-              frame_counter - config_.burn_in_period) {
-        neighbor_occupied_or_unobserved = true;
-        break;
+      // Only observed free space, can be labeled as ever-free.
+      if (!neighbor_occupied_or_unobserved) {
+        ever_free_block->setFlag(index, EverFreeBlock::kEverFree);
+
+        // The counter_to_reset check runs on every voxel of an updated block,
+        // so keep these voxels dirty to remove them again next frame.
+        if (ever_free_block->getOccupancyCounter(index) >=
+            config_.counter_to_reset) {
+          waiting_voxels.push_back(index);
+        }
       }
     }
+    dirty_voxels = ever_free_block->takeDirtyVoxels();
+  }
 
-    // Only observed free space, can be labeled as ever-free.
-    if (!neighbor_occupied_or_unobserved) {
-      tsdf_voxel.ever_free = true;
-    }
+  // Voxels in their burn-in period, with dynamic labels, or pending removal are
+  // checked again in later frames.
+  for (const uint32_t index : waiting_voxels) {
+    ever_free_block->markDirty(index);
   }
   tsdf_block->updated().reset(voxblox::Update::kEsdf);
+  return voxels_to_check;
 }
 
 voxblox::AlignedVector<voxblox::VoxelKey> EverFreeIntegrator::removeEverFree(
-    TsdfBlock& block, TsdfVoxel& voxel, const BlockIndex& block_index,
+    EverFreeBlock& block, const BlockIndex& block_index,
     const VoxelIndex& voxel_index) const {
-  // Remove ever-free attributes.
-  voxel.ever_free = false;
-  voxel.dynamic = false;
+  // Remove ever-free attributes. Cleared voxels are marked dirty, so they can
+  // be labeled ever-free again once they qualify.
+  const size_t linear_index =
+      block.computeLinearIndexFromVoxelIndex(voxel_index);
+  block.clearFlag(linear_index,
+                  EverFreeBlock::kEverFree | EverFreeBlock::kDynamic);
+  block.markDirty(linear_index);
 
   // Remove ever-free attribute also from neighbouring voxels.
   voxblox::AlignedVector<voxblox::VoxelKey> neighbors =
@@ -227,10 +353,11 @@ voxblox::AlignedVector<voxblox::VoxelKey> EverFreeIntegrator::removeEverFree(
   for (const voxblox::VoxelKey& neighbor_key : neighbors) {
     if (neighbor_key.first == block_index) {
       // Since this is executed in parallel only modify this block.
-      TsdfVoxel& neighbor_voxel =
-          block.getVoxelByVoxelIndex(neighbor_key.second);
-      neighbor_voxel.ever_free = false;
-      neighbor_voxel.dynamic = false;
+      const size_t neighbor_index =
+          block.computeLinearIndexFromVoxelIndex(neighbor_key.second);
+      block.clearFlag(neighbor_index,
+                      EverFreeBlock::kEverFree | EverFreeBlock::kDynamic);
+      block.markDirty(neighbor_index);
     } else {
       // Otherwise mark the voxel for later clean-up.
       voxels_to_remove.push_back(neighbor_key);
@@ -240,16 +367,43 @@ voxblox::AlignedVector<voxblox::VoxelKey> EverFreeIntegrator::removeEverFree(
   return voxels_to_remove;
 }
 
-void EverFreeIntegrator::updateOccupancyCounter(TsdfVoxel& voxel,
+void EverFreeIntegrator::synchronizeVoxel(EverFreeBlock& block,
+                                          const size_t linear_index,
+                                          const TsdfVoxel& tsdf_voxel,
+                                          const int frame_counter) const {
+  // Cache which voxels are observed so the ever-free checks do not need to
+  // access the TSDF layer.
+  if (tsdf_voxel.weight > 1e-6 && !block.isObserved(linear_index)) {
+    block.setObserved(linear_index);
+    block.setFlag(linear_index, EverFreeBlock::kNewlyObserved);
+    block.markDirty(linear_index);
+  }
+
+  // Updating the occupancy counter.
+  if (isTsdfOccupied(tsdf_voxel)) {
+    updateOccupancyCounter(block, linear_index, frame_counter);
+  }
+}
+
+void EverFreeIntegrator::updateOccupancyCounter(EverFreeBlock& block,
+                                                const size_t linear_index,
                                                 const int frame_counter) const {
+  // Voxels can be occupied by both the lidar and the TSDF, count them once.
+  if (block.getLastOccupied(linear_index) == frame_counter) {
+    return;
+  }
+
   // Allow for breaks of temporal_buffer between occupied observations to
   // compensate for lidar sparsity.
-  if (voxel.last_occupied >= frame_counter - config_.temporal_buffer) {
-    voxel.occ_counter++;
+  if (block.getLastOccupied(linear_index) >=
+      frame_counter - config_.temporal_buffer) {
+    block.incrementOccupancyCounter(linear_index);
   } else {
-    voxel.occ_counter = 1;
+    block.setOccupancyCounter(linear_index, 1);
   }
-  voxel.last_occupied = frame_counter;
+  block.setLastOccupied(linear_index, frame_counter);
+  block.setFlag(linear_index, EverFreeBlock::kBurnIn);
+  block.markDirty(linear_index);
 }
 
 }  // namespace dynablox
@@ -0,0 +1,281 @@
+#include "dynablox/processing/ever_free_tsdf_integrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <voxblox/integrator/integrator_utils.h>
+#include <voxblox/utils/timing.h>
+
+#include "dynablox/common/index_getter.h"
+#include "dynablox/common/stage_timer.h"
+#include "dynablox/common/trace_recorder.h"
+
+namespace dynablox {
+
+using Timer = StageTimer;
+
+void EverFreeTsdfIntegrator::Config::checkParams() const {
+  checkParamGT(truncation_distance, 0.f, "truncation_distance");
+  checkParamGT(max_weight, 0.f, "max_weight");
+  checkParamGE(min_ray_length_m, 0.f, "min_ray_length_m");
+  checkParamCond(max_ray_length_m > min_ray_length_m,
+                 "'max_ray_length_m' must be larger than 'min_ray_length_m'.");
+  checkParamGT(sensor_horizontal_resolution, 0, "sensor_horizontal_resolution");
+  checkParamGT(sensor_vertical_resolution, 1, "sensor_vertical_resolution");
+  checkParamGT(sensor_vertical_field_of_view_degrees, 0.0,
+               "sensor_vertical_field_of_view_degrees");
+  checkParamGE(integrator_threads, 1, "integrator_threads");
+}
+
+void EverFreeTsdfIntegrator::Config::setupParamsAndPrinting() {
+  setupParam("truncation_distance", &truncation_distance, "m");
+  setupParam("max_weight", &max_weight);
+  setupParam("use_const_weight", &use_const_weight);
+  setupParam("min_ray_length_m", &min_ray_length_m, "m");
+  setupParam("max_ray_length_m", &max_ray_length_m, "m");
+  setupParam("sensor_horizontal_resolution", &sensor_horizontal_resolution);
+  setupParam("sensor_vertical_resolution", &sensor_vertical_resolution);
+  setupParam("sensor_vertical_field_of_view_degrees",
+             &sensor_vertical_field_of_view_degrees, "deg");
+  setupParam("integrator_threads", &integrator_threads);
+}
+
+EverFreeTsdfIntegrator::EverFreeTsdfIntegrator(
+    const Config& config, TsdfLayer::Ptr tsdf_layer,
+    EverFreeLayer::Ptr ever_free_layer,
+    std::shared_ptr<EverFreeIntegrator> ever_free_integrator)
+    : config_(config.checkValid()),
+      tsdf_layer_(std::move(tsdf_layer)),
+      ever_free_layer_(std::move(ever_free_layer)),
+      ever_free_integrator_(std::move(ever_free_integrator)),
+      block_size_(tsdf_layer_->block_size()),
+      voxels_per_block_(tsdf_layer_->voxels_per_side() *
+                        tsdf_layer_->voxels_per_side() *
+                        tsdf_layer_->voxels_per_side()),
+      vertical_fov_rad_(config_.sensor_vertical_field_of_view_degrees * M_PI /
+                        180.0) {}
+
+void EverFreeTsdfIntegrator::integratePointCloud(
+    const voxblox::Transformation& T_G_C, const voxblox::Pointcloud& points_C,
+    const int frame_counter) {
+  // Build the range image, keeping the closest return per pixel. Points beyond
+  // the max ray length are kept to clear the space in front of them.
+  Timer range_image_timer("tsdf_integration/range_image");
+  range_image_.assign(
+      config_.sensor_horizontal_resolution * config_.sensor_vertical_resolution,
+      -1.f);
+  for (const voxblox::Point& point_C : points_C) {
+    const float range = point_C.norm();
+    int row, col;
+    if (range < config_.min_ray_length_m ||
+        !projectToImage(point_C, row, col)) {
+      continue;
+    }
+    float& pixel =
+        range_image_[row * config_.sensor_horizontal_resolution + col];
+    if (pixel < 0.f || range < pixel) {
+      pixel = range;
+    }
+  }
+  range_image_timer.Stop();
+
+  // Allocate the blocks observed by the scan, found by casting each ray at
+  // block resolution up to the truncation distance behind its point. Rays of
+  // points beyond the max ray length are cut there to clear the space in front
+  // of them. Allocation is not thread safe so it is done up front.
+  Timer allocate_timer("tsdf_integration/allocate");
+  const voxblox::Transformation T_C_G = T_G_C.inverse();
+  const float block_size_inv = 1.f / block_size_;
+  const voxblox::Point origin_scaled = T_G_C.getPosition() * block_size_inv;
+  voxblox::IndexSet observed_blocks;
+  voxblox::AlignedVector<voxblox::GlobalIndex> ray_blocks;
+  for (const voxblox::Point& point_C : points_C) {
+    const float range = point_C.norm();
+    if (range < config_.min_ray_length_m) {
+      continue;
+    }
+    const float ray_length = std::min(range + config_.truncation_distance,
+                                      config_.max_ray_length_m);
+    const voxblox::Point end_G = T_G_C * (point_C * (ray_length / range));
+    ray_blocks.clear();
+    voxblox::castRay(origin_scaled, end_G * block_size_inv, &ray_blocks);
+    for (const voxblox::GlobalIndex& block : ray_blocks) {
+      observed_blocks.insert(block.cast<voxblox::IndexElement>());
+    }
+  }
+  std::vector<BlockIndex> block_indices;
+  block_indices.reserve(observed_blocks.size());
+  voxblox::IndexSet new_blocks;
+  for (const BlockIndex& block_index : observed_blocks) {
+    if (!tsdf_layer_->getBlockPtrByIndex(block_index)) {
+      tsdf_layer_->allocateBlockPtrByIndex(block_index);
+      new_blocks.insert(block_index);
+    }
+    ever_free_layer_->allocateBlockPtrByIndex(block_index);
+    block_indices.push_back(block_index);
+  }
+  allocate_timer.Stop();
+
+  // Update all voxels in parallel by block.
+  Timer update_timer("tsdf_integration/update_voxels");
+  IndexGetter<BlockIndex> index_getter(block_indices);
+  AllocationCounter::StageCounts* const worker_allocations =
+      AllocationCounter::getWorkerCounts();
+  std::vector<std::future<void>> threads;
+  std::mutex result_aggregation_mutex;
+  voxblox::BlockIndexList unused_blocks;
+  for (int i = 0; i < config_.integrator_threads; ++i) {
+    threads.emplace_back(std::async(std::launch::async, [&]() {
+      TraceSpan worker_span("tsdf_integration/update_voxels/worker");
+      const AllocationCounter::WorkerScope allocation_scope(worker_allocations);
+      BlockIndex index;
+      voxblox::BlockIndexList local_unused_blocks;
+      int num_blocks = 0;
+      while (index_getter.getNextIndex(&index)) {
+        ++num_blocks;
+        if (!updateBlock(index, T_C_G, frame_counter) &&
+            new_blocks.count(index)) {
+          local_unused_blocks.push_back(index);
+        }
+      }
+
+      // Aggregate results.
+      worker_span.setCount(num_blocks);
+      std::lock_guard lock(result_aggregation_mutex);
+      unused_blocks.insert(unused_blocks.end(), local_unused_blocks.begin(),
+                           local_unused_blocks.end());
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.get();
+  }
+  update_timer.Stop();
+
+  // Remove blocks that were allocated but did not receive any measurement.
+  for (const BlockIndex& block_index : unused_blocks) {
+    tsdf_layer_->removeBlock(block_index);
+    ever_free_layer_->removeBlock(block_index);
+  }
+}
+
+bool EverFreeTsdfIntegrator::projectToImage(const voxblox::Point& point_C,
+                                            int& row, int& col) const {
+  // Columns cover the full circle, rows the symmetric vertical field of view.
+  const double horizontal = std::atan2(point_C.y(), point_C.x());
+  col = static_cast<int>(std::round((horizontal + M_PI) / (2.0 * M_PI) *
+                                    config_.sensor_horizontal_resolution)) %
+        config_.sensor_horizontal_resolution;
+  const double vertical = std::atan2(
+      point_C.z(),
+      std::sqrt(point_C.x() * point_C.x() + point_C.y() * point_C.y()));
+  row = static_cast<int>(std::round((vertical_fov_rad_ / 2.0 - vertical) /
+                                    vertical_fov_rad_ *
+                                    (config_.sensor_vertical_resolution - 1)));
+  return row >= 0 && row < config_.sensor_vertical_resolution;
+}
+
+bool EverFreeTsdfIntegrator::updateBlock(const BlockIndex& block_index,
+                                         const voxblox::Transformation& T_C_G,
+                                         const int frame_counter) const {
+  TsdfBlock::Ptr tsdf_block = tsdf_layer_->getBlockPtrByIndex(block_index);
+  EverFreeBlock::Ptr ever_free_block =
+      ever_free_layer_->getBlockPtrByIndex(block_index);
+  if (!tsdf_block || !ever_free_block) {
+    return false;
+  }
+
+  // The ever-free state is stamped with the frame of the next ever-free update,
+  // which would otherwise synchronize it.
+  const int stamp = frame_counter + 1;
+  std::vector<uint32_t>& occupied_voxels =
+      ever_free_block->getTsdfOccupiedVoxels();
+  const bool track_occupied = ever_free_block->hasTsdfOccupiedVoxels();
+  bool block_updated = false;
+  for (size_t index = 0; index < voxels_per_block_; ++index) {
+    // Look up the measured range for the voxel.
+    const voxblox::Point point_C =
+        T_C_G * tsdf_block->computeCoordinatesFromLinearIndex(index);
+    const float distance = point_C.norm();
+    if (distance < config_.min_ray_length_m ||
+        distance > config_.max_ray_length_m) {
+      continue;
+    }
+    int row, col;
+    if (!projectToImage(point_C, row, col)) {
+      continue;
+    }
+    const float range =
+        range_image_[row * config_.sensor_horizontal_resolution + col];
+    if (range < 0.f) {
+      continue;
+    }
+    const float sdf = range - distance;
+    if (sdf < -config_.truncation_distance) {
+      continue;
+    }
+
+    // Update the TSDF.
+    TsdfVoxel& voxel = tsdf_block->getVoxelByLinearIndex(index);
+    const bool was_occupied = ever_free_integrator_->isTsdfOccupied(voxel);
+    const float weight =
+        config_.use_const_weight ? 1.f : 1.f / (distance * distance);
+    const float new_weight = voxel.weight + weight;
+    voxel.distance = std::clamp(
+        (voxel.distance * voxel.weight +
+         std::min(sdf, config_.truncation_distance) * weight) /
+            new_weight,
+        -config_.truncation_distance, config_.truncation_distance);
+    voxel.weight = std::min(new_weight, config_.max_weight);
+    block_updated = true;
+
+    // Update the ever-free bookkeeping of the written voxel while it is at
+    // hand.
+    ever_free_integrator_->synchronizeVoxel(*ever_free_block, index, voxel,
+                                            stamp);
+    if (track_occupied && !was_occupied &&
+        ever_free_integrator_->isTsdfOccupied(voxel)) {
+      occupied_voxels.push_back(static_cast<uint32_t>(index));
+    }
+  }
+  if (!block_updated) {
+    return false;
+  }
+  tsdf_block->set_has_data(true);
+  tsdf_block->updated().set();
+
+  // EverFreeIntegrator::updateEverFreeVoxels() synchronizes all voxels of an
+  // updated block, so occupied voxels are counted even if they were not
+  // written. Count them from the occupied voxels of the block, dropping the
+  // ones that were freed. Blocks that were not tracked yet, e.g. new or
+  // reloaded ones, are scanned once to build the list.
+  if (!track_occupied) {
+    occupied_voxels.clear();
+    for (size_t index = 0; index < voxels_per_block_; ++index) {
+      const TsdfVoxel& voxel = tsdf_block->getVoxelByLinearIndex(index);
+      ever_free_integrator_->synchronizeVoxel(*ever_free_block, index, voxel,
+                                              stamp);
+      if (ever_free_integrator_->isTsdfOccupied(voxel)) {
+        occupied_voxels.push_back(static_cast<uint32_t>(index));
+      }
+    }
+    ever_free_block->setTsdfOccupiedVoxelsValid();
+    return true;
+  }
+  size_t num_occupied = 0;
+  for (const uint32_t index : occupied_voxels) {
+    if (ever_free_integrator_->isTsdfOccupied(
+            tsdf_block->getVoxelByLinearIndex(index))) {
+      ever_free_integrator_->updateOccupancyCounter(*ever_free_block, index,
+                                                    stamp);
+      occupied_voxels[num_occupied++] = index;
+    }
+  }
+  occupied_voxels.resize(num_occupied);
+  return true;
+}
+
+}  // namespace dynablox
@@ -0,0 +1,167 @@
+#include "dynablox/processing/point_map_indexer.h"
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "dynablox/common/allocation_counter.h"
+#include "dynablox/common/index_getter.h"
+#include "dynablox/common/trace_recorder.h"
+
+namespace dynablox {
+
+void PointMapIndexer::Config::checkParams() const {
+  checkParamGE(num_threads, 1, "num_threads");
+}
+
+void PointMapIndexer::Config::setupParamsAndPrinting() {
+  setupParam("num_threads", &num_threads);
+}
+
+PointMapIndexer::PointMapIndexer(const Config& config,
+                                 TsdfLayer::Ptr tsdf_layer,
+                                 EverFreeLayer::Ptr ever_free_layer)
+    : config_(config.checkValid()),
+      tsdf_layer_(std::move(tsdf_layer)),
+      ever_free_layer_(std::move(ever_free_layer)) {}
+
+void PointMapIndexer::setUpPointMap(
+    const Cloud& cloud, const int frame_counter, BlockToPointMap& point_map,
+    Clustering::ClusterIndices& occupied_ever_free_voxel_indices,
+    CloudInfo& cloud_info) const {
+  // Identifies for any LiDAR point the block it falls in and constructs the
+  // hash-map block2points_map mapping each block to the LiDAR points that
+  // fall into the block.
+  std::pmr::memory_resource* resource = point_map.get_allocator().resource();
+  BlockToPointIndicesMap block2points_map(resource);
+  buildBlockToPointsMap(cloud, cloud_info, block2points_map);
+
+  // Builds the voxel2point-map in parallel blockwise.
+  std::vector<BlockIndex> block_indices(block2points_map.size());
+  size_t i = 0;
+  for (const auto& block : block2points_map) {
+    block_indices[i] = block.first;
+    ++i;
+
+    // Mirror observed TSDF blocks in the ever-free layer, since allocation is
+    // not thread safe.
+    if (tsdf_layer_->getBlockPtrByIndex(block.first)) {
+      ever_free_layer_->allocateBlockPtrByIndex(block.first);
+    }
+  }
+  IndexGetter<BlockIndex> index_getter(block_indices);
+  AllocationCounter::StageCounts* const worker_allocations =
+      AllocationCounter::getWorkerCounts();
+  std::vector<std::future<void>> threads;
+  std::mutex aggregate_results_mutex;
+  for (int i = 0; i < config_.num_threads; ++i) {
+    threads.emplace_back(std::async(std::launch::async, [&]() {
+      TraceSpan worker_span("motion_detection/indexing_setup/worker");
+      const AllocationCounter::WorkerScope allocation_scope(worker_allocations);
+
+      // Data to store results.
+      BlockIndex block_index;
+      Clustering::ClusterIndices local_occupied_indices(resource);
+      BlockToPointMap local_point_map(resource);
+
+      // Process until no more blocks.
+      while (index_getter.getNextIndex(&block_index)) {
+        VoxelToPointMap result(resource);
+        this->blockwiseBuildPointMap(
+            cloud, frame_counter, block_index, block2points_map.at(block_index),
+            result, local_occupied_indices, cloud_info);
+        local_point_map.emplace(block_index, std::move(result));
+      }
+
+      // After processing is done add data to the output map.
+      worker_span.setCount(local_point_map.size());
+      std::lock_guard<std::mutex> lock(aggregate_results_mutex);
+      occupied_ever_free_voxel_indices.insert(
+          occupied_ever_free_voxel_indices.end(),
+          local_occupied_indices.begin(), local_occupied_indices.end());
+      point_map.merge(local_point_map);
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.get();
+  }
+}
+
+void PointMapIndexer::buildBlockToPointsMap(
+    const Cloud& cloud, const CloudInfo& cloud_info,
+    BlockToPointIndicesMap& result) const {
+  int i = 0;
+  for (const Point& point : cloud) {
+    if (cloud_info.points[i].processed) {
+      voxblox::Point coord(point.x, point.y, point.z);
+      const BlockIndex blockindex =
+          tsdf_layer_->computeBlockIndexFromCoordinates(coord);
+      result[blockindex].push_back(i);
+    }
+    i++;
+  }
+}
+
+void PointMapIndexer::blockwiseBuildPointMap(
+    const Cloud& cloud, const int frame_counter, const BlockIndex& block_index,
+    const PointIndices& points_in_block, VoxelToPointMap& voxel_map,
+    Clustering::ClusterIndices& occupied_ever_free_voxel_indices,
+    CloudInfo& cloud_info) const {
+  // Get the block.
+  TsdfBlock::Ptr tsdf_block = tsdf_layer_->getBlockPtrByIndex(block_index);
+  EverFreeBlock::Ptr ever_free_block =
+      ever_free_layer_->getBlockPtrByIndex(block_index);
+  if (!tsdf_block || !ever_free_block) {
+    return;
+  }
+  ever_free_block->setLastObserved(frame_counter);
+
+  // Create a mapping of each voxel index to the points it contains.
+  for (size_t i : points_in_block) {
+    const Point& point = cloud[i];
+    const voxblox::Point coords(point.x, point.y, point.z);
+    const VoxelIndex voxel_index =
+        tsdf_block->computeVoxelIndexFromCoordinates(coords);
+    if (!tsdf_block->isValidVoxelIndex(voxel_index)) {
+      continue;
+    }
+    voxel_map[voxel_index].push_back(i);
+
+    // EverFree detection flag at the same time, since we anyways lookup
+    // voxels.
+    if (ever_free_block->hasFlag(
+            ever_free_block->computeLinearIndexFromVoxelIndex(voxel_index),
+            EverFreeBlock::kEverFree)) {
+      cloud_info.points.at(i).ever_free_level_dynamic = true;
+    }
+  }
+
+  // Update the voxel status of the currently occupied voxels.
+  for (const auto& voxel_points_pair : voxel_map) {
+    const size_t linear_index =
+        ever_free_block->computeLinearIndexFromVoxelIndex(
+            voxel_points_pair.first);
+    ever_free_block->setLastLidarOccupied(linear_index, frame_counter);
+
+    // Record the voxel as touched so the ever-free integrator only needs to
+    // process voxels that actually changed this frame.
+    ever_free_block->markDirty(linear_index);
+
+    // This voxel attribute is used in the voxel clustering method: it
+    // signalizes that a currently occupied voxel has not yet been clustered
+    ever_free_block->clearFlag(linear_index,
+                               EverFreeBlock::kClusteringProcessed);
+
+    // The set of occupied_ever_free_voxel_indices allows for fast access of
+    // the seed voxels in the voxel clustering
+    if (ever_free_block->hasFlag(linear_index, EverFreeBlock::kEverFree)) {
+      occupied_ever_free_voxel_indices.push_back(
+          std::make_pair(block_index, voxel_points_pair.first));
+    }
+  }
+}
+
+}  // namespace dynablox
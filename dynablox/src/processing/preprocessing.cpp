@@ -26,14 +26,20 @@ bool Preprocessing::processPointcloud(const sensor_msgs::PointCloud2::Ptr& msg,
                                       CloudInfo& cloud_info) const {
   // Convert to ROS msg to pcl cloud.
   pcl::fromROSMsg(*msg, cloud);
+  return processPointcloud(msg->header.stamp.toNSec(), T_M_S, cloud,
+                           cloud_info);
+}
 
+bool Preprocessing::processPointcloud(const uint64_t timestamp,
+                                      const tf::Transform& T_M_S, Cloud& cloud,
+                                      CloudInfo& cloud_info) const {
   // Populate the cloud information with data for all points.
-  cloud_info.timestamp = msg->header.stamp.toNSec();
+  cloud_info.timestamp = timestamp;
   cloud_info.sensor_position.x = T_M_S.getOrigin().x();
   cloud_info.sensor_position.y = T_M_S.getOrigin().y();
   cloud_info.sensor_position.z = T_M_S.getOrigin().z();
 
-  cloud_info.points = std::vector<PointInfo>(cloud.size());
+  cloud_info.points.assign(cloud.size(), PointInfo());
   size_t i = 0;
   for (const auto& point : cloud) {
     const float norm =
@@ -1,5 +1,8 @@
 #include "dynablox/processing/tracking.h"
 
+#include <unordered_set>
+#include <vector>
+
 namespace dynablox {
 
 void Tracking::Config::checkParams() const {}
@@ -28,8 +31,11 @@ void Tracking::track(const Cloud& cloud, Clusters& clusters,
 }
 
 void Tracking::trackClusterIDs(const Cloud& cloud, Clusters& clusters) {
+  // Temporary data is allocated from the memory resource of the clusters.
+  std::pmr::memory_resource* resource = clusters.get_allocator().resource();
+
   // Compute the centroids of all clusters.
-  std::vector<voxblox::Point> centroids(clusters.size());
+  std::pmr::vector<voxblox::Point> centroids(clusters.size(), resource);
   size_t i = 0;
   for (const Cluster& cluster : clusters) {
     voxblox::Point centroid = {0, 0, 0};
@@ -48,9 +54,10 @@ void Tracking::trackClusterIDs(const Cloud& cloud, Clusters& clusters) {
     int current_id;
   };
 
-  std::vector<std::vector<Association>> distances(previous_centroids_.size());
+  std::pmr::vector<std::pmr::vector<Association>> distances(
+      previous_centroids_.size(), resource);
   for (size_t i = 0; i < previous_centroids_.size(); ++i) {
-    std::vector<Association>& d = distances[i];
+    std::pmr::vector<Association>& d = distances[i];
     d.reserve(centroids.size());
     for (size_t j = 0; j < centroids.size(); ++j) {
       Association association;
@@ -62,7 +69,7 @@ void Tracking::trackClusterIDs(const Cloud& cloud, Clusters& clusters) {
   }
 
   // Associate all previous ids until no more minimum distances exist.
-  std::unordered_set<int> reused_ids;
+  std::pmr::unordered_set<int> reused_ids(resource);
   while (true) {
     // Find the minimum distance and IDs (exhaustively).
     float min = std::numeric_limits<float>::max();
@@ -99,7 +106,7 @@ void Tracking::trackClusterIDs(const Cloud& cloud, Clusters& clusters) {
   }
 
   // Fill in all remaining ids and track data.
-  previous_centroids_ = centroids;
+  previous_centroids_.assign(centroids.begin(), centroids.end());
   previous_ids_.clear();
   previous_ids_.reserve(clusters.size());
   previous_track_lengths_.clear();
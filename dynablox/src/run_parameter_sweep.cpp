@@ -0,0 +1,64 @@
+// Offline grid search over the detection parameters on a recorded sequence.
+// Usage:
+//   run_parameter_sweep --sequence_directory=<dir> --output_directory=<dir>
+//       [--sweep/<param>=<value>,<value>,...] [--<param>=<value> ...]
+// Every combination of the swept values is run, e.g.
+// '--sweep/clustering/min_cluster_size=10,20,30'. All other
+// DetectionPipeline::Config and ParameterSweep::Config params can be set as
+// for all runs, e.g. '--voxblox/sensor_horizontal_resolution=1024'.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "dynablox/common/command_line_config.h"
+#include "dynablox/evaluation/parameter_sweep.h"
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Separate the swept parameters from the fixed ones.
+  const std::string sweep_prefix = "--sweep";
+  std::vector<dynablox::ParameterSweep::Axis> axes;
+  std::vector<char*> args = {argv[0]};
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const size_t separator = arg.find('=');
+    if (arg.rfind(sweep_prefix + "/", 0) != 0 ||
+        separator == std::string::npos) {
+      args.push_back(argv[i]);
+      continue;
+    }
+    dynablox::ParameterSweep::Axis& axis = axes.emplace_back();
+    axis.name = arg.substr(sweep_prefix.size(),
+                           separator - sweep_prefix.size());
+    axis.values =
+        dynablox::ParameterSweep::splitValues(arg.substr(separator + 1));
+    if (axis.values.empty()) {
+      std::cerr << "No values given for '" << axis.name << "'." << std::endl;
+      return 1;
+    }
+  }
+
+  const dynablox::ParamMap params =
+      dynablox::getParamMapFromArgs(args.size(), args.data());
+  if (params.find("/sequence_directory") == params.end() ||
+      params.find("/output_directory") == params.end()) {
+    std::cerr << "Usage: " << argv[0]
+              << " --sequence_directory=<dir> --output_directory=<dir>"
+                 " [--sweep/<param>=<value>,<value>,...]"
+                 " [--<param>=<value> ...]"
+              << std::endl;
+    return 1;
+  }
+
+  const auto config =
+      dynablox::getConfigFromParamMap<dynablox::ParameterSweep::Config>(
+          params);
+  LOG(INFO) << "\n" << config.toString();
+  dynablox::ParameterSweep sweep(config, params, axes);
+  return sweep.run() ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+// Performance regression check of the detection against a stored baseline.
+// Usage:
+//   run_performance_gate --baseline_file=<file> [--update_baseline=true]
+//       [--<param>=<value> ...]
+// Returns 0 if no stage regressed, 1 on regressions, and 2 on errors. All
+// PerformanceGate::Config params can be set, e.g. '--scene/num_frames=100' or
+// '--pipeline/clustering/min_cluster_size=20'.
+
+#include <iostream>
+
+#include <glog/logging.h>
+
+#include "dynablox/common/command_line_config.h"
+#include "dynablox/evaluation/performance_gate.h"
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  const dynablox::ParamMap params = dynablox::getParamMapFromArgs(argc, argv);
+  if (params.find("/baseline_file") == params.end()) {
+    std::cerr << "Usage: " << argv[0]
+              << " --baseline_file=<file> [--update_baseline=true]"
+                 " [--<param>=<value> ...]"
+              << std::endl;
+    return 2;
+  }
+
+  const auto config =
+      dynablox::getConfigFromParamMap<dynablox::PerformanceGate::Config>(
+          params);
+  LOG(INFO) << "\n" << config.toString();
+  dynablox::PerformanceGate gate(config);
+  return gate.run();
+}
@@ -0,0 +1,367 @@
+#include "dynablox/simulation/scene_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <random>
+
+#include <glog/logging.h>
+
+#include "dynablox/evaluation/cloud_file.h"
+#include "dynablox/processing/preprocessing.h"
+
+namespace dynablox {
+
+namespace {
+
+constexpr float kNoHit = std::numeric_limits<float>::infinity();
+
+// Distance along the ray to the entry point of the box, kNoHit if missed.
+float intersectBox(const voxblox::Point& origin,
+                   const voxblox::Point& inverse_direction,
+                   const voxblox::Point& min_corner,
+                   const voxblox::Point& max_corner) {
+  const voxblox::Point t_min = (min_corner - origin).cwiseProduct(
+      inverse_direction);
+  const voxblox::Point t_max = (max_corner - origin).cwiseProduct(
+      inverse_direction);
+  const float t_enter = t_min.cwiseMin(t_max).maxCoeff();
+  const float t_exit = t_min.cwiseMax(t_max).minCoeff();
+  if (t_enter > t_exit || t_exit < 0.f) {
+    return kNoHit;
+  }
+  return std::max(t_enter, 0.f);
+}
+
+// Distance along the ray to a vertical cylinder standing on the ground.
+float intersectCylinder(const voxblox::Point& origin,
+                        const voxblox::Point& direction,
+                        const voxblox::Point& base, const float radius,
+                        const float height) {
+  float t_hit = kNoHit;
+
+  // Mantle.
+  const float dx = origin.x() - base.x();
+  const float dy = origin.y() - base.y();
+  const float a = direction.x() * direction.x() +
+                  direction.y() * direction.y();
+  const float b = 2.f * (dx * direction.x() + dy * direction.y());
+  const float c = dx * dx + dy * dy - radius * radius;
+  const float discriminant = b * b - 4.f * a * c;
+  if (a > 1e-9f && discriminant >= 0.f) {
+    const float t = (-b - std::sqrt(discriminant)) / (2.f * a);
+    const float z = origin.z() + t * direction.z();
+    if (t >= 0.f && z >= base.z() && z <= base.z() + height) {
+      t_hit = t;
+    }
+  }
+
+  // Top cap.
+  if (std::abs(direction.z()) > 1e-9f) {
+    const float t = (base.z() + height - origin.z()) / direction.z();
+    const float x = origin.x() + t * direction.x() - base.x();
+    const float y = origin.y() + t * direction.y() - base.y();
+    if (t >= 0.f && x * x + y * y <= radius * radius) {
+      t_hit = std::min(t_hit, t);
+    }
+  }
+  return t_hit;
+}
+
+}  // namespace
+
+void SceneGenerator::Config::checkParams() const {
+  checkParamGT(num_frames, 0, "num_frames");
+  checkParamGT(frame_rate, 0.f, "frame_rate");
+  checkParamGT(num_rings, 1, "num_rings");
+  checkParamGT(num_columns, 0, "num_columns");
+  checkParamCond(max_elevation > min_elevation,
+                 "'max_elevation' must be larger than 'min_elevation'.");
+  checkParamGT(min_range, 0.f, "min_range");
+  checkParamCond(max_range > min_range,
+                 "'max_range' must be larger than 'min_range'.");
+  checkParamGE(range_noise, 0.f, "range_noise");
+  checkParamGE(sensor_speed, 0.f, "sensor_speed");
+  checkParamGE(sensor_distance, 0.f, "sensor_distance");
+  checkParamGT(room_size, 10.f, "room_size");
+  checkParamGE(num_static_objects, 0, "num_static_objects");
+  checkParamGE(num_boxes, 0, "num_boxes");
+  checkParamGE(num_pedestrians, 0, "num_pedestrians");
+  checkParamGE(object_speed, 0.f, "object_speed");
+}
+
+void SceneGenerator::Config::setupParamsAndPrinting() {
+  setupParam("seed", &seed);
+  setupParam("num_frames", &num_frames);
+  setupParam("frame_rate", &frame_rate, "Hz");
+  setupParam("start_time", &start_time, "s");
+  setupParam("num_rings", &num_rings);
+  setupParam("num_columns", &num_columns);
+  setupParam("min_elevation", &min_elevation, "deg");
+  setupParam("max_elevation", &max_elevation, "deg");
+  setupParam("min_range", &min_range, "m");
+  setupParam("max_range", &max_range, "m");
+  setupParam("range_noise", &range_noise, "m");
+  setupParam("sensor_height", &sensor_height, "m");
+  setupParam("sensor_speed", &sensor_speed, "m/s");
+  setupParam("sensor_distance", &sensor_distance, "m");
+  setupParam("room_size", &room_size, "m");
+  setupParam("wall_height", &wall_height, "m");
+  setupParam("num_static_objects", &num_static_objects);
+  setupParam("num_boxes", &num_boxes);
+  setupParam("num_pedestrians", &num_pedestrians);
+  setupParam("object_speed", &object_speed, "m/s");
+}
+
+SceneGenerator::SceneGenerator(const Config& config)
+    : config_(config.checkValid()) {
+  std::mt19937 generator(config_.seed);
+  auto uniform = [&generator](float min, float max) {
+    return std::uniform_real_distribution<float>(min, max)(generator);
+  };
+  const float half_size = config_.room_size / 2.f;
+  const float thickness = 0.2f;
+
+  // Walls.
+  for (const float sign : {-1.f, 1.f}) {
+    const float wall = sign * (half_size + thickness / 2.f);
+    static_boxes_.push_back(
+        {voxblox::Point(wall - thickness / 2.f, -half_size, 0.f),
+         voxblox::Point(wall + thickness / 2.f, half_size,
+                        config_.wall_height)});
+    static_boxes_.push_back(
+        {voxblox::Point(-half_size, wall - thickness / 2.f, 0.f),
+         voxblox::Point(half_size, wall + thickness / 2.f,
+                        config_.wall_height)});
+  }
+
+  // Static boxes, keeping the sensor path free.
+  const float margin = 2.f;
+  while (static_boxes_.size() <
+         4u + static_cast<size_t>(config_.num_static_objects)) {
+    const voxblox::Point center(
+        uniform(-half_size + margin, half_size - margin),
+        uniform(-half_size + margin, half_size - margin), 0.f);
+    if (std::abs(center.y()) < 3.f) {
+      continue;
+    }
+    const voxblox::Point size(uniform(0.5f, 3.f), uniform(0.5f, 3.f),
+                              uniform(0.5f, config_.wall_height));
+    const voxblox::Point half_extent(size.x() / 2.f, size.y() / 2.f, 0.f);
+    static_boxes_.push_back(
+        {center - half_extent,
+         center + half_extent + voxblox::Point(0.f, 0.f, size.z())});
+  }
+
+  // Dynamic objects moving between random points in the room.
+  const int num_objects = config_.num_boxes + config_.num_pedestrians;
+  for (int i = 0; i < num_objects; ++i) {
+    DynamicObject object;
+    object.is_pedestrian = i >= config_.num_boxes;
+    if (object.is_pedestrian) {
+      object.size = voxblox::Point(0.5f, 0.5f, uniform(1.6f, 1.9f));
+    } else {
+      object.size = voxblox::Point(uniform(0.8f, 2.f), uniform(0.8f, 2.f),
+                                   uniform(0.8f, 1.8f));
+    }
+    object.start =
+        voxblox::Point(uniform(-half_size + margin, half_size - margin),
+                       uniform(-half_size + margin, half_size - margin), 0.f);
+    object.end =
+        voxblox::Point(uniform(-half_size + margin, half_size - margin),
+                       uniform(-half_size + margin, half_size - margin), 0.f);
+    object.phase = uniform(0.f, 2.f * (object.end - object.start).norm());
+    objects_.push_back(object);
+  }
+}
+
+SyntheticFrame SceneGenerator::generateFrame(const int frame_index) const {
+  SyntheticFrame frame;
+  frame.timestamp = static_cast<std::uint64_t>(
+      std::llround((config_.start_time +
+                    frame_index / static_cast<double>(config_.frame_rate)) *
+                   1e9));
+  const voxblox::Point origin = getSensorPosition(frame_index);
+  frame.T_M_S.setIdentity();
+  frame.T_M_S.setOrigin(tf::Vector3(origin.x(), origin.y(), origin.z()));
+
+  // Current object poses.
+  std::vector<voxblox::Point> object_positions;
+  object_positions.reserve(objects_.size());
+  for (const DynamicObject& object : objects_) {
+    object_positions.push_back(getObjectPosition(object, frame_index));
+  }
+
+  // Noise only depends on the seed and the frame.
+  std::seed_seq seed{config_.seed, frame_index};
+  std::mt19937 generator(seed);
+  std::normal_distribution<float> noise(0.f, config_.range_noise);
+
+  // Cast all rays of the spinning lidar.
+  frame.cloud.reserve(config_.num_rings * config_.num_columns);
+  frame.object_ids.reserve(config_.num_rings * config_.num_columns);
+  const float deg_to_rad = M_PI / 180.f;
+  for (int ring = 0; ring < config_.num_rings; ++ring) {
+    const float elevation =
+        deg_to_rad *
+        (config_.min_elevation + (config_.max_elevation -
+                                  config_.min_elevation) *
+                                     ring / (config_.num_rings - 1));
+    for (int column = 0; column < config_.num_columns; ++column) {
+      const float azimuth = 2.f * M_PI * column / config_.num_columns;
+      const voxblox::Point direction(std::cos(elevation) * std::cos(azimuth),
+                                     std::cos(elevation) * std::sin(azimuth),
+                                     std::sin(elevation));
+      const voxblox::Point inverse_direction = direction.cwiseInverse();
+
+      // Static scene.
+      float range = kNoHit;
+      int object_id = -1;
+      if (direction.z() < 0.f) {
+        range = -origin.z() / direction.z();
+      }
+      for (const Box& box : static_boxes_) {
+        range = std::min(range, intersectBox(origin, inverse_direction,
+                                             box.min_corner, box.max_corner));
+      }
+
+      // Dynamic objects.
+      for (size_t i = 0; i < objects_.size(); ++i) {
+        const DynamicObject& object = objects_[i];
+        float object_range;
+        if (object.is_pedestrian) {
+          object_range =
+              intersectCylinder(origin, direction, object_positions[i],
+                                object.size.x() / 2.f, object.size.z());
+        } else {
+          const voxblox::Point half_extent(object.size.x() / 2.f,
+                                           object.size.y() / 2.f, 0.f);
+          object_range = intersectBox(
+              origin, inverse_direction, object_positions[i] - half_extent,
+              object_positions[i] + half_extent +
+                  voxblox::Point(0.f, 0.f, object.size.z()));
+        }
+        if (object_range < range) {
+          range = object_range;
+          object_id = i;
+        }
+      }
+
+      // Store the measurement in sensor frame.
+      if (range < config_.min_range || range > config_.max_range) {
+        continue;
+      }
+      if (config_.range_noise > 0.f) {
+        range += noise(generator);
+      }
+      const voxblox::Point point = range * direction;
+      frame.cloud.push_back(Point(point.x(), point.y(), point.z()));
+      frame.object_ids.push_back(object_id);
+    }
+  }
+  return frame;
+}
+
+bool SceneGenerator::writeSequence(const std::string& directory,
+                                   const int num_threads) const {
+  // Setup the output files.
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  const std::string clouds_file = directory + "/clouds.bin";
+  CloudFileWriter cloud_writer(clouds_file);
+  std::ofstream indices_file(directory + "/indices.csv");
+  std::ofstream poses_file(directory + "/poses.csv");
+  if (!indices_file.is_open() || !poses_file.is_open() ||
+      !cloud_writer.isOpen()) {
+    LOG(ERROR) << "Could not write to directory '" << directory << "'.";
+    return false;
+  }
+  poses_file << "Timestamp,X,Y,Z,QX,QY,QZ,QW\n";
+  poses_file.precision(9);
+
+  // Generate batches of frames in parallel and write them in order.
+  const int batch_size = std::max(num_threads, 1);
+  for (int batch = 0; batch < config_.num_frames; batch += batch_size) {
+    std::vector<std::future<SyntheticFrame>> frames;
+    for (int i = batch; i < std::min(batch + batch_size, config_.num_frames);
+         ++i) {
+      frames.emplace_back(std::async(std::launch::async,
+                                     [this, i]() { return generateFrame(i); }));
+    }
+    for (size_t i = 0; i < frames.size(); ++i) {
+      const SyntheticFrame frame = frames[i].get();
+
+      // Ground truth in DOALS format: timestamp followed by dynamic indices.
+      indices_file << frame.timestamp;
+      for (size_t j = 0; j < frame.object_ids.size(); ++j) {
+        if (frame.object_ids[j] >= 0) {
+          indices_file << "," << j;
+        }
+      }
+      indices_file << "\n";
+
+      const tf::Vector3& position = frame.T_M_S.getOrigin();
+      const tf::Quaternion rotation = frame.T_M_S.getRotation();
+      poses_file << frame.timestamp << "," << position.x() << ","
+                 << position.y() << "," << position.z() << "," << rotation.x()
+                 << "," << rotation.y() << "," << rotation.z() << ","
+                 << rotation.w() << "\n";
+
+      Cloud cloud;
+      CloudInfo cloud_info;
+      toLabeledCloud(frame, cloud, cloud_info);
+      if (!cloud_writer.writeFrame(cloud, cloud_info, Clusters(), batch + i)) {
+        LOG(ERROR) << "Could not write '" << clouds_file << "'.";
+        return false;
+      }
+    }
+  }
+  LOG(INFO) << "Wrote " << config_.num_frames << " frames to '" << directory
+            << "'.";
+  return indices_file.good() && poses_file.good();
+}
+
+void SceneGenerator::toLabeledCloud(const SyntheticFrame& frame, Cloud& cloud,
+                                    CloudInfo& cloud_info) {
+  static const Preprocessing preprocessing((Preprocessing::Config()));
+  cloud = frame.cloud;
+  preprocessing.processPointcloud(frame.timestamp, frame.T_M_S, cloud,
+                                  cloud_info);
+  cloud_info.has_labels = true;
+  for (size_t i = 0; i < frame.object_ids.size(); ++i) {
+    cloud_info.points[i].ground_truth_dynamic = frame.object_ids[i] >= 0;
+  }
+}
+
+voxblox::Point SceneGenerator::getSensorPosition(const int frame_index) const {
+  const float length = config_.sensor_distance;
+  float travelled = 0.f;
+  if (length > 0.f) {
+    travelled = std::fmod(config_.sensor_speed * frame_index /
+                              config_.frame_rate,
+                          2.f * length);
+  }
+  const float x = travelled < length ? travelled : 2.f * length - travelled;
+  return voxblox::Point(x - length / 2.f, 0.f, config_.sensor_height);
+}
+
+voxblox::Point SceneGenerator::getObjectPosition(const DynamicObject& object,
+                                                 const int frame_index) const {
+  const voxblox::Point segment = object.end - object.start;
+  const float length = segment.norm();
+  if (length <= 0.f) {
+    return object.start;
+  }
+  const float travelled =
+      std::fmod(object.phase + config_.object_speed * frame_index /
+                                   config_.frame_rate,
+                2.f * length);
+  const float distance =
+      travelled < length ? travelled : 2.f * length - travelled;
+  return object.start + segment * (distance / length);
+}
+
+}  // namespace dynablox
@@ -1,8 +1,10 @@
 #ifndef DYNABLOX_ROS_MOTION_DETECTOR_H_
 #define DYNABLOX_ROS_MOTION_DETECTOR_H_
 
+#include <atomic>
 #include <deque>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <thread>
 #include <utility>
@@ -11,19 +13,26 @@
 #include <pcl_conversions/pcl_conversions.h>
 #include <pcl_ros/point_cloud.h>
 #include <ros/ros.h>
+#include <std_msgs/Int32.h>
 #include <voxblox/core/block_hash.h>
 #include <voxblox/core/common.h>
 #include <voxblox_ros/tsdf_server.h>
 
 #include "dynablox/3rd_party/config_utilities.hpp"
-#include "dynablox/common/index_getter.h"
+#include "dynablox/common/frame_arena.h"
+#include "dynablox/common/latest_frame_scheduler.h"
+#include "dynablox/common/memory_monitor.h"
+#include "dynablox/common/shared_memory_adapter.h"
+#include "dynablox/common/stage_timer.h"
 #include "dynablox/common/types.h"
 #include "dynablox/evaluation/evaluator.h"
 #include "dynablox/evaluation/ground_truth_handler.h"
-#include "dynablox/processing/clustering.h"
-#include "dynablox/processing/ever_free_integrator.h"
+#include "dynablox/map/block_eviction.h"
+#include "dynablox/map/ever_free_layer.h"
+#include "dynablox/map/map_checkpoint.h"
+#include "dynablox/processing/adaptive_quality_controller.h"
+#include "dynablox/processing/detection_pipeline.h"
 #include "dynablox/processing/preprocessing.h"
-#include "dynablox/processing/tracking.h"
 #include "dynablox_ros/visualization/motion_visualizer.h"
 
 namespace dynablox {
@@ -52,9 +61,28 @@ class MotionDetector {
     // Number of threads to use.
     int num_threads = std::thread::hardware_concurrency();
 
+    // If true, allocate transient per-frame data such as the point map and
+    // clusters from a frame arena that is reset after each frame.
+    bool use_frame_arena = true;
+
     // If >0, shutdown after this many evaluated frames.
     int shutdown_after = 0;
 
+    // How to handle scans arriving while a scan is processed. 'none' processes
+    // every scan in the subscriber queue. 'drop' always processes the newest
+    // scan and drops the others, 'integrate' additionally integrates the most
+    // recent skipped scans into the map without running detection on them.
+    std::string frame_skip_policy = "none";
+
+    // Maximum number of skipped scans integrated before the newest scan.
+    int max_skipped_frames_to_integrate = 2;
+
+    // If set, load the map from this checkpoint file at startup.
+    std::string load_map_path = "";
+
+    // If set, save the map to this checkpoint file at shutdown.
+    std::string save_map_path = "";
+
     Config() { setConfigName("MotionDetector"); }
 
    protected:
@@ -65,63 +93,66 @@ class MotionDetector {
   // Constructor.
   MotionDetector(const ros::NodeHandle& nh, const ros::NodeHandle& nh_private);
 
+  // Destructor. Saves the map and final metrics if requested.
+  ~MotionDetector();
+
   // Setup.
   void setupMembers();
   void setupRos();
 
+  // Map checkpoints.
+  bool saveMap(const std::string& file_name) const;
+  bool loadMap(const std::string& file_name);
+
+  // Last memory report, computed periodically if memory monitoring is enabled.
+  MemoryReport getMemoryReport() const {
+    return memory_monitor_->getReport();
+  }
+
   // Callbacks.
   void pointcloudCallback(const sensor_msgs::PointCloud2::Ptr& msg);
 
-  // Motion detection pipeline.
-  bool lookupTransform(const std::string& target_frame,
-                       const std::string& source_frame, uint64_t timestamp,
-                       tf::StampedTransform& result) const;
+  // Reads scans from shared memory until the node shuts down.
+  void sharedMemoryLoop();
 
-  /**
-   * @brief Create a mapping of each voxel index to the points it contains. Each
-   * point will be checked whether it falls into an ever-free voxel and updates
-   * voxel occupancy, since we go through voxels anyways already.
-   *
-   * @param cloud Complete point cloud to look up positions.
-   * @param point_map Resulting map.
-   * @param occupied_ever_free_voxel_indices Indices of voxels containing
-   * ever-free points.
-   * @param cloud_info Cloud info to store ever-free flags of checked points.
-   */
-  void setUpPointMap(
-      const Cloud& cloud, BlockToPointMap& point_map,
-      std::vector<voxblox::VoxelKey>& occupied_ever_free_voxel_indices,
-      CloudInfo& cloud_info) const;
+  // Hand scans to the frame scheduler and process the newest scan.
+  void schedulePointcloud(const sensor_msgs::PointCloud2::Ptr& msg);
+  void scheduledProcessingLoop();
+
+  // Integrate a scan into the map without running detection.
+  void integrateSkippedPointcloud(const sensor_msgs::PointCloud2::Ptr& msg);
 
   /**
-   * @brief Create a mapping of each block to ids of points that fall into it.
+   * @brief Run motion detection on a preprocessed scan and integrate it into
+   * the map. The detection itself is run by the DetectionPipeline.
    *
-   * @param cloud Points to process.
-   * @return Mapping of block to point ids in cloud.
+   * @param T_M_S Transform sensor (S) to map (M).
+   * @param cloud Preprocessed point cloud in map frame.
+   * @param cloud_info Cloud info to store the detections.
+   * @return The detected clusters.
    */
-  voxblox::HierarchicalIndexIntMap buildBlockToPointsMap(
-      const Cloud& cloud) const;
+  Clusters processFrame(const tf::Transform& T_M_S, const Cloud& cloud,
+                        CloudInfo& cloud_info);
 
   /**
-   * @brief Create a mapping of each voxel index to the points it contains. Each
-   * point will be checked whether it falls into an ever-free voxel and updates
-   * voxel occupancy, since we go through voxels anyways already. This function
-   * operates on a single block for data parallelism.
+   * @brief Evaluate and visualize the results of a frame and evict blocks.
    *
-   * @param cloud Complete point cloud to look up positions.
-   * @param block_index Index of the block to be processed.
-   * @param points_in_block Indices of all points in the block.
-   * @param point_map Where to store the resulting point map for this block.
-   * @param occupied_ever_free_voxel_indices Where to store the indices of ever
-   * free voxels in this block.
-   * @param cloud_info Cloud info to store ever-free flags of checked points.
+   * @param cloud Processed point cloud in map frame.
+   * @param cloud_info Cloud info containing the detections, labeled with the
+   * ground truth if evaluating.
+   * @param clusters The detected clusters.
+   * @param processing_time Time from the start of processing the scan,
+   * including the transform lookup and preprocessing, until the detection
+   * finished [s]. Time spent waiting in the frame scheduler or the subscriber
+   * queue is not included.
    */
-  void blockwiseBuildPointMap(
-      const Cloud& cloud, const BlockIndex& block_index,
-      const voxblox::AlignedVector<size_t>& points_in_block,
-      VoxelToPointMap& point_map,
-      std::vector<voxblox::VoxelKey>& occupied_ever_free_voxel_indices,
-      CloudInfo& cloud_info) const;
+  void finishFrame(const Cloud& cloud, CloudInfo& cloud_info,
+                   const Clusters& clusters, double processing_time);
+
+  // Motion detection pipeline.
+  bool lookupTransform(const std::string& target_frame,
+                       const std::string& source_frame, uint64_t timestamp,
+                       tf::StampedTransform& result) const;
 
  private:
   const Config config_;
@@ -130,26 +161,40 @@ class MotionDetector {
   ros::NodeHandle nh_;
   ros::NodeHandle nh_private_;
   ros::Subscriber lidar_pcl_sub_;
+  ros::Publisher quality_level_pub_;
   tf::TransformListener tf_listener_;
 
+  // Frame scheduler, if configured.
+  std::unique_ptr<LatestFrameScheduler<sensor_msgs::PointCloud2::Ptr>>
+      scheduler_;
+
+  // Shared memory input, if configured.
+  std::shared_ptr<SharedMemoryAdapter> shared_memory_adapter_;
+  std::thread input_thread_;
+  std::atomic<bool> stop_input_{false};
+
   // Voxblox map.
   std::shared_ptr<voxblox::TsdfServer> tsdf_server_;
   std::shared_ptr<TsdfLayer> tsdf_layer_;
+  std::shared_ptr<EverFreeLayer> ever_free_layer_;
+  std::shared_ptr<BlockEviction> block_eviction_;
+  std::shared_ptr<MemoryMonitor> memory_monitor_;
+
+  // Memory of transient per-frame data, the arena or the default heap.
+  FrameArena frame_arena_;
+  std::pmr::memory_resource* frame_resource_ =
+      std::pmr::get_default_resource();
 
   // Processing.
   std::shared_ptr<Preprocessing> preprocessing_;
-  std::shared_ptr<EverFreeIntegrator> ever_free_integrator_;
-  std::shared_ptr<Clustering> clustering_;
-  std::shared_ptr<Tracking> tracking_;
+  std::unique_ptr<DetectionPipeline> pipeline_;
+  std::shared_ptr<AdaptiveQualityController> quality_controller_;
   std::shared_ptr<Evaluator> evaluator_;
   std::shared_ptr<MotionVisualizer> visualizer_;
 
   // Cached data.
   size_t voxels_per_side_;
   size_t voxels_per_block_;
-
-  // Variables.
-  int frame_counter_ = 0;
 };
 
 }  // namespace dynablox
@@ -17,6 +17,7 @@
 
 #include "dynablox/3rd_party/config_utilities.hpp"
 #include "dynablox/common/types.h"
+#include "dynablox/map/ever_free_layer.h"
 
 namespace dynablox {
 
@@ -72,10 +73,14 @@ class MotionVisualizer {
   };
 
   // Setup.
-  MotionVisualizer(ros::NodeHandle nh, std::shared_ptr<TsdfLayer> tsdf_layer);
+  MotionVisualizer(ros::NodeHandle nh, std::shared_ptr<TsdfLayer> tsdf_layer,
+                   std::shared_ptr<EverFreeLayer> ever_free_layer);
 
   void setupRos();
 
+  // Drop visualization data of blocks that were removed from the map.
+  void removeBlocks(const voxblox::BlockIndexList& block_indices);
+
   // Visualization.
   void visualizeAll(const Cloud& cloud, const CloudInfo& cloud_info,
                     const Clusters& clusters);
@@ -100,6 +105,12 @@ class MotionVisualizer {
   void visualizeClusters(const Clusters& clusters,
                          const std::string& ns = "") const;
 
+  // Memory used by the mesh layer.
+  size_t getNumberOfMeshBlocks() const {
+    return mesh_layer_->getNumberOfAllocatedMeshes();
+  }
+  size_t getMeshMemorySize() const { return mesh_layer_->getMemorySize(); }
+
   // ROS msg helper tools.
   static geometry_msgs::Vector3 setScale(const float scale);
   static std_msgs::ColorRGBA setColor(const std::vector<float>& color);
@@ -112,6 +123,7 @@ class MotionVisualizer {
   voxblox::ExponentialOffsetIdColorMap color_map_;
   ros::NodeHandle nh_;
   std::shared_ptr<TsdfLayer> tsdf_layer_;
+  std::shared_ptr<EverFreeLayer> ever_free_layer_;
   std::shared_ptr<voxblox::MeshIntegrator<TsdfVoxel>> mesh_integrator_;
   std::shared_ptr<voxblox::MeshLayer> mesh_layer_;
 
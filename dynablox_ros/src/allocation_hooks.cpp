@@ -0,0 +1,95 @@
+// Replaces the global operator new and delete to count heap allocations for
+// the memory monitor. Only linked into executables, counting is disabled until
+// requested by the memory monitor.
+
+#include <malloc.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "dynablox/common/allocation_counter.h"
+
+namespace {
+
+void* allocate(std::size_t size) {
+  void* ptr = std::malloc(size == 0u ? 1u : size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  dynablox::AllocationCounter::recordAllocation(malloc_usable_size(ptr));
+  return ptr;
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+  void* ptr = nullptr;
+  if (posix_memalign(&ptr,
+                     std::max(static_cast<std::size_t>(alignment),
+                              sizeof(void*)),
+                     size == 0u ? 1u : size) != 0) {
+    throw std::bad_alloc();
+  }
+  dynablox::AllocationCounter::recordAllocation(malloc_usable_size(ptr));
+  return ptr;
+}
+
+void deallocate(void* ptr) noexcept {
+  if (ptr) {
+    dynablox::AllocationCounter::recordDeallocation(malloc_usable_size(ptr));
+    std::free(ptr);
+  }
+}
+
+// Register the hooks before main.
+const bool kHooksInstalled = []() {
+  dynablox::AllocationCounter::setInstalled();
+  return true;
+}();
+
+}  // namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return allocate(size);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return allocate(size);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return allocateAligned(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return allocateAligned(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  deallocate(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  deallocate(ptr);
+}
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  deallocate(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+  deallocate(ptr);
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+  deallocate(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+  deallocate(ptr);
+}
@@ -2,10 +2,8 @@
 
 #include <math.h>
 
-#include <future>
-#include <mutex>
+#include <chrono>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include <minkindr_conversions/kindr_tf.h>
@@ -18,16 +16,23 @@
 #include <tf2_ros/buffer.h>
 #include <tf2_ros/transform_listener.h>
 #include <visualization_msgs/Marker.h>
+#include <voxblox_ros/ros_params.h>
 
 namespace dynablox {
 
-using Timer = voxblox::timing::Timer;
+using Timer = StageTimer;
 
 void MotionDetector::Config::checkParams() const {
   checkParamCond(!global_frame_name.empty(),
                  "'global_frame_name' may not be empty.");
   checkParamGE(num_threads, 1, "num_threads");
   checkParamGE(queue_size, 0, "queue_size");
+  checkParamCond(frame_skip_policy == "none" || frame_skip_policy == "drop" ||
+                     frame_skip_policy == "integrate",
+                 "'frame_skip_policy' must be 'none', 'drop', or "
+                 "'integrate'.");
+  checkParamGE(max_skipped_frames_to_integrate, 0,
+               "max_skipped_frames_to_integrate");
 }
 
 void MotionDetector::Config::setupParamsAndPrinting() {
@@ -38,7 +43,13 @@ void MotionDetector::Config::setupParamsAndPrinting() {
   setupParam("visualize", &visualize);
   setupParam("verbose", &verbose);
   setupParam("num_threads", &num_threads);
+  setupParam("use_frame_arena", &use_frame_arena);
   setupParam("shutdown_after", &shutdown_after);
+  setupParam("frame_skip_policy", &frame_skip_policy);
+  setupParam("max_skipped_frames_to_integrate",
+             &max_skipped_frames_to_integrate);
+  setupParam("load_map_path", &load_map_path);
+  setupParam("save_map_path", &save_map_path);
 }
 
 MotionDetector::MotionDetector(const ros::NodeHandle& nh,
@@ -50,6 +61,11 @@ MotionDetector::MotionDetector(const ros::NodeHandle& nh,
       nh_private_(nh_private) {
   setupMembers();
 
+  // Warm-start from a previously saved map.
+  if (!config_.load_map_path.empty()) {
+    loadMap(config_.load_map_path);
+  }
+
   // Cache frequently used constants.
   voxels_per_side_ = tsdf_layer_->voxels_per_side();
   voxels_per_block_ = voxels_per_side_ * voxels_per_side_ * voxels_per_side_;
@@ -62,7 +78,57 @@ MotionDetector::MotionDetector(const ros::NodeHandle& nh,
                                 << config_utilities::Global::printAllConfigs();
 }
 
+MotionDetector::~MotionDetector() {
+  stop_input_ = true;
+  if (scheduler_) {
+    scheduler_->stop();
+  }
+  if (input_thread_.joinable()) {
+    input_thread_.join();
+  }
+  if (!config_.save_map_path.empty()) {
+    saveMap(config_.save_map_path);
+  }
+  LatencyMetrics::shutdown();
+  TraceRecorder::shutdown();
+}
+
+bool MotionDetector::saveMap(const std::string& file_name) const {
+  Timer save_timer("save_map");
+  if (!saveMapCheckpoint(file_name, *tsdf_layer_, *ever_free_layer_,
+                         pipeline_->getFrameCounter())) {
+    return false;
+  }
+  LOG_IF(INFO, config_.verbose)
+      << "Saved " << tsdf_layer_->getNumberOfAllocatedBlocks()
+      << " blocks to '" << file_name << "'.";
+  return true;
+}
+
+bool MotionDetector::loadMap(const std::string& file_name) {
+  // Ever-free stamps are relative to the frame counter, so resume counting
+  // from the saved frame.
+  Timer load_timer("load_map");
+  int frame_counter = pipeline_->getFrameCounter();
+  if (!loadMapCheckpoint(file_name, *tsdf_layer_, *ever_free_layer_,
+                         frame_counter, config_.num_threads)) {
+    return false;
+  }
+  pipeline_->setFrameCounter(frame_counter);
+  return true;
+}
+
 void MotionDetector::setupMembers() {
+  // Tracing of all timed stages and worker threads.
+  TraceRecorder::setup(
+      config_utilities::getConfigFromRos<TraceRecorder::Config>(
+          ros::NodeHandle(nh_private_, "tracing")));
+
+  // Latency histograms of all timed stages.
+  LatencyMetrics::setup(
+      config_utilities::getConfigFromRos<LatencyMetrics::Config>(
+          ros::NodeHandle(nh_private_, "metrics")));
+
   // Voxblox. Overwrite dependent config parts. Note that this TSDF layer is
   // shared with all other processing components and is mutable for processing.
   ros::NodeHandle nh_voxblox(nh_private_, "voxblox");
@@ -77,29 +143,63 @@ void MotionDetector::setupMembers() {
   tsdf_server_ = std::make_shared<voxblox::TsdfServer>(nh_voxblox, nh_voxblox);
   tsdf_layer_.reset(tsdf_server_->getTsdfMapPtr()->getTsdfLayerPtr());
 
+  // Ever-free state, stored in a separate layer parallel to the TSDF layer.
+  ever_free_layer_ =
+      std::make_shared<EverFreeLayer>(tsdf_layer_->voxels_per_side());
+
+  // Eviction of far away or stale blocks to bound the map size. Stored blocks
+  // need to be reloaded out to where the integration allocates new blocks,
+  // plus the sensor motion until the next reload (one block diagonal) and the
+  // block center offset (half a block diagonal).
+  const voxblox::TsdfIntegratorBase::Config integrator_config =
+      voxblox::getTsdfIntegratorConfigFromRosParam(nh_voxblox);
+  const float block_diagonal = tsdf_layer_->block_size() * std::sqrt(3.f);
+  nh_private_.setParam("block_eviction/block_store/max_allocation_distance",
+                       integrator_config.max_ray_length_m +
+                           integrator_config.default_truncation_distance +
+                           1.5f * block_diagonal);
+  block_eviction_ = std::make_shared<BlockEviction>(
+      config_utilities::getConfigFromRos<BlockEviction::Config>(
+          ros::NodeHandle(nh_private_, "block_eviction")),
+      tsdf_layer_, ever_free_layer_);
+
+  // Memory accounting of the map and per-frame structures.
+  memory_monitor_ = std::make_shared<MemoryMonitor>(
+      config_utilities::getConfigFromRos<MemoryMonitor::Config>(
+          ros::NodeHandle(nh_private_, "memory_monitor")),
+      tsdf_layer_, ever_free_layer_);
+  if (config_.use_frame_arena) {
+    frame_resource_ = &frame_arena_;
+  }
+
   // Preprocessing.
   preprocessing_ = std::make_shared<Preprocessing>(
       config_utilities::getConfigFromRos<Preprocessing::Config>(
           ros::NodeHandle(nh_private_, "preprocessing")));
 
-  // Clustering.
-  clustering_ = std::make_shared<Clustering>(
-      config_utilities::getConfigFromRos<Clustering::Config>(
-          ros::NodeHandle(nh_private_, "clustering")),
-      tsdf_layer_);
-
-  // Tracking.
-  tracking_ = std::make_shared<Tracking>(
-      config_utilities::getConfigFromRos<Tracking::Config>(
-          ros::NodeHandle(nh_private_, "tracking")));
-
-  // Ever-Free Integrator.
-  ros::NodeHandle nh_ever_free(nh_private_, "ever_free_integrator");
-  nh_ever_free.setParam("num_threads", config_.num_threads);
-  ever_free_integrator_ = std::make_shared<EverFreeIntegrator>(
-      config_utilities::getConfigFromRos<EverFreeIntegrator::Config>(
-          nh_ever_free),
-      tsdf_layer_);
+  // Detection pipeline on the voxblox map. The processing components read
+  // their configs from their namespaces, the voxblox integrator config and
+  // method and the block removal are taken from the voxblox server parameters.
+  auto pipeline_config =
+      config_utilities::getConfigFromRos<DetectionPipeline::Config>(
+          nh_private_);
+  pipeline_config.num_threads = config_.num_threads;
+  pipeline_config.voxel_size = tsdf_layer_->voxel_size();
+  pipeline_config.voxels_per_side = tsdf_layer_->voxels_per_side();
+  nh_voxblox.param("method", pipeline_config.voxblox_integrator_method,
+                   std::string("merged"));
+  nh_voxblox.param("max_block_distance_from_body",
+                   pipeline_config.max_block_distance_from_body,
+                   pipeline_config.max_block_distance_from_body);
+  pipeline_ = std::make_unique<DetectionPipeline>(
+      pipeline_config, tsdf_layer_, ever_free_layer_, integrator_config);
+  pipeline_->setFrameResource(frame_resource_);
+  pipeline_->setMemoryMonitor(memory_monitor_);
+
+  // Adaptive quality control to meet the frame time budget.
+  quality_controller_ = std::make_shared<AdaptiveQualityController>(
+      config_utilities::getConfigFromRos<AdaptiveQualityController::Config>(
+          ros::NodeHandle(nh_private_, "adaptive_quality")));
 
   // Evaluation.
   if (config_.evaluate) {
@@ -110,18 +210,58 @@ void MotionDetector::setupMembers() {
             ros::NodeHandle(nh_private_, "evaluation")));
   }
 
+  // Frame scheduling.
+  if (config_.frame_skip_policy != "none") {
+    scheduler_ = std::make_unique<
+        LatestFrameScheduler<sensor_msgs::PointCloud2::Ptr>>(
+        config_.frame_skip_policy == "integrate"
+            ? config_.max_skipped_frames_to_integrate
+            : 0);
+  }
+
+  // Shared memory input.
+  ros::NodeHandle nh_shared_memory(nh_private_, "shared_memory");
+  const auto shared_memory_config =
+      config_utilities::getConfigFromRos<SharedMemoryAdapter::Config>(
+          nh_shared_memory);
+  if (!shared_memory_config.scan_ring_name.empty()) {
+    shared_memory_adapter_ =
+        std::make_shared<SharedMemoryAdapter>(shared_memory_config);
+  }
+
   // Visualization.
   visualizer_ = std::make_shared<MotionVisualizer>(
-      ros::NodeHandle(nh_private_, "visualization"), tsdf_layer_);
+      ros::NodeHandle(nh_private_, "visualization"), tsdf_layer_,
+      ever_free_layer_);
 }
 
 void MotionDetector::setupRos() {
+  if (quality_controller_->isEnabled()) {
+    quality_level_pub_ = nh_private_.advertise<std_msgs::Int32>(
+        "quality_level", config_.queue_size);
+  }
+
+  // Scans are read either from shared memory or from the ROS topic.
+  if (shared_memory_adapter_) {
+    input_thread_ = std::thread(&MotionDetector::sharedMemoryLoop, this);
+    return;
+  }
+  if (scheduler_) {
+    input_thread_ =
+        std::thread(&MotionDetector::scheduledProcessingLoop, this);
+    lidar_pcl_sub_ = nh_.subscribe("pointcloud", config_.queue_size,
+                                   &MotionDetector::schedulePointcloud, this);
+    return;
+  }
   lidar_pcl_sub_ = nh_.subscribe("pointcloud", config_.queue_size,
                                  &MotionDetector::pointcloudCallback, this);
 }
 
 void MotionDetector::pointcloudCallback(
     const sensor_msgs::PointCloud2::Ptr& msg) {
+  // Released after all per-frame data went out of scope.
+  const FrameArena::ResetGuard arena_guard(frame_arena_);
+  const auto frame_start = std::chrono::steady_clock::now();
   Timer frame_timer("frame");
   Timer detection_timer("motion_detection");
 
@@ -142,48 +282,133 @@ void MotionDetector::pointcloudCallback(
 
   // Preprocessing.
   Timer preprocessing_timer("motion_detection/preprocessing");
-  frame_counter_++;
-  CloudInfo cloud_info;
+  CloudInfo cloud_info(frame_resource_);
   Cloud cloud;
   preprocessing_->processPointcloud(msg, T_M_S, cloud, cloud_info);
   preprocessing_timer.Stop();
 
-  // Build a mapping of all blocks to voxels to points for the scan.
-  Timer setup_timer("motion_detection/indexing_setup");
-  BlockToPointMap point_map;
-  std::vector<voxblox::VoxelKey> occupied_ever_free_voxel_indices;
-  setUpPointMap(cloud, point_map, occupied_ever_free_voxel_indices, cloud_info);
-  setup_timer.Stop();
-
-  // Clustering.
-  Timer clustering_timer("motion_detection/clustering");
-  Clusters clusters = clustering_->performClustering(
-      point_map, occupied_ever_free_voxel_indices, frame_counter_, cloud,
-      cloud_info);
-  clustering_timer.Stop();
-
-  // Tracking.
-  Timer tracking_timer("motion_detection/tracking");
-  tracking_->track(cloud, clusters, cloud_info);
-  tracking_timer.Stop();
-
-  // Integrate ever-free information.
-  Timer update_ever_free_timer("motion_detection/update_ever_free");
-  ever_free_integrator_->updateEverFreeVoxels(frame_counter_);
-  update_ever_free_timer.Stop();
-
-  // Integrate the pointcloud into the voxblox TSDF map.
-  Timer tsdf_timer("motion_detection/tsdf_integration");
-  voxblox::Transformation T_G_C;
-  tf::transformTFToKindr(T_M_S, &T_G_C);
-  tsdf_server_->processPointCloudMessageAndInsert(msg, T_G_C, false);
-  tsdf_timer.Stop();
+  // Detection.
+  Clusters clusters = processFrame(T_M_S, cloud, cloud_info);
   detection_timer.Stop();
+  finishFrame(cloud, cloud_info, clusters,
+              std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            frame_start)
+                  .count());
+}
+
+void MotionDetector::schedulePointcloud(
+    const sensor_msgs::PointCloud2::Ptr& msg) {
+  scheduler_->push(msg);
+}
+
+void MotionDetector::scheduledProcessingLoop() {
+  sensor_msgs::PointCloud2::Ptr msg;
+  std::vector<sensor_msgs::PointCloud2::Ptr> skipped_msgs;
+  while (scheduler_->waitForLatest(msg, skipped_msgs)) {
+    // Keep the map up to date with the skipped scans, oldest first.
+    for (const auto& skipped_msg : skipped_msgs) {
+      integrateSkippedPointcloud(skipped_msg);
+    }
+    pointcloudCallback(msg);
+
+    // Report end-to-end latency and skipped scans.
+    scheduler_->recordLatency((ros::Time::now() - msg->header.stamp).toSec());
+    const auto statistics = scheduler_->getStatistics();
+    LOG_IF(INFO, config_.verbose && statistics.num_processed % 100 == 0)
+        << "Processed " << statistics.num_processed << " of "
+        << statistics.num_received << " scans (" << statistics.num_skipped
+        << " skipped), latency mean " << statistics.mean_latency
+        << "s, max " << statistics.max_latency << "s.";
+  }
+}
+
+void MotionDetector::integrateSkippedPointcloud(
+    const sensor_msgs::PointCloud2::Ptr& msg) {
+  Timer integrate_timer("motion_detection/integrate_skipped");
+  const std::string sensor_frame_name = config_.sensor_frame_name.empty()
+                                            ? msg->header.frame_id
+                                            : config_.sensor_frame_name;
+  tf::StampedTransform T_M_S;
+  if (!lookupTransform(config_.global_frame_name, sensor_frame_name,
+                       msg->header.stamp.toNSec(), T_M_S)) {
+    return;
+  }
+
+  // Integrate all points, no labels are available for skipped scans.
+  CloudInfo cloud_info;
+  Cloud cloud;
+  preprocessing_->processPointcloud(msg, T_M_S, cloud, cloud_info);
+  quality_controller_->selectPoints(cloud_info);
+  block_eviction_->reloadBlocks(cloud_info.sensor_position);
+  pipeline_->integrateStaticPoints(T_M_S, cloud, cloud_info);
+}
 
+void MotionDetector::sharedMemoryLoop() {
+  Cloud cloud;
+  uint64_t timestamp;
+  tf::Transform T_M_S;
+  while (!stop_input_ && ros::ok()) {
+    // Wait for the producer to create the ring and send scans.
+    if (!shared_memory_adapter_->connect() ||
+        !shared_memory_adapter_->readScan(cloud, timestamp, T_M_S)) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      continue;
+    }
+    const FrameArena::ResetGuard arena_guard(frame_arena_);
+    const auto frame_start = std::chrono::steady_clock::now();
+    Timer frame_timer("frame");
+    Timer detection_timer("motion_detection");
+
+    // Preprocessing.
+    Timer preprocessing_timer("motion_detection/preprocessing");
+    CloudInfo cloud_info(frame_resource_);
+    preprocessing_->processPointcloud(timestamp, T_M_S, cloud, cloud_info);
+    preprocessing_timer.Stop();
+
+    // Detection.
+    Clusters clusters = processFrame(T_M_S, cloud, cloud_info);
+    detection_timer.Stop();
+    shared_memory_adapter_->writeLabels(cloud_info);
+    finishFrame(cloud, cloud_info, clusters,
+                std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - frame_start)
+                    .count());
+  }
+}
+
+Clusters MotionDetector::processFrame(const tf::Transform& T_M_S,
+                                      const Cloud& cloud,
+                                      CloudInfo& cloud_info) {
+  memory_monitor_->startFrame();
+
+  // Adapt the quality to the timings of the previous frames.
+  if (quality_controller_->update()) {
+    pipeline_->setApproximateSeparation(
+        quality_controller_->approximateSeparation());
+  }
+  quality_controller_->selectPoints(cloud_info);
+  if (quality_controller_->isEnabled()) {
+    std_msgs::Int32 level_msg;
+    level_msg.data = quality_controller_->getLevel();
+    quality_level_pub_.publish(level_msg);
+  }
+
+  // Page previously evicted blocks near the sensor back in.
+  Timer reload_timer("motion_detection/reload_blocks");
+  block_eviction_->reloadBlocks(cloud_info.sensor_position);
+  reload_timer.Stop();
+
+  // Indexing, clustering, tracking, ever-free update, and TSDF integration.
+  return pipeline_->processFrame(T_M_S, cloud, cloud_info);
+}
+
+void MotionDetector::finishFrame(const Cloud& cloud, CloudInfo& cloud_info,
+                                 const Clusters& clusters,
+                                 const double processing_time) {
   // Evaluation if requested.
   if (config_.evaluate) {
     Timer eval_timer("evaluation");
-    evaluator_->evaluateFrame(cloud, cloud_info, clusters);
+    evaluator_->evaluateFrame(cloud, cloud_info, clusters, processing_time);
     eval_timer.Stop();
     if (config_.shutdown_after > 0 &&
         evaluator_->getNumberOfEvaluatedFrames() >= config_.shutdown_after) {
@@ -194,11 +419,27 @@ void MotionDetector::pointcloudCallback(
   }
 
   // Visualization if requested.
-  if (config_.visualize) {
+  if (config_.visualize && quality_controller_->visualize()) {
     Timer vis_timer("visualizations");
     visualizer_->visualizeAll(cloud, cloud_info, clusters);
     vis_timer.Stop();
   }
+
+  // Evict blocks once all results of this frame are published.
+  Timer eviction_timer("block_eviction");
+  const voxblox::BlockIndexList evicted_blocks =
+      block_eviction_->evictBlocks(cloud_info.sensor_position,
+                                   pipeline_->getFrameCounter());
+  visualizer_->removeBlocks(evicted_blocks);
+  eviction_timer.Stop();
+
+  // Memory accounting.
+  if (memory_monitor_->isEnabled() &&
+      memory_monitor_->finishFrame(pipeline_->getFrameCounter(),
+                                   visualizer_->getNumberOfMeshBlocks(),
+                                   visualizer_->getMeshMemorySize())) {
+    LOG(INFO) << memory_monitor_->getReport().print();
+  }
 }
 
 bool MotionDetector::lookupTransform(const std::string& target_frame,
@@ -221,118 +462,4 @@ bool MotionDetector::lookupTransform(const std::string& target_frame,
   return true;
 }
 
-void MotionDetector::setUpPointMap(
-    const Cloud& cloud, BlockToPointMap& point_map,
-    std::vector<voxblox::VoxelKey>& occupied_ever_free_voxel_indices,
-    CloudInfo& cloud_info) const {
-  // Identifies for any LiDAR point the block it falls in and constructs the
-  // hash-map block2points_map mapping each block to the LiDAR points that
-  // fall into the block.
-  const voxblox::HierarchicalIndexIntMap block2points_map =
-      buildBlockToPointsMap(cloud);
-
-  // Builds the voxel2point-map in parallel blockwise.
-  std::vector<BlockIndex> block_indices(block2points_map.size());
-  size_t i = 0;
-  for (const auto& block : block2points_map) {
-    block_indices[i] = block.first;
-    ++i;
-  }
-  IndexGetter<BlockIndex> index_getter(block_indices);
-  std::vector<std::future<void>> threads;
-  std::mutex aggregate_results_mutex;
-  for (int i = 0; i < config_.num_threads; ++i) {
-    threads.emplace_back(std::async(std::launch::async, [&]() {
-      // Data to store results.
-      BlockIndex block_index;
-      std::vector<voxblox::VoxelKey> local_occupied_indices;
-      BlockToPointMap local_point_map;
-
-      // Process until no more blocks.
-      while (index_getter.getNextIndex(&block_index)) {
-        VoxelToPointMap result;
-        this->blockwiseBuildPointMap(cloud, block_index,
-                                     block2points_map.at(block_index), result,
-                                     local_occupied_indices, cloud_info);
-        local_point_map.insert(std::pair(block_index, result));
-      }
-
-      // After processing is done add data to the output map.
-      std::lock_guard<std::mutex> lock(aggregate_results_mutex);
-      occupied_ever_free_voxel_indices.insert(
-          occupied_ever_free_voxel_indices.end(),
-          local_occupied_indices.begin(), local_occupied_indices.end());
-      point_map.merge(local_point_map);
-    }));
-  }
-
-  for (auto& thread : threads) {
-    thread.get();
-  }
-}
-
-voxblox::HierarchicalIndexIntMap MotionDetector::buildBlockToPointsMap(
-    const Cloud& cloud) const {
-  voxblox::HierarchicalIndexIntMap result;
-
-  int i = 0;
-  for (const Point& point : cloud) {
-    voxblox::Point coord(point.x, point.y, point.z);
-    const BlockIndex blockindex =
-        tsdf_layer_->computeBlockIndexFromCoordinates(coord);
-    result[blockindex].push_back(i);
-    i++;
-  }
-  return result;
-}
-
-void MotionDetector::blockwiseBuildPointMap(
-    const Cloud& cloud, const BlockIndex& block_index,
-    const voxblox::AlignedVector<size_t>& points_in_block,
-    VoxelToPointMap& voxel_map,
-    std::vector<voxblox::VoxelKey>& occupied_ever_free_voxel_indices,
-    CloudInfo& cloud_info) const {
-  // Get the block.
-  TsdfBlock::Ptr tsdf_block = tsdf_layer_->getBlockPtrByIndex(block_index);
-  if (!tsdf_block) {
-    return;
-  }
-
-  // Create a mapping of each voxel index to the points it contains.
-  for (size_t i : points_in_block) {
-    const Point& point = cloud[i];
-    const voxblox::Point coords(point.x, point.y, point.z);
-    const VoxelIndex voxel_index =
-        tsdf_block->computeVoxelIndexFromCoordinates(coords);
-    if (!tsdf_block->isValidVoxelIndex(voxel_index)) {
-      continue;
-    }
-    voxel_map[voxel_index].push_back(i);
-
-    // EverFree detection flag at the same time, since we anyways lookup
-    // voxels.
-    if (tsdf_block->getVoxelByVoxelIndex(voxel_index).ever_free) {
-      cloud_info.points.at(i).ever_free_level_dynamic = true;
-    }
-  }
-
-  // Update the voxel status of the currently occupied voxels.
-  for (const auto& voxel_points_pair : voxel_map) {
-    TsdfVoxel& tsdf_voxel =
-        tsdf_block->getVoxelByVoxelIndex(voxel_points_pair.first);
-    tsdf_voxel.last_lidar_occupied = frame_counter_;
-
-    // This voxel attribute is used in the voxel clustering method: it
-    // signalizes that a currently occupied voxel has not yet been clustered
-    tsdf_voxel.clustering_processed = false;
-
-    // The set of occupied_ever_free_voxel_indices allows for fast access of
-    // the seed voxels in the voxel clustering
-    if (tsdf_voxel.ever_free) {
-      occupied_ever_free_voxel_indices.push_back(
-          std::make_pair(block_index, voxel_points_pair.first));
-    }
-  }
-}
-
 }  // namespace dynablox
@@ -6,7 +6,7 @@
 #include <string>
 #include <vector>
 
-#include "dynablox/evaluation/io_tools.h"
+#include "dynablox/evaluation/mapped_cloud_reader.h"
 #include "dynablox/processing/clustering.h"
 
 namespace dynablox {
@@ -25,14 +25,18 @@ void CloudVisualizer::Config::setupParamsAndPrinting() {
 CloudVisualizer::CloudVisualizer(ros::NodeHandle nh)
     : config_(config_utilities::getConfigFromRos<CloudVisualizer::Config>(nh)
                   .checkValid()),
-      visualizer_(nh, std::make_shared<TsdfLayer>(0.2, 16)),
+      visualizer_(nh, std::make_shared<TsdfLayer>(0.2, 16),
+                  std::make_shared<EverFreeLayer>(16)),
       nh_(nh) {
-  // NOTE(schmluk): The Tsdf Layer is a dummy and is not going to be used.
+  // NOTE(schmluk): The Tsdf and Ever-Free Layers are dummies and are not going
+  // to be used.
   LOG(INFO) << "Configuration:\n"
             << config_utilities::Global::printAllConfigs();
 
-  // Load the data.
-  if (!loadCloudFromCsv(config_.file_path, clouds_, cloud_infos_, clusters_)) {
+  // Load the data, either a binary cloud file or a csv file.
+  const MappedCloudReader reader(config_.file_path);
+  if (!reader.isOpen() ||
+      !reader.readAllFrames(clouds_, cloud_infos_, clusters_)) {
     LOG(FATAL) << "Failed to read clouds from '" << config_.file_path << "'.";
   }
   LOG(INFO) << "Read " << clouds_.size() << " clouds from '"
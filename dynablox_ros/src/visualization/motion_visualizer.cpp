@@ -61,12 +61,14 @@ void MotionVisualizer::Config::checkColor(const std::vector<float>& color,
   }
 }
 
-MotionVisualizer::MotionVisualizer(ros::NodeHandle nh,
-                                   std::shared_ptr<TsdfLayer> tsdf_layer)
+MotionVisualizer::MotionVisualizer(
+    ros::NodeHandle nh, std::shared_ptr<TsdfLayer> tsdf_layer,
+    std::shared_ptr<EverFreeLayer> ever_free_layer)
     : config_(config_utilities::getConfigFromRos<MotionVisualizer::Config>(nh)
                   .checkValid()),
       nh_(std::move(nh)),
-      tsdf_layer_(std::move(tsdf_layer)) {
+      tsdf_layer_(std::move(tsdf_layer)),
+      ever_free_layer_(std::move(ever_free_layer)) {
   color_map_.setItemsPerRevolution(config_.color_wheel_num_colors);
   // Setup mesh integrator.
   mesh_layer_ = std::make_shared<voxblox::MeshLayer>(tsdf_layer_->block_size());
@@ -144,6 +146,14 @@ void MotionVisualizer::visualizeAll(const Cloud& cloud,
   time_stamp_set_ = false;
 }
 
+void MotionVisualizer::removeBlocks(
+    const voxblox::BlockIndexList& block_indices) {
+  // Mesh blocks have the same size as TSDF blocks.
+  for (const BlockIndex& block_index : block_indices) {
+    mesh_layer_->removeMesh(block_index);
+  }
+}
+
 void MotionVisualizer::visualizeClusters(const Clusters& clusters,
                                          const std::string& ns) const {
   if (cluster_vis_pub_.getNumSubscribers() == 0u) {
@@ -262,9 +272,14 @@ void MotionVisualizer::visualizeEverFree() const {
   tsdf_layer_->getAllAllocatedBlocks(&block_list);
   for (const auto& index : block_list) {
     const TsdfBlock& block = tsdf_layer_->getBlockByIndex(index);
+    EverFreeBlock::ConstPtr ever_free_block =
+        ever_free_layer_->getBlockPtrByIndex(index);
     for (size_t linear_index = 0; linear_index < block.num_voxels();
          ++linear_index) {
       const TsdfVoxel& voxel = block.getVoxelByLinearIndex(linear_index);
+      const bool voxel_ever_free =
+          ever_free_block &&
+          ever_free_block->hasFlag(linear_index, EverFreeBlock::kEverFree);
 
       if (voxel.weight < 1e-6) {
         continue;  // Unknown voxel.
@@ -276,9 +291,9 @@ void MotionVisualizer::visualizeEverFree() const {
         continue;
       }
 
-      if (voxel.ever_free && ever_free) {
+      if (voxel_ever_free && ever_free) {
         result.points.push_back(setPoint(coords));
-      } else if (!voxel.ever_free && never_free) {
+      } else if (!voxel_ever_free && never_free) {
         result_never.points.push_back(setPoint(coords));
       }
     }
@@ -348,10 +363,17 @@ void MotionVisualizer::visualizeEverFreeSlice(const float slice_height) const {
       continue;
     }
     const TsdfBlock& block = tsdf_layer_->getBlockByIndex(index);
+    EverFreeBlock::ConstPtr ever_free_block =
+        ever_free_layer_->getBlockPtrByIndex(index);
     for (size_t x = 0; x < block.voxels_per_side(); ++x) {
       for (size_t y = 0; y < block.voxels_per_side(); ++y) {
         const VoxelIndex index(x, y, slice_voxel_index.z());
         const TsdfVoxel& voxel = block.getVoxelByVoxelIndex(index);
+        const bool voxel_ever_free =
+            ever_free_block &&
+            ever_free_block->hasFlag(
+                ever_free_block->computeLinearIndexFromVoxelIndex(index),
+                EverFreeBlock::kEverFree);
 
         if (voxel.weight < 1e-6) {
           continue;  // Unknown voxel.
@@ -360,9 +382,9 @@ void MotionVisualizer::visualizeEverFreeSlice(const float slice_height) const {
         voxblox::Point coords = block.computeCoordinatesFromVoxelIndex(index);
         coords.z() -= offset;
 
-        if (voxel.ever_free && ever_free) {
+        if (voxel_ever_free && ever_free) {
           result.points.push_back(setPoint(coords));
-        } else if ((!voxel.ever_free) && never_free) {
+        } else if ((!voxel_ever_free) && never_free) {
           result_never.points.push_back(setPoint(coords));
         }
       }